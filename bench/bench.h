@@ -0,0 +1,118 @@
+/****************************************************/
+/* File: bench.h                                    */
+/* What the benchmarks of the TINY compiler share:  */
+/* the clock, the programs they are timed on and    */
+/* the comparison of syntax trees                   */
+/****************************************************/
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <time.h>
+
+#include "../src/include/ast.h"
+#include "../src/include/globals.h"
+
+/* BLOCK is sixteen lines of valid TINY source with
+   nested statements, comments and expressions */
+#define BLOCK                                                  \
+    "{ running totals of the sequence }\n"                     \
+    "read limit;\n"                                            \
+    "counter := 0;\n"                                          \
+    "total := 1;\n"                                            \
+    "repeat\n"                                                 \
+    "    counter := counter + 1;\n"                            \
+    "    if counter < limit then\n"                            \
+    "        total := total * (counter + 3) / 2 - counter;\n"  \
+    "    else\n"                                               \
+    "        total := total - 1;\n"                            \
+    "    endif\n"                                              \
+    "until counter = limit;\n"                                 \
+    "while total < 100000\n"                                   \
+    "    total := total + (limit * 7);  { step }\n"            \
+    "endwhile\n"                                               \
+    "write total;\n"
+#define BLOCKLINES 16
+
+static inline double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* synthesizeBlocks repeats BLOCK blocks times */
+static inline char* synthesizeBlocks(size_t blocks, size_t* size)
+{
+    size_t l = strlen(BLOCK);
+    char* buf = malloc(blocks * l + 1);
+    for (size_t i = 0; i < blocks; i++) {
+        memcpy(buf + i * l, BLOCK, l);
+    }
+    buf[blocks * l] = '\0';
+    *size = blocks * l;
+    return buf;
+}
+
+/* synthesize builds roughly mb megabytes of BLOCKs */
+static inline char* synthesize(size_t mb, size_t* size)
+{
+    size_t l = strlen(BLOCK);
+    return synthesizeBlocks((mb * 1024 * 1024 + l - 1) / l, size);
+}
+
+/* synthesizeNames builds about lines lines of valid
+   TINY source of short statements over names
+   variables, each used alike */
+static inline char* synthesizeNames(size_t lines, size_t names, size_t* size)
+{
+    size_t cap = 80 * lines + 1;
+    char* buf = malloc(cap);
+    size_t len = 0;
+    for (size_t i = 0; len + 80 < cap; i++) {
+        size_t a = (7 * i) % names, b = (7 * i + 1) % names,
+               c = (7 * i + 2) % names;
+        switch (i % 4) {
+        case 0:
+            len += sprintf(buf + len, "v%zu := v%zu + v%zu * 3;\n", a, b, c);
+            break;
+        case 1:
+            len += sprintf(buf + len,
+                           "if v%zu < v%zu then write v%zu; endif\n", a, b,
+                           c);
+            break;
+        case 2:
+            len += sprintf(buf + len, "repeat v%zu := v%zu - 1; until v%zu "
+                                      "= 0;\n",
+                           a, a, a);
+            break;
+        default:
+            len += sprintf(buf + len, "while v%zu < v%zu v%zu := v%zu + 1; "
+                                      "endwhile\n",
+                           a, b, a, a);
+            break;
+        }
+    }
+    buf[len] = '\0';
+    *size = len;
+    return buf;
+}
+
+/* sameAst tells whether the sibling chains at a and
+   b hold equal syntax trees */
+static inline bool sameAst(AstIndex a, AstIndex b)
+{
+    while ((a != AST_NULL) && (b != AST_NULL)) {
+        const AstNode* x = astNode(a);
+        const AstNode* y = astNode(b);
+        if ((x->kind != y->kind) || (x->line != y->line) ||
+            (x->value != y->value) || !sameAst(x->child, y->child)) {
+            return false;
+        }
+        a = x->next;
+        b = y->next;
+    }
+    return a == b;
+}
+
+#endif
@@ -0,0 +1,172 @@
+/****************************************************/
+/* File: editbench.c                                */
+/* Edit latency benchmark for the incremental front */
+/* end of the TINY compiler: types statements into  */
+/* a large document a keystroke at a time, takes    */
+/* them out again, and times each edit up to fresh  */
+/* diagnostics, failing if the 99th percentile is   */
+/* over its target                                  */
+/*                                                  */
+/* usage: editbench [-l LINES] [file.tny]           */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../src/include/compiler.h"
+#include "../src/include/incr.h"
+#include "../src/include/source.h"
+#include "bench.h"
+
+/* SITES = places a statement is typed in at */
+#define SITES 200
+/* TARGET = the most microseconds the 99th percentile
+   edit may take up to fresh diagnostics */
+#define TARGET 1000.0
+
+/* sameDiagnostics tells whether the document reports
+   what a fresh analysis of its text reports */
+static bool sameDiagnostics(void)
+{
+    size_t n, m, size;
+    const Diagnostic* d = docDiagnostics(&n);
+    Diagnostic* kept = malloc((n + 1) * sizeof(Diagnostic));
+    char** messages = malloc((n + 1) * sizeof(char*));
+    for (size_t i = 0; i < n; i++) {
+        kept[i].line = d[i].line;
+        messages[i] = strdup(d[i].message);
+    }
+    char* text = docText(&size);
+    docOpen(text, size);
+    d = docDiagnostics(&m);
+    bool same = (n == m);
+    for (size_t i = 0; same && (i < n); i++) {
+        same = (kept[i].line == d[i].line) &&
+               (strcmp(messages[i], d[i].message) == 0);
+    }
+    for (size_t i = 0; i < n; i++) {
+        free(messages[i]);
+    }
+    free(messages);
+    free(kept);
+    free(text);
+    return same;
+}
+
+static int compareTimes(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char* argv[])
+{
+    tinyUse(tinyNew());
+    if (tiny == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    tiny->filePath = "editbench";
+    size_t lines = 100000;
+    const char* file = NULL;
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-l") == 0) && (i + 1 < argc)) {
+            lines = (size_t)atol(argv[++i]);
+        }
+        else {
+            file = argv[i];
+        }
+    }
+    tiny->listing = fopen("/dev/null", "w");
+
+    size_t size;
+    char* text;
+    if (file != NULL) {
+        FILE* f = fopen(file, "r");
+        SourceBuffer sb;
+        if ((f == NULL) || !sourceLoad(&sb, f)) {
+            fprintf(stderr, "cannot read %s\n", file);
+            return EXIT_FAILURE;
+        }
+        size = sb.size;
+        text = malloc(size + 1);
+        memcpy(text, sb.data, size + 1);
+        sourceRelease(&sb);
+        fclose(f);
+    }
+    else {
+        text = synthesizeBlocks((lines + BLOCKLINES - 1) / BLOCKLINES,
+                                &size);
+    }
+
+    double t0 = now();
+    if (!docOpen(text, size)) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    double opened = now() - t0;
+    size_t lineCount = 1;
+    for (size_t i = 0; i < size; i++) {
+        lineCount += (text[i] == '\n');
+    }
+
+    /* type a statement in at the start of a line, a
+       byte at a time, then take it out again */
+    static const char typed[] = "count := count + 1;\n";
+    size_t len = strlen(typed);
+    size_t edits = 2 * SITES * len;
+    double* times = malloc(edits * sizeof(double));
+    size_t e = 0;
+    bool same = true;
+    srand(1);
+    for (int s = 0; s < SITES; s++) {
+        size_t at = docOffset(1 + rand() % (int)lineCount, 0);
+        for (size_t i = 0; i <= 2 * len - 1; i++) {
+            bool typing = (i < len);
+            size_t k = typing ? i : 2 * len - 1 - i;
+            double t1 = now();
+            bool ok = typing ? docEdit(at + k, at + k, typed + k, 1)
+                             : docEdit(at + k, at + k + 1, "", 0);
+            size_t count;
+            docDiagnostics(&count);
+            times[e++] = now() - t1;
+            if (!ok) {
+                fprintf(stderr, "out of memory\n");
+                return EXIT_FAILURE;
+            }
+        }
+        if (s % 50 == 0) {
+            /* an unfinished statement is a syntax error
+               until its last byte is typed */
+            docEdit(at, at, typed, len - 2);
+            same = same && sameDiagnostics();
+            docEdit(at, at + len - 2, "", 0);
+        }
+    }
+    char* after = docText(&size);
+    same = same && (memcmp(after, text, size) == 0) && sameDiagnostics();
+    qsort(times, e, sizeof(double), compareTimes);
+
+    printf("document: %zu lines, %.1f MB\n", lineCount,
+           (double)size / (1024.0 * 1024.0));
+    printf("full analysis (docOpen):       %8.1f ms\n", opened * 1e3);
+    printf("edits timed:                   %8zu\n", e);
+    printf("edit to diagnostics, median:   %8.1f us\n", times[e / 2] * 1e6);
+    printf("edit to diagnostics, 99th pct: %8.1f us\n",
+           times[e * 99 / 100] * 1e6);
+    printf("edit to diagnostics, worst:    %8.1f us\n", times[e - 1] * 1e6);
+    if (!same) {
+        fprintf(stderr, "incremental analysis differs from a full one\n");
+        return EXIT_FAILURE;
+    }
+    if (times[e * 99 / 100] * 1e6 > TARGET) {
+        fprintf(stderr, "99th percentile edit over the %.0f us target\n",
+                TARGET);
+        return EXIT_FAILURE;
+    }
+    docClose();
+    free(after);
+    free(times);
+    free(text);
+    fclose(tiny->listing);
+    return EXIT_SUCCESS;
+}
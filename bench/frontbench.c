@@ -0,0 +1,283 @@
+/****************************************************/
+/* File: frontbench.c                               */
+/* Front end throughput benchmark for the TINY      */
+/* compiler: the hand-written scanner and parser    */
+/* against those Flex and Bison generate, scanning  */
+/* and parsing apart and together, on one corpus.   */
+/* Built without Flex, it races the parsers alone   */
+/*                                                  */
+/* usage: frontbench [-s MB] [file.tny]             */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../src/include/compiler.h"
+#include "../src/include/genfront.h"
+#include "bench.h"
+
+/* REPEATS = timed runs per mode; the best is reported */
+#define REPEATS 5
+
+/* GEN_SCANNER is set to false when there is no Flex
+ * to make the generated scanner: the Bison parser
+ * is then fed the tokens of the hand-written one
+ */
+#ifndef GEN_SCANNER
+#define GEN_SCANNER true
+#endif
+
+/* the tokens of the corpus, scanned once, for the
+   parsers to be timed without a scanner */
+static Token* tokens;
+static size_t tokenCount;
+static size_t tokenPos;
+
+/* storedToken is the TokenSource of tokens */
+static void storedToken(Token* tok)
+{
+    *tok = tokens[(tokenPos < tokenCount) ? tokenPos++ : tokenCount - 1];
+}
+
+/* scanHand and scanGen scan the corpus with either
+   scanner and return the number of tokens */
+static size_t scanHand(const char* text, size_t size)
+{
+    Token tok;
+    size_t n = 0;
+    initScannerText(text, size);
+    do {
+        nextToken(&tok);
+        n++;
+    } while (tok.kind != ENDFILE);
+    return n;
+}
+
+#if GEN_SCANNER
+static size_t scanGen(const char* text, size_t size)
+{
+    Token tok;
+    size_t n = 0;
+    genScanBegin(text, size);
+    do {
+        genScanToken(&tok);
+        n++;
+    } while (tok.kind != ENDFILE);
+    genScanEnd();
+    return n;
+}
+
+/* sameTokens tells if the generated scanner hands
+   out the stored tokens, kind, line, lexeme and
+   value alike, saying where it first does not */
+static bool sameTokens(const char* text, size_t size)
+{
+    Token tok;
+    size_t i = 0;
+    genScanBegin(text, size);
+    for (; i < tokenCount; i++) {
+        const Token* t = &tokens[i];
+        genScanToken(&tok);
+        if ((tok.kind != t->kind) || (tok.line != t->line) ||
+            (tok.offset != t->offset) || (tok.length != t->length) ||
+            (tok.value != t->value)) {
+            break;
+        }
+    }
+    genScanEnd();
+    if (i < tokenCount) {
+        fprintf(stderr, "the scanners differ at token %zu, line %d\n",
+                i, tokens[i].line);
+        return false;
+    }
+    return true;
+}
+#endif
+
+/* parseHand and parseGen parse the stored tokens
+   with either parser */
+static void parseHand(void)
+{
+    AstIndex stmt;
+    tokenPos = 0;
+    parseBegin(storedToken, NULL);
+    for (bool first = true; parseStatement(first, &stmt); first = false) {
+        continue;
+    }
+    parseEnd();
+}
+
+static void parseGen(void)
+{
+    tokenPos = 0;
+    genParse(storedToken);
+}
+
+#if GEN_SCANNER
+/* timeScan returns the best time to scan the corpus
+   with either scanner. Identifiers are interned on
+   a warm pool, as they are after the first run */
+static double timeScan(const char* text, size_t size, bool gen)
+{
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        double t0 = now();
+        size_t n = gen ? scanGen(text, size) : scanHand(text, size);
+        double t1 = now();
+        if (n != tokenCount) {
+            fprintf(stderr, "the scanners disagree on the tokens\n");
+            exit(EXIT_FAILURE);
+        }
+        if (t1 - t0 < best) {
+            best = t1 - t0;
+        }
+    }
+    return best;
+}
+#endif
+
+/* timeParse returns the best time to parse the
+   stored tokens with either parser */
+static double timeParse(bool gen)
+{
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        freeAst();
+        double t0 = now();
+        if (gen) {
+            parseGen();
+        }
+        else {
+            parseHand();
+        }
+        double t1 = now();
+        if (t1 - t0 < best) {
+            best = t1 - t0;
+        }
+    }
+    freeAst();
+    return best;
+}
+
+#if GEN_SCANNER
+/* timeFront returns the best time to scan and parse
+   the corpus with either front end */
+static double timeFront(const char* text, size_t size, bool gen)
+{
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        freeAst();
+        double t0 = now();
+        if (gen) {
+            genScanBegin(text, size);
+            genParse(genScanToken);
+            genScanEnd();
+        }
+        else {
+            initScannerText(text, size);
+            parse();
+        }
+        double t1 = now();
+        if (t1 - t0 < best) {
+            best = t1 - t0;
+        }
+    }
+    freeAst();
+    return best;
+}
+#endif
+
+/* report prints the times of one stage as tokens/s */
+static void report(const char* stage, double hand, double gen)
+{
+    double m = (double)tokenCount * 1e-6;
+    printf("%-6s hand-written %7.1f Mtok/s, generated %7.1f Mtok/s, "
+           "ratio %.2f\n",
+           stage, m / hand, m / gen, gen / hand);
+}
+
+int main(int argc, char* argv[])
+{
+    tinyUse(tinyNew());
+    if (tiny == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    tiny->filePath = "frontbench";
+    size_t mb = 16;
+    const char* file = NULL;
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) {
+            mb = (size_t)atoi(argv[++i]);
+        }
+        else {
+            file = argv[i];
+        }
+    }
+    tiny->listing = stdout;
+
+    size_t size;
+    char* text;
+    if (file != NULL) {
+        FILE* f = fopen(file, "r");
+        SourceBuffer sb;
+        if ((f == NULL) || !sourceLoad(&sb, f)) {
+            fprintf(stderr, "cannot read %s\n", file);
+            return EXIT_FAILURE;
+        }
+        size = sb.size;
+        text = malloc(size + 1);
+        memcpy(text, sb.data, size + 1);
+        sourceRelease(&sb);
+        fclose(f);
+    }
+    else {
+        text = synthesize(mb, &size);
+    }
+
+    tokenCount = scanHand(text, size);
+    tokens = malloc(tokenCount * sizeof(Token));
+    initScannerText(text, size);
+    for (size_t i = 0; i < tokenCount; i++) {
+        nextToken(&tokens[i]);
+    }
+
+#if GEN_SCANNER
+    /* both scanners must hand out the same tokens */
+    if (!sameTokens(text, size)) {
+        return EXIT_FAILURE;
+    }
+#endif
+
+    /* both front ends must build the same tree */
+    initScannerText(text, size);
+    AstIndex hand = parse();
+#if GEN_SCANNER
+    genScanBegin(text, size);
+    AstIndex gen = genParse(genScanToken);
+    genScanEnd();
+#else
+    tokenPos = 0;
+    AstIndex gen = genParse(storedToken);
+#endif
+    if (tiny->error || !sameAst(hand, gen)) {
+        fprintf(stderr, "the front ends built different trees\n");
+        return EXIT_FAILURE;
+    }
+    freeAst();
+
+    printf("front end input: %.1f MB, %zu tokens\n",
+           (double)size / (1024.0 * 1024.0), tokenCount);
+#if GEN_SCANNER
+    report("scan", timeScan(text, size, false), timeScan(text, size, true));
+    report("parse", timeParse(false), timeParse(true));
+    report("both", timeFront(text, size, false), timeFront(text, size, true));
+#else
+    report("parse", timeParse(false), timeParse(true));
+    printf("no Flex: the generated scanner was not timed\n");
+#endif
+
+    free(tokens);
+    freeInternPool();
+    free(text);
+    return EXIT_SUCCESS;
+}
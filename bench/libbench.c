@@ -0,0 +1,202 @@
+/****************************************************/
+/* File: libbench.c                                 */
+/* Throughput benchmark for libtiny: a program      */
+/* compiled from memory to memory by tiny_compile,  */
+/* on one thread and on several at once, against    */
+/* writing it to a file, running tiny on it and     */
+/* reading back the code file. Every compilation    */
+/* must give the same code                          */
+/*                                                  */
+/* usage: libbench [-l LINES] [-n COMPILES]         */
+/*                 [-t THREADS] [-x TINY]           */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/include/globals.h"
+#include "../src/include/libtiny.h"
+#include "bench.h"
+
+/* NAMES = variables the synthesized program uses */
+#define NAMES 64
+
+/* PROCESSES = compilations timed by running tiny */
+#define PROCESSES 50
+
+/* the name of the program in the code */
+#define CODEFILE "/tmp/libbench.tm"
+
+extern char** environ;
+
+/* the program, its code and the options of every
+   compilation */
+static char* text;
+static size_t textSize;
+static TinyBuffer expected;
+static TinyOptions options;
+
+/* A Worker makes count compilations and counts those
+   whose code differs from expected */
+typedef struct {
+    pthread_t thread;
+    int count;
+    int wrong;
+} Worker;
+
+/* compileMany is the body of a worker */
+static void* compileMany(void* arg)
+{
+    Worker* w = arg;
+    char* data = malloc(expected.length + 1);
+    TinyBuffer code = {data, expected.length + 1, 0};
+    for (int i = 0; i < w->count; i++) {
+        TinyStatus s = tiny_compile(text, textSize, &options, &code, NULL);
+        if ((s != TINY_OK) || (code.length != expected.length) ||
+            (memcmp(data, expected.data, expected.length) != 0)) {
+            w->wrong++;
+        }
+    }
+    free(data);
+    return NULL;
+}
+
+/* timeThreads returns the time to make compiles
+   compilations on threads threads, adding those that
+   went wrong to *wrong */
+static double timeThreads(int compiles, int threads, int* wrong)
+{
+    Worker* workers = calloc((size_t)threads, sizeof(Worker));
+    double t0 = now();
+    for (int k = 0; k < threads; k++) {
+        workers[k].count =
+            compiles / threads + (k < compiles % threads ? 1 : 0);
+        if (pthread_create(&workers[k].thread, NULL, compileMany,
+                           &workers[k]) != 0) {
+            fprintf(stderr, "cannot start a thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int k = 0; k < threads; k++) {
+        pthread_join(workers[k].thread, NULL);
+        *wrong += workers[k].wrong;
+    }
+    double t = now() - t0;
+    free(workers);
+    return t;
+}
+
+/* runTiny writes the program to a file, runs tiny on
+   it and reads the code file back, the way a service
+   would without the library. Returns false if the
+   code is not expected */
+static bool runTiny(const char* tiny)
+{
+    FILE* f = fopen("/tmp/libbench.tny", "w");
+    if ((f == NULL) || (fwrite(text, 1, textSize, f) != textSize) ||
+        (fclose(f) != 0)) {
+        return false;
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    char* argv[] = {(char*)tiny, "/tmp/libbench.tny", NULL};
+    pid_t pid;
+    int status = 1;
+    if (posix_spawn(&pid, tiny, &actions, NULL, argv, environ) == 0) {
+        waitpid(pid, &status, 0);
+    }
+    posix_spawn_file_actions_destroy(&actions);
+    f = fopen(CODEFILE, "r");
+    if ((status != 0) || (f == NULL)) {
+        return false;
+    }
+    char* data = malloc(expected.length + 1);
+    size_t n = fread(data, 1, expected.length + 1, f);
+    fclose(f);
+    bool same = (n == expected.length) &&
+                (memcmp(data, expected.data, expected.length) == 0);
+    free(data);
+    return same;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t lines = 200;
+    int compiles = 2000;
+    int threads = 4;
+    const char* tiny = "build/tiny";
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-l") == 0) && (i + 1 < argc)) {
+            lines = (size_t)atol(argv[++i]);
+        }
+        else if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc)) {
+            compiles = atoi(argv[++i]);
+        }
+        else if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc)) {
+            threads = atoi(argv[++i]);
+        }
+        else if ((strcmp(argv[i], "-x") == 0) && (i + 1 < argc)) {
+            tiny = argv[++i];
+        }
+    }
+    if ((compiles < 1) || (threads < 1)) {
+        fprintf(stderr, "usage: %s [-l LINES] [-n COMPILES] [-t THREADS] "
+                        "[-x TINY]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+    text = synthesizeNames(lines, NAMES, &textSize);
+    /* the code tiny writes: traced, and named after
+       its code file */
+    options.name = CODEFILE;
+    options.traceCode = true;
+
+    /* a first call with no room learns the size */
+    TinyBuffer probe = {NULL, 0, 0};
+    if (tiny_compile(text, textSize, &options, &probe, NULL) !=
+        TINY_TRUNCATED) {
+        fprintf(stderr, "the program does not compile\n");
+        return EXIT_FAILURE;
+    }
+    expected = (TinyBuffer){malloc(probe.length + 1), probe.length + 1, 0};
+    if (tiny_compile(text, textSize, &options, &expected, NULL) != TINY_OK) {
+        fprintf(stderr, "the program does not compile\n");
+        return EXIT_FAILURE;
+    }
+
+    int wrong = 0;
+    double serial = timeThreads(compiles, 1, &wrong);
+    double parallel = timeThreads(compiles, threads, &wrong);
+    printf("library input: %zu lines, %zu bytes, %zu bytes of code\n", lines,
+           textSize, expected.length);
+    printf("tiny_compile, 1 thread:   %8.1f us/compile %9.0f compiles/s\n",
+           serial * 1e6 / compiles, compiles / serial);
+    printf("tiny_compile, %d threads: %8.1f us/compile %9.0f compiles/s "
+           "(%.2fx)\n",
+           threads, parallel * 1e6 / compiles, compiles / parallel,
+           serial / parallel);
+    if (access(tiny, X_OK) == 0) {
+        double t0 = now();
+        for (int i = 0; i < PROCESSES; i++) {
+            wrong += runTiny(tiny) ? 0 : 1;
+        }
+        double spawned = (now() - t0) / PROCESSES;
+        printf("file and %s:  %8.1f us/compile (%.1fx tiny_compile)\n", tiny,
+               spawned * 1e6, spawned * compiles / serial);
+        remove("/tmp/libbench.tny");
+        remove(CODEFILE);
+    }
+    if (wrong > 0) {
+        printf("%d compilations gave other code\n", wrong);
+        return EXIT_FAILURE;
+    }
+    free(expected.data);
+    free(text);
+    return EXIT_SUCCESS;
+}
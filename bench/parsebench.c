@@ -0,0 +1,155 @@
+/****************************************************/
+/* File: parsebench.c                               */
+/* Front end wall time benchmark for the TINY       */
+/* compiler: compares the serial scan-then-parse    */
+/* path with the pipelined scanner thread, with the */
+/* explicit stack parser and with loading the tree  */
+/* from a binary tree file, on the same input       */
+/*                                                  */
+/* usage: parsebench [-s MB] [file.tny]             */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../src/include/astfile.h"
+#include "../src/include/compiler.h"
+#include "../src/include/parse.h"
+#include "bench.h"
+
+/* REPEATS = timed runs per mode; the best is reported */
+#define REPEATS 5
+
+/* parseText parses text in the given mode */
+static AstIndex parseText(const char* text, size_t size, bool pipeline,
+                          bool stack)
+{
+    tiny->pipelineParse = pipeline;
+    tiny->stackParse = stack;
+    initScannerText(text, size);
+    return parse();
+}
+
+/* timeParse returns the best time to parse text in
+   the given mode */
+static double timeParse(const char* text, size_t size, bool pipeline,
+                        bool stack)
+{
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        freeAst();
+        freeInternPool();
+        double t0 = now();
+        parseText(text, size, pipeline, stack);
+        double t1 = now();
+        if (t1 - t0 < best) {
+            best = t1 - t0;
+        }
+    }
+    freeAst();
+    return best;
+}
+
+/* timeLoad writes the tree at root to a temporary
+   file and returns the best time to read it back */
+static double timeLoad(AstIndex root)
+{
+    FILE* f = tmpfile();
+    if ((f == NULL) || !astWrite(f, root)) {
+        fprintf(stderr, "cannot write a tree file\n");
+        exit(EXIT_FAILURE);
+    }
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        freeAst();
+        releaseAstFile();
+        double t0 = now();
+        AstIndex loaded = astRead(f);
+        double t1 = now();
+        if (loaded != root) {
+            fprintf(stderr, "tree file did not load\n");
+            exit(EXIT_FAILURE);
+        }
+        if (t1 - t0 < best) {
+            best = t1 - t0;
+        }
+    }
+    freeAst();
+    releaseAstFile();
+    fclose(f);
+    return best;
+}
+
+int main(int argc, char* argv[])
+{
+    tinyUse(tinyNew());
+    if (tiny == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    tiny->filePath = "parsebench";
+    size_t mb = 32;
+    const char* file = NULL;
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) {
+            mb = (size_t)atoi(argv[++i]);
+        }
+        else {
+            file = argv[i];
+        }
+    }
+    tiny->listing = stdout;
+
+    size_t size;
+    char* text;
+    if (file != NULL) {
+        FILE* f = fopen(file, "r");
+        SourceBuffer sb;
+        if ((f == NULL) || !sourceLoad(&sb, f)) {
+            fprintf(stderr, "cannot read %s\n", file);
+            return EXIT_FAILURE;
+        }
+        size = sb.size;
+        text = malloc(size + 1);
+        memcpy(text, sb.data, size + 1);
+        sourceRelease(&sb);
+        fclose(f);
+    }
+    else {
+        text = synthesize(mb, &size);
+    }
+
+    double bestSerial = timeParse(text, size, false, false);
+    double bestPipeline = timeParse(text, size, true, false);
+    double bestStack = timeParse(text, size, false, true);
+    freeInternPool();
+    AstIndex serial = parseText(text, size, false, false);
+    size_t nodes = astCount();
+    AstIndex piped = parseText(text, size, true, false);
+    if (!sameAst(serial, piped)) {
+        fprintf(stderr, "pipelined parse built a different tree\n");
+        return EXIT_FAILURE;
+    }
+    AstIndex stacked = parseText(text, size, false, true);
+    if (!sameAst(serial, stacked)) {
+        fprintf(stderr, "stack parser built a different tree\n");
+        return EXIT_FAILURE;
+    }
+    freeAst();
+    freeInternPool();
+    double bestLoad = timeLoad(parseText(text, size, false, false));
+
+    double mbytes = (double)size / (1024.0 * 1024.0);
+    printf("input: %.1f MB, %zu nodes\n", mbytes, nodes);
+    printf("syntax tree: %.1f MB compact, %.1f MB as TreeNodes\n",
+           (double)(nodes * sizeof(AstNode)) / (1024.0 * 1024.0),
+           (double)(nodes * sizeof(TreeNode)) / (1024.0 * 1024.0));
+    printf("serial (tokenize, then parse): %8.1f ms\n", bestSerial * 1e3);
+    printf("pipelined (scanner thread):    %8.1f ms\n", bestPipeline * 1e3);
+    printf("speedup: %.2fx\n", bestSerial / bestPipeline);
+    printf("stack parser (serial scan):    %8.1f ms\n", bestStack * 1e3);
+    printf("tree file (astRead):           %8.1f ms\n", bestLoad * 1e3);
+    freeAst();
+    freeInternPool();
+    free(text);
+    return EXIT_SUCCESS;
+}
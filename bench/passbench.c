@@ -0,0 +1,158 @@
+/****************************************************/
+/* File: passbench.c                                */
+/* Analysis wall time benchmark for the TINY        */
+/* compiler: symbol insertion and type checking run */
+/* by the pass manager as two walks of the tree,    */
+/* fused into one, and split across threads, on the */
+/* same tree                                        */
+/*                                                  */
+/* usage: passbench [-l LINES] [-t THREADS]         */
+/*                  [file.tny]                      */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/include/analyze.h"
+#include "../src/include/compiler.h"
+#include "../src/include/parse.h"
+#include "../src/include/source.h"
+#include "bench.h"
+
+/* REPEATS = timed runs per mode; the best is reported */
+#define REPEATS 5
+
+/* NAMES = variables the synthesized program uses,
+   so that no line list of the symbol table grows
+   long */
+#define NAMES 16384
+
+/* typeCheckApart is typeCheckPass needing all of
+   symtabPass done, which keeps it out of its walk */
+static Pass typeCheckApart;
+
+/* timeAnalysis returns the best time to analyze
+   tree with the passes fused or apart, or with
+   analyzeParallel on threads threads if threads is
+   not 0. Each run is made in a child process, so
+   that each starts with an empty symbol table */
+static double timeAnalysis(AstIndex tree, bool fused, int threads,
+                           int* walks)
+{
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        int fd[2];
+        if (pipe(fd) != 0) {
+            perror("pipe");
+            exit(EXIT_FAILURE);
+        }
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fd[0]);
+            passAdd(&symtabPass);
+            passAdd(fused ? &typeCheckPass : &typeCheckApart);
+            double result[2] = {0, 1};
+            double t0 = now();
+            if (threads > 0) {
+                analyzeParallel(tree, threads);
+            }
+            else {
+                result[1] = passRun(tree);
+            }
+            result[0] = now() - t0;
+            if (write(fd[1], result, sizeof result) != sizeof result) {
+                _exit(EXIT_FAILURE);
+            }
+            _exit(EXIT_SUCCESS);
+        }
+        close(fd[1]);
+        double result[2];
+        if ((pid < 0) ||
+            (read(fd[0], result, sizeof result) != sizeof result)) {
+            fprintf(stderr, "analysis run failed\n");
+            exit(EXIT_FAILURE);
+        }
+        close(fd[0]);
+        waitpid(pid, NULL, 0);
+        if (result[0] < best) {
+            best = result[0];
+        }
+        *walks = (int)result[1];
+    }
+    return best;
+}
+
+int main(int argc, char* argv[])
+{
+    tinyUse(tinyNew());
+    if (tiny == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    tiny->filePath = "passbench";
+    size_t lines = 50000;
+    int threads = 4;
+    const char* file = NULL;
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-l") == 0) && (i + 1 < argc)) {
+            lines = (size_t)atol(argv[++i]);
+        }
+        else if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc)) {
+            threads = atoi(argv[++i]);
+        }
+        else {
+            file = argv[i];
+        }
+    }
+    tiny->listing = fopen("/dev/null", "w");
+
+    size_t size;
+    char* text;
+    if (file != NULL) {
+        FILE* f = fopen(file, "r");
+        SourceBuffer sb;
+        if ((f == NULL) || !sourceLoad(&sb, f)) {
+            fprintf(stderr, "cannot read %s\n", file);
+            return EXIT_FAILURE;
+        }
+        size = sb.size;
+        text = malloc(size + 1);
+        memcpy(text, sb.data, size + 1);
+        sourceRelease(&sb);
+        fclose(f);
+    }
+    else {
+        text = synthesizeNames(lines, NAMES, &size);
+    }
+    initScannerText(text, size);
+    AstIndex tree = parse();
+    if (tiny->error) {
+        fprintf(stderr, "the program has syntax errors\n");
+        return EXIT_FAILURE;
+    }
+
+    typeCheckApart = typeCheckPass;
+    typeCheckApart.needs = 1u << 0;
+    int apartWalks, fusedWalks, parallelWalks;
+    double apart = timeAnalysis(tree, false, 0, &apartWalks);
+    double fused = timeAnalysis(tree, true, 0, &fusedWalks);
+    double parallel = timeAnalysis(tree, true, threads, &parallelWalks);
+
+    printf("analysis input: %.1f MB, %zu nodes\n",
+           (double)size / (1024.0 * 1024.0), astCount());
+    printf("symtab, typecheck apart: %8.1f ms (%d walks)\n", apart * 1e3,
+           apartWalks);
+    printf("symtab, typecheck fused: %8.1f ms (%d walk)\n", fused * 1e3,
+           fusedWalks);
+    printf("speedup: %.2fx\n", apart / fused);
+    printf("symtab, typecheck on %d threads: %8.1f ms (%.2fx fused)\n",
+           threads, parallel * 1e3, fused / parallel);
+    freeAst();
+    freeInternPool();
+    fclose(tiny->listing);
+    free(text);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,387 @@
+/****************************************************/
+/* File: scanbench.c                                */
+/* Scanner throughput benchmark for the TINY        */
+/* compiler: compares tokenize() with the former    */
+/* switch-based DFA and with tokenizeParallel() on  */
+/* the same input, in MB/s                          */
+/*                                                  */
+/* usage: scanbench [-s MB] [-j N] [file.tny]       */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../src/include/compiler.h"
+#include "../src/include/scan.h"
+#include "../src/include/scansimd.h"
+#include "bench.h"
+
+/* REPEATS = timed runs per scanner; the best is reported */
+#define REPEATS 5
+
+/* synthesizeMixed builds roughly mb megabytes of
+   TINY source that mixes indentation, comments and
+   identifiers of varied length */
+static char* synthesizeMixed(size_t mb, size_t* size)
+{
+    static const char* lines[] = {
+        "{ compute the next value of the sequence, then check the bounds }\n",
+        "    counter_value := counter_value + 1;\n",
+        "    if counter_value < limit then\n",
+        "        accumulated_total := accumulated_total * 31 + (x / 7);\n",
+        "        write accumulated_total;\n",
+        "    endif\n",
+        "    while i < 100000\n",
+        "        i := i + 1;   { step }\n",
+        "    endwhile\n",
+        "read x;\n",
+    };
+    size_t n = sizeof(lines) / sizeof(lines[0]);
+    size_t cap = mb * 1024 * 1024;
+    char* buf = malloc(cap + 256);
+    size_t len = 0;
+    for (size_t i = 0; len < cap; i++) {
+        size_t l = strlen(lines[i % n]);
+        memcpy(buf + len, lines[i % n], l);
+        len += l;
+    }
+    buf[len] = '\0';
+    *size = len;
+    return buf;
+}
+
+/****************************************/
+/* the switch-based DFA of the previous */
+/* scanner, kept here as the reference  */
+/****************************************/
+
+typedef enum { L_START, L_INASSIGN, L_INCOMMENT, L_INNUM, L_INID, L_DONE } LState;
+
+static const char* lcur;
+static const char* lend;
+static bool lLineStart;
+static bool lEOF;
+
+static int lGetNextChar(void)
+{
+    int c = (unsigned char)*lcur;
+    if ((c == '\0') && (lcur == lend)) {
+        tiny->lineno++;
+        lEOF = true;
+        return EOF;
+    }
+    if (lLineStart) {
+        tiny->lineno++;
+        lLineStart = false;
+    }
+    lcur++;
+    if (c == '\n') {
+        lLineStart = true;
+    }
+    return c;
+}
+
+static void lUngetNextChar(void)
+{
+    if (!lEOF) {
+        lcur--;
+        if (*lcur == '\n') {
+            lLineStart = false;
+        }
+    }
+}
+
+static const struct {
+    char* str;
+    TokenType tok;
+} lReserved[MAXRESERVED] = {{"else", ELSE},   {"endif", ENDIF},
+                            {"endwhile", ENDWHILE}, {"if", IF},
+                            {"read", READ},   {"repeat", REPEAT},
+                            {"then", THEN},   {"until", UNTIL},
+                            {"while", WHILE}, {"write", WRITE}};
+
+static TokenType lReservedLookup(const char* word, size_t len)
+{
+    int start = 0;
+    int end = MAXRESERVED - 1;
+    while (start <= end) {
+        int mid = (start + end) / 2;
+        int comparison = strncmp(word, lReserved[mid].str, len);
+        if ((comparison == 0) && (lReserved[mid].str[len] != '\0')) {
+            comparison = -1;
+        }
+        if (comparison == 0) {
+            return lReserved[mid].tok;
+        }
+        else if (comparison < 0) {
+            end = mid - 1;
+        }
+        else {
+            start = mid + 1;
+        }
+    }
+    return ID;
+}
+
+static TokenType lScanToken(const char** lexeme)
+{
+    TokenType tok = ENDFILE;
+    LState state = L_START;
+    const char* start = lcur;
+    while (state != L_DONE) {
+        int c = lGetNextChar();
+        switch (state) {
+        case L_START:
+            if (isdigit(c)) {
+                state = L_INNUM;
+            }
+            else if (isalpha(c)) {
+                state = L_INID;
+            }
+            else if (c == ':') {
+                state = L_INASSIGN;
+            }
+            else if (isspace(c)) {
+                start = lcur;
+            }
+            else if (c == '{') {
+                state = L_INCOMMENT;
+            }
+            else {
+                state = L_DONE;
+                switch (c) {
+                case EOF:
+                    tok = ENDFILE;
+                    break;
+                case '=':
+                    tok = EQ;
+                    break;
+                case '<':
+                    tok = LT;
+                    break;
+                case '+':
+                    tok = PLUS;
+                    break;
+                case '-':
+                    tok = MINUS;
+                    break;
+                case '*':
+                    tok = TIMES;
+                    break;
+                case '/':
+                    tok = OVER;
+                    break;
+                case '(':
+                    tok = LPAREN;
+                    break;
+                case ')':
+                    tok = RPAREN;
+                    break;
+                case ';':
+                    tok = SEMI;
+                    break;
+                default:
+                    tok = ERROR;
+                    break;
+                }
+            }
+            break;
+        case L_INCOMMENT:
+            if (c == EOF) {
+                state = L_DONE;
+                tok = ENDFILE;
+            }
+            else if (c == '}') {
+                state = L_START;
+                start = lcur;
+            }
+            break;
+        case L_INASSIGN:
+            state = L_DONE;
+            if (c == '=') {
+                tok = ASSIGN;
+            }
+            else {
+                lUngetNextChar();
+                tok = DDOT;
+            }
+            break;
+        case L_INNUM:
+            if (!isdigit(c)) {
+                lUngetNextChar();
+                state = L_DONE;
+                tok = NUM;
+            }
+            break;
+        case L_INID:
+            if (!(isalnum(c)) && (c != '_')) {
+                lUngetNextChar();
+                state = L_DONE;
+                tok = ID;
+            }
+            break;
+        default:
+            state = L_DONE;
+            break;
+        }
+    }
+    if (tok == ENDFILE) {
+        start = lcur;
+    }
+    else if (tok == ID) {
+        tok = lReservedLookup(start, (size_t)(lcur - start));
+    }
+    *lexeme = start;
+    return tok;
+}
+
+/* legacyTokenize fills ts, which must already be
+   large enough, using the reference scanner */
+static void legacyTokenize(const char* text, size_t size, TokenStream* ts)
+{
+    TokenType tok;
+    lcur = text;
+    lend = text + size;
+    lLineStart = true;
+    lEOF = false;
+    tiny->lineno = 0;
+    ts->count = 0;
+    do {
+        const char* lexeme;
+        tok = lScanToken(&lexeme);
+        size_t i = ts->count++;
+        ts->kind[i] = (unsigned char)tok;
+        ts->offset[i] = (uint32_t)(lexeme - text);
+        ts->length[i] = (uint32_t)(lcur - lexeme);
+        ts->line[i] = tiny->lineno;
+    } while (tok != ENDFILE);
+}
+
+int main(int argc, char* argv[])
+{
+    tinyUse(tinyNew());
+    if (tiny == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    size_t mb = 64;
+    int threads = 4;
+    const char* file = NULL;
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) {
+            mb = (size_t)atoi(argv[++i]);
+        }
+        else if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc)) {
+            threads = atoi(argv[++i]);
+        }
+        else {
+            file = argv[i];
+        }
+    }
+    tiny->listing = stdout;
+
+    size_t size;
+    char* text;
+    if (file != NULL) {
+        FILE* f = fopen(file, "r");
+        SourceBuffer sb;
+        if ((f == NULL) || !sourceLoad(&sb, f)) {
+            fprintf(stderr, "cannot read %s\n", file);
+            return EXIT_FAILURE;
+        }
+        size = sb.size;
+        text = malloc(size + 1);
+        memcpy(text, sb.data, size + 1);
+        sourceRelease(&sb);
+        fclose(f);
+    }
+    else {
+        text = synthesizeMixed(mb, &size);
+    }
+
+    TokenStream ts = {0};
+    TokenStream ref = {0};
+    double bestTable = 1e30;
+    double bestLegacy = 1e30;
+    size_t tableTokens = 0;
+    for (int r = 0; r < REPEATS; r++) {
+        ts.count = 0;
+        freeInternPool();
+        initScannerText(text, size);
+        double t0 = now();
+        tokenize(&ts);
+        double t1 = now();
+        tableTokens = ts.count;
+        if (t1 - t0 < bestTable) {
+            bestTable = t1 - t0;
+        }
+    }
+    /* the reference scanner writes into a stream of the same size */
+    ref = ts;
+    ref.kind = malloc(ts.capacity);
+    ref.offset = malloc(ts.capacity * sizeof(uint32_t));
+    ref.length = malloc(ts.capacity * sizeof(uint32_t));
+    ref.line = malloc(ts.capacity * sizeof(int));
+    ref.value = NULL;
+    for (int r = 0; r < REPEATS; r++) {
+        double t0 = now();
+        legacyTokenize(text, size, &ref);
+        double t1 = now();
+        if (t1 - t0 < bestLegacy) {
+            bestLegacy = t1 - t0;
+        }
+    }
+    if (ref.count != ts.count) {
+        fprintf(stderr, "scanners disagree: %zu tokens vs %zu\n", ref.count,
+                ts.count);
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < ts.count; i++) {
+        if ((ref.kind[i] != ts.kind[i]) || (ref.offset[i] != ts.offset[i]) ||
+            (ref.length[i] != ts.length[i]) || (ref.line[i] != ts.line[i])) {
+            fprintf(stderr, "scanners disagree at token %zu\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* the parallel scanner must give the very same stream */
+    TokenStream par = {0};
+    double bestParallel = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        par.count = 0;
+        freeInternPool();
+        initScannerText(text, size);
+        double t0 = now();
+        tokenizeParallel(&par, threads);
+        double t1 = now();
+        if (t1 - t0 < bestParallel) {
+            bestParallel = t1 - t0;
+        }
+    }
+    if (par.count != ts.count) {
+        fprintf(stderr, "parallel scanner disagrees: %zu tokens vs %zu\n",
+                par.count, ts.count);
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < ts.count; i++) {
+        if ((par.kind[i] != ts.kind[i]) || (par.offset[i] != ts.offset[i]) ||
+            (par.length[i] != ts.length[i]) || (par.line[i] != ts.line[i]) ||
+            (par.value[i] != ts.value[i])) {
+            fprintf(stderr, "parallel scanner disagrees at token %zu\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+
+    double mbytes = (double)size / (1024.0 * 1024.0);
+    printf("input: %.1f MB, %zu tokens, %s kernels\n", mbytes, tableTokens,
+           scanKernelName());
+    printf("switch DFA (reference): %8.1f MB/s\n", mbytes / bestLegacy);
+    printf("table DFA (tokenize):   %8.1f MB/s\n", mbytes / bestTable);
+    printf("speedup: %.2fx\n", bestLegacy / bestTable);
+    printf("parallel (%d threads):  %8.1f MB/s\n", threads,
+           mbytes / bestParallel);
+    freeTokenStream(&ts);
+    freeTokenStream(&par);
+    freeTokenStream(&ref);
+    free(text);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+/* Generated by tools/mkscantab.c -- do not edit */
+
+/* character class of every input byte */
+static const unsigned char charClass[256] = {
+     1,  0,  0,  0,  0,  0,  0,  0,  0,  3,  2,  3,  3,  3,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     3,  0,  0,  0,  0,  0,  0,  0, 14, 15, 12, 10,  0, 11,  0, 13,
+     4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  7, 16,  9,  8,  0,  0,
+     0,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,
+     5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  0,  0,  0,  0,  6,
+     0,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,
+     5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5, 17,  0, 18,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+/* scanner DFA: scanTable[state][class] */
+static const unsigned short scanTable[NSTATES][NCLASSES] = {
+    {
+        0x011d, 0x002d, 0x0030, 0x0030, 0x0003, 0x0044, 0x011d, 0x0001,
+        0x0f1d, 0x101d, 0x111d, 0x121d, 0x131d, 0x141d, 0x151d, 0x161d,
+        0x171d, 0x003a, 0x011d,
+    },
+    {
+        0x1825, 0x182d, 0x1825, 0x1825, 0x1825, 0x1825, 0x1825, 0x1825,
+        0x0e1d, 0x1825, 0x1825, 0x1825, 0x1825, 0x1825, 0x1825, 0x1825,
+        0x1825, 0x1825, 0x1825,
+    },
+    {
+        0x000a, 0x002d, 0x0012, 0x000a, 0x000a, 0x000a, 0x000a, 0x000a,
+        0x000a, 0x000a, 0x000a, 0x000a, 0x000a, 0x000a, 0x000a, 0x000a,
+        0x000a, 0x000a, 0x0008,
+    },
+    {
+        0x0d25, 0x0d2d, 0x0d25, 0x0d25, 0x0003, 0x0d25, 0x0d25, 0x0d25,
+        0x0d25, 0x0d25, 0x0d25, 0x0d25, 0x0d25, 0x0d25, 0x0d25, 0x0d25,
+        0x0d25, 0x0d25, 0x0d25,
+    },
+    {
+        0x0c25, 0x0c2d, 0x0c25, 0x0c25, 0x0004, 0x0004, 0x0004, 0x0c25,
+        0x0c25, 0x0c25, 0x0c25, 0x0c25, 0x0c25, 0x0c25, 0x0c25, 0x0c25,
+        0x0c25, 0x0c25, 0x0c25,
+    },
+};
+
+/* reserved words, indexed by KEYWORD_HASH */
+static const struct {
+    const char* str;
+    size_t len;
+    TokenType tok;
+} keywordTable[KEYWORD_SLOTS] = {
+    {"", 0, ID},
+    {"", 0, ID},
+    {"", 0, ID},
+    {"read", 4, READ},
+    {"", 0, ID},
+    {"repeat", 6, REPEAT},
+    {"endif", 5, ENDIF},
+    {"", 0, ID},
+    {"endwhile", 8, ENDWHILE},
+    {"while", 5, WHILE},
+    {"else", 4, ELSE},
+    {"write", 5, WRITE},
+    {"until", 5, UNTIL},
+    {"", 0, ID},
+    {"then", 4, THEN},
+    {"if", 2, IF},
+};
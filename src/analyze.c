@@ -7,43 +7,65 @@
 /****************************************************/
 
 #include "include/analyze.h"
+#include "include/compiler.h"
+#include "include/threadpool.h"
+#include "include/util.h"
+#include "include/walk.h"
 
-/* counter for variable memory locations */
-static int location = 0;
+/* A TypeError is a type error held back by
+   typeCheckPass until it finishes */
+typedef struct TypeError {
+    int line;
+    char* message;
+} TypeError;
 
-/* Procedure traverse is a generic recursive
- * syntax tree traversal routine:
- * it applies preProc in preorder and postProc
- * in postorder to tree pointed to by t
- */
+/* the list type errors found on this thread are
+   held back in, or NULL to list them at once */
+static _Thread_local ErrorList* holding = NULL;
 
-static void traverse(TreeNode* t, void (*preProc)(TreeNode* t),
-                     void (*postProc)(TreeNode* t))
-{
-    if (t == NULL) {
-        return;
-    }
-    preProc(t);
-    for (int i = 0; i < MAXCHILDREN; i++) {
-        traverse(t->child[i], preProc, postProc);
-    }
-    postProc(t);
-    traverse(t->sibling, preProc, postProc);
-    return;
-}
+/* A Reference is a use of a name on a line */
+typedef struct {
+    int name;
+    int line;
+} Reference;
 
-/* nullProc is a do-nothing procedure to
- * generate preorder-only or postorder-only
- * traversals from traverse
+/* A RefList holds references in order */
+typedef struct {
+    Reference* items;
+    size_t count;
+    size_t capacity;
+} RefList;
+
+/* A Slice is a run of top level statements that
+ * analyzeParallel analyzes as one task. Its names
+ * go to the symbol table later, from its references
+ * split by shard of the name, and its type errors
+ * are held back until every slice is done
  */
-static void nullProc() { return; }
+typedef struct {
+    AstIndex first;            /* its first statement */
+    size_t statements;         /* statements in it */
+    RefList refs[SYMSHARDS];   /* references by shard of the name */
+    int* firsts;               /* names used first in it, in order */
+    size_t firstCount;
+    size_t firstCapacity;
+    unsigned char* seen;       /* bit per symbol: in firsts */
+    ErrorList errors;          /* its type errors, in order */
+    bool failed;               /* memory ran out */
+} Slice;
+
+/* the slice this thread is analyzing, if any */
+static _Thread_local Slice* slice = NULL;
 
 /* Procedure insertNode inserts
  * identifiers stored in t into
  * the symbol table
  */
-static void insertNode(TreeNode* t)
+static bool insertNode(WalkFrame* frame, size_t depth)
 {
+    TreeNode* t = frame->node;
+    (void)depth;
+    tiny->analyze.entered = true;
     switch (t->nodekind) {
     case StmtK:
         switch (t->kind.stmt) {
@@ -51,7 +73,7 @@ static void insertNode(TreeNode* t)
         case ReadK:
             if (st_lookup(t->attr.name) == -1) {
                 /* not yet in table, so treat as new definition */
-                st_insert(t->attr.name, t->lineno, location++);
+                st_insert(t->attr.name, t->lineno, tiny->analyze.location++);
             }
             else {
                 /* already in table, so ignore location,
@@ -68,7 +90,7 @@ static void insertNode(TreeNode* t)
         case IdK:
             if (st_lookup(t->attr.name) == -1) {
                 /* not yet in table, so treat as new definition */
-                st_insert(t->attr.name, t->lineno, location++);
+                st_insert(t->attr.name, t->lineno, tiny->analyze.location++);
             }
 
             else {
@@ -84,34 +106,85 @@ static void insertNode(TreeNode* t)
     default:
         break;
     }
+    return true;
+}
+
+/* insertStatement enters the identifiers of one
+   statement into the symbol table */
+static void insertStatement(TreeNode* t)
+{
+    walkTree(t, insertNode, NULL, NULL);
 }
 
 /* Function buildSymtab constructs the symbol
  * table by preorder traversal of the syntax tree
  */
-void buildSymtab(TreeNode* tree)
+void buildSymtab(AstIndex tree)
 {
-    if (tree == NULL) {
+    if ((tree == AST_NULL) || (astNode(tree)->child == AST_NULL)) {
         return;
     }
-    traverse(tree, insertNode, nullProc);
-    if (TraceAnalyze) {
-        fprintf(listing, "\nSymbol table:\n\n");
-        printSymTab(listing);
+    addSymbols(tree);
+    if (tiny->traceAnalyze) {
+        fprintf(tiny->listing, "\nSymbol table:\n\n");
+        printSymTab(tiny->listing);
     }
 }
 
+/* Procedure addSymbols enters the identifiers of
+ * statement stmt into the symbol table, as
+ * buildSymtab does for each statement in turn, but
+ * does not list the table
+ */
+void addSymbols(AstIndex stmt) { astForEachStatement(stmt, insertStatement); }
+
+/* reportTypeError lists a type error and passes it
+   on to the DiagnosticProc */
+static void reportTypeError(int line, char* message)
+{
+    fprintf(tiny->listing, "Type error at line %d: %s\n", line, message);
+    diagnostic(line, message, "");
+}
+
+/* holdError adds a type error to list. Returns
+   false if memory runs out */
+static bool holdError(ErrorList* list, int line, char* message)
+{
+    if (list->count == list->capacity) {
+        size_t cap = (list->capacity == 0) ? 16 : 2 * list->capacity;
+        TypeError* e = realloc(list->items, cap * sizeof(TypeError));
+        if (e == NULL) {
+            return false;
+        }
+        list->items = e;
+        list->capacity = cap;
+    }
+    list->items[list->count++] = (TypeError){line, message};
+    return true;
+}
+
 static void typeError(TreeNode* t, char* message)
 {
-    fprintf(listing, "Type error at line %d: %s\n", t->lineno, message);
-    Error = true;
+    if (slice != NULL) {
+        /* analyzeParallel sets Error once the slices
+           are done */
+        if (!holdError(holding, t->lineno, message)) {
+            slice->failed = true;
+        }
+        return;
+    }
+    tiny->error = true;
+    if ((holding == NULL) || !holdError(holding, t->lineno, message)) {
+        reportTypeError(t->lineno, message);
+    }
 }
 
 /* Procedure checkNode performs
  * type checking at a single tree node
  */
-static void checkNode(TreeNode* t)
+static void checkNode(WalkFrame* frame)
 {
+    TreeNode* t = frame->node;
     switch (t->nodekind) {
     case ExpK:
         switch (t->kind.exp) {
@@ -166,7 +239,314 @@ static void checkNode(TreeNode* t)
     }
 }
 
+/* checkStatement type checks one statement */
+static void checkStatement(TreeNode* t) { walkTree(t, NULL, NULL, checkNode); }
+
 /* Procedure typeCheck performs type checking
  * by a postorder syntax tree traversal
  */
-void typeCheck(TreeNode* tree) { traverse(tree, nullProc, checkNode); }
\ No newline at end of file
+void typeCheck(AstIndex tree) { astForEachStatement(tree, checkStatement); }
+/* startSymtab starts symtabPass */
+static void startSymtab(void)
+{
+    tiny->analyze.entered = false;
+    if (tiny->traceAnalyze) {
+        fprintf(tiny->listing, "\nBuilding Symbol Table...\n");
+    }
+}
+
+/* finishSymtab lists the table symtabPass built */
+static void finishSymtab(void)
+{
+    if (tiny->analyze.entered && tiny->traceAnalyze) {
+        fprintf(tiny->listing, "\nSymbol table:\n\n");
+        printSymTab(tiny->listing);
+    }
+}
+
+/* startChecks starts typeCheckPass */
+static void startChecks(void)
+{
+    holding = &tiny->analyze.heldErrors;
+    tiny->analyze.heldErrors.count = 0;
+}
+
+/* finishChecks lists the type errors typeCheckPass
+   found, where typeCheck would have */
+static void finishChecks(void)
+{
+    if (tiny->traceAnalyze) {
+        fprintf(tiny->listing, "\nChecking Types...\n");
+    }
+    ErrorList* held = &tiny->analyze.heldErrors;
+    for (size_t i = 0; i < held->count; i++) {
+        reportTypeError(held->items[i].line, held->items[i].message);
+    }
+    free(held->items);
+    *held = (ErrorList){NULL, 0, 0};
+    holding = NULL;
+    if (tiny->traceAnalyze) {
+        fprintf(tiny->listing, "\nType Checking Finished\n");
+    }
+}
+
+/* symtabPass is buildSymtab as a pass. With
+ * TraceAnalyze it lists its heading as it starts
+ * and the table as it finishes
+ */
+const Pass symtabPass = {.name = "symtab",
+                         .start = startSymtab,
+                         .enter = insertNode,
+                         .finish = finishSymtab};
+
+/* typeCheckPass is typeCheck as a pass. Its errors
+ * are held back and listed as it finishes, after
+ * whatever the passes before it list, under the
+ * headings TraceAnalyze adds
+ */
+const Pass typeCheckPass = {.name = "typecheck",
+                            .start = startChecks,
+                            .leave = checkNode,
+                            .finish = finishChecks};
+
+/****************************************/
+/* parallel semantic analysis           */
+/****************************************/
+
+/* SLICESPERTHREAD = slices per worker thread, so
+   that a slow slice does not hold up the rest */
+#define SLICESPERTHREAD 4
+
+/* MINSLICE = top level statements a slice holds at
+   least */
+#define MINSLICE 256
+
+/* noteName records a use of name on line in the
+   slice of this thread */
+static void noteName(int name, int line)
+{
+    RefList* refs = &slice->refs[st_shard(name)];
+    if (refs->count == refs->capacity) {
+        size_t cap = (refs->capacity == 0) ? 256 : 2 * refs->capacity;
+        Reference* r = realloc(refs->items, cap * sizeof(Reference));
+        if (r == NULL) {
+            slice->failed = true;
+            return;
+        }
+        refs->items = r;
+        refs->capacity = cap;
+    }
+    refs->items[refs->count++] = (Reference){name, line};
+    if (slice->seen[name / 8] & (1u << (name % 8))) {
+        return;
+    }
+    if (slice->firstCount == slice->firstCapacity) {
+        size_t cap = slice->firstCapacity;
+        cap = (cap == 0) ? 256 : 2 * cap;
+        int* f = realloc(slice->firsts, cap * sizeof(int));
+        if (f == NULL) {
+            slice->failed = true;
+            return;
+        }
+        slice->firsts = f;
+        slice->firstCapacity = cap;
+    }
+    slice->seen[name / 8] |= (unsigned char)(1u << (name % 8));
+    slice->firsts[slice->firstCount++] = name;
+}
+
+/* noteNode is insertNode for a slice: it records
+   the name of t instead of inserting it */
+static bool noteNode(WalkFrame* frame, size_t depth)
+{
+    TreeNode* t = frame->node;
+    (void)depth;
+    if (((t->nodekind == StmtK) &&
+         ((t->kind.stmt == AssignK) || (t->kind.stmt == ReadK))) ||
+        ((t->nodekind == ExpK) && (t->kind.exp == IdK))) {
+        noteName(t->attr.name, t->lineno);
+    }
+    return true;
+}
+
+/* analyzeStatement notes the names of a statement
+   and type checks it, in one walk */
+static void analyzeStatement(TreeNode* t)
+{
+    walkTree(t, noteNode, NULL, checkNode);
+}
+
+/* analyzeSlice is the task analyzing one slice */
+static void analyzeSlice(void* arg)
+{
+    slice = arg;
+    holding = &slice->errors;
+    astForEachStatementOf(slice->first, slice->statements, analyzeStatement);
+    astReleaseScratch();
+    holding = NULL;
+    slice = NULL;
+}
+
+/* A ShardFill is the task entering the references
+   of every slice to one shard of the table */
+typedef struct {
+    int shard;
+    const Slice* slices;
+    int count;
+    const int* locations; /* location of each symbol */
+} ShardFill;
+
+/* fillShard enters the references of a shard, slice
+   by slice, each with the location of its name */
+static void fillShard(void* arg)
+{
+    const ShardFill* f = arg;
+    for (int i = 0; i < f->count; i++) {
+        const RefList* refs = &f->slices[i].refs[f->shard];
+        for (size_t k = 0; k < refs->count; k++) {
+            Reference r = refs->items[k];
+            st_insert(r.name, r.line, f->locations[r.name]);
+        }
+    }
+}
+
+/* runTasks runs proc on each of the count elements
+   of size bytes at args, on pool if there is one,
+   else one after the other */
+static void runTasks(ThreadPool* pool, TaskProc proc, void* args,
+                     size_t size, int count)
+{
+    for (int i = 0; i < count; i++) {
+        void* arg = (char*)args + (size_t)i * size;
+        if ((pool == NULL) || !poolSubmit(pool, proc, arg)) {
+            proc(arg);
+        }
+    }
+    if (pool != NULL) {
+        poolWait(pool);
+    }
+}
+
+/* splitSlices cuts the count statements from first
+   on into n slices of about equal length */
+static void splitSlices(Slice* slices, int n, AstIndex first, size_t count)
+{
+    AstIndex s = first;
+    for (int i = 0; i < n; i++) {
+        size_t len = count / (size_t)n + ((size_t)i < count % (size_t)n);
+        slices[i].first = s;
+        slices[i].statements = len;
+        for (size_t k = 0; k < len; k++) {
+            s = astNode(s)->next;
+        }
+    }
+}
+
+/* mergeSlices hands out the locations of the names
+ * of the slices, in order of first use, as the
+ * serial walk does, then fills the shards of the
+ * table on pool and lists the held type errors.
+ * Returns false if memory runs out
+ */
+static bool mergeSlices(ThreadPool* pool, Slice* slices, int n)
+{
+    int* locations = malloc(((size_t)symbolCount() + 1) * sizeof(int));
+    ShardFill* fills = malloc(SYMSHARDS * sizeof(ShardFill));
+    bool ok = (locations != NULL) && (fills != NULL);
+    for (int i = 0; i < n; i++) {
+        ok = ok && !slices[i].failed;
+    }
+    if (ok) {
+        for (int i = 0; i < symbolCount(); i++) {
+            locations[i] = -1;
+        }
+        for (int i = 0; i < n; i++) {
+            for (size_t k = 0; k < slices[i].firstCount; k++) {
+                int name = slices[i].firsts[k];
+                if (locations[name] < 0) {
+                    int loc = st_lookup(name);
+                    locations[name] =
+                        (loc >= 0) ? loc : tiny->analyze.location++;
+                }
+            }
+        }
+        for (int s = 0; s < SYMSHARDS; s++) {
+            fills[s] = (ShardFill){s, slices, n, locations};
+        }
+        runTasks(pool, fillShard, fills, sizeof(ShardFill), SYMSHARDS);
+        for (int i = 0; ok && (i < n); i++) {
+            for (size_t k = 0; ok && (k < slices[i].errors.count); k++) {
+                TypeError e = slices[i].errors.items[k];
+                ok = holdError(&tiny->analyze.heldErrors, e.line, e.message);
+            }
+        }
+        tiny->error = tiny->error || (tiny->analyze.heldErrors.count > 0);
+    }
+    free(fills);
+    free(locations);
+    return ok;
+}
+
+/* Procedure analyzeParallel does the work of
+ * symtabPass and typeCheckPass over the statement
+ * sequence tree, with the top level statements
+ * split into slices analyzed on a pool of threads
+ * workers. The names of each slice go to the sharded
+ * symbol table a shard per task, slice by slice, so
+ * the table, the memory locations and the listing
+ * come out as they do from the serial passes. Small
+ * programs or a single thread run the slices on the
+ * calling thread
+ */
+void analyzeParallel(AstIndex tree, int threads)
+{
+    const AstNode* seq = astNode(tree);
+    AstIndex first = (seq->kind == AstSeq) ? seq->child : tree;
+    size_t count = 0;
+    for (AstIndex s = first; s != AST_NULL; s = astNode(s)->next) {
+        count++;
+        if (seq->kind != AstSeq) {
+            break;
+        }
+    }
+    int n = (threads < 2) ? 1 : threads * SLICESPERTHREAD;
+    if ((size_t)n > count / MINSLICE) {
+        n = (count / MINSLICE > 1) ? (int)(count / MINSLICE) : 1;
+    }
+    size_t seenSize = ((size_t)symbolCount() + 8) / 8;
+    Slice* slices = calloc((size_t)n, sizeof(Slice));
+    bool ok = (slices != NULL);
+    for (int i = 0; ok && (i < n); i++) {
+        ok = ((slices[i].seen = calloc(seenSize, 1)) != NULL);
+    }
+    ThreadPool* pool = (ok && (n > 1)) ? newThreadPool(threads) : NULL;
+
+    startSymtab();
+    startChecks();
+    if (ok) {
+        splitSlices(slices, n, first, count);
+        runTasks(pool, analyzeSlice, slices, sizeof(Slice), n);
+        tiny->analyze.entered = (count > 0);
+        ok = mergeSlices(pool, slices, n);
+    }
+    if (!ok) {
+        fprintf(tiny->listing, "Out of memory error at line %d\n",
+                tiny->lineno);
+        tiny->error = true;
+    }
+    if (pool != NULL) {
+        freeThreadPool(pool);
+    }
+    finishSymtab();
+    finishChecks();
+
+    for (int i = 0; (slices != NULL) && (i < n); i++) {
+        for (int s = 0; s < SYMSHARDS; s++) {
+            free(slices[i].refs[s].items);
+        }
+        free(slices[i].firsts);
+        free(slices[i].seen);
+        free(slices[i].errors.items);
+    }
+    free(slices);
+}
@@ -0,0 +1,84 @@
+/****************************************************/
+/* File: arena.c                                    */
+/* Bump-pointer arena allocator implementation      */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "include/arena.h"
+
+/* a block of arena storage; blocks are chained so
+   they can all be released together */
+struct ArenaBlock {
+    ArenaBlock* next;
+    alignas(max_align_t) char data[];
+};
+
+/* Function arenaGrow starts a new block holding at
+ * least size bytes and allocates them from it.
+ * Returns NULL if memory runs out
+ */
+void* arenaGrow(Arena* arena, size_t size)
+{
+    size_t blockSize = (size > ARENA_BLOCKSIZE) ? size : ARENA_BLOCKSIZE;
+    ArenaBlock* b = malloc(sizeof(ArenaBlock) + blockSize);
+    if (b == NULL) {
+        return NULL;
+    }
+    b->next = arena->blocks;
+    arena->blocks = b;
+    arena->next = b->data + size;
+    arena->limit = b->data + blockSize;
+    return b->data;
+}
+
+/* Function arenaCopy copies the len characters at s
+ * into arena, with a terminating NUL, unaligned.
+ * Returns NULL if memory runs out
+ */
+char* arenaCopy(Arena* arena, const char* s, size_t len)
+{
+    char* t;
+    if ((arena->next != NULL) && ((size_t)(arena->limit - arena->next) > len)) {
+        t = arena->next;
+        arena->next += len + 1;
+    }
+    else if ((t = arenaGrow(arena, len + 1)) == NULL) {
+        return NULL;
+    }
+    memcpy(t, s, len);
+    t[len] = '\0';
+    return t;
+}
+
+/* Procedure arenaReset frees everything allocated
+ * from arena but keeps its newest block for reuse
+ */
+void arenaReset(Arena* arena)
+{
+    ArenaBlock* b = arena->blocks;
+    if (b == NULL) {
+        return;
+    }
+    arena->blocks = b->next;
+    arenaRelease(arena);
+    b->next = NULL;
+    arena->blocks = b;
+    arena->next = b->data;
+    arena->limit = b->data + ARENA_BLOCKSIZE;
+}
+
+/* Procedure arenaRelease frees every block of arena
+ * and leaves it empty
+ */
+void arenaRelease(Arena* arena)
+{
+    while (arena->blocks != NULL) {
+        ArenaBlock* next = arena->blocks->next;
+        free(arena->blocks);
+        arena->blocks = next;
+    }
+    arena->next = arena->limit = NULL;
+}
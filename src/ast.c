@@ -0,0 +1,317 @@
+/****************************************************/
+/* File: ast.c                                      */
+/* Compact syntax tree implementation               */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#include "include/ast.h"
+#include "include/arena.h"
+#include "include/compiler.h"
+
+/* the expanded statement of astForEachStatement;
+   each thread expands into scratch of its own */
+static _Thread_local Arena scratch;
+
+/* an Expansion is a node still to be expanded and
+   the link its TreeNode goes into; for the head of
+   a chain of statements the rest of the chain
+   follows on its sibling link */
+typedef struct {
+    TreeNode** link;
+    AstIndex node;
+    bool chain;
+} Expansion;
+
+/* the expansions still to be done, as a stack, so
+   that neither long chains nor deep nesting recurse */
+static _Thread_local Expansion* expansions = NULL;
+static _Thread_local size_t expansionCount = 0;
+static _Thread_local size_t expansionCapacity = 0;
+
+/* newNode appends a node of kind kind */
+static AstIndex newNode(AstKind kind)
+{
+    AstState* as = &tiny->ast;
+    if (as->attached) {
+        return AST_NULL; /* read only */
+    }
+    if (as->count == as->capacity) {
+        AstIndex cap = (as->capacity == 0) ? 1024 : 2 * as->capacity;
+        AstNode* n = (cap > as->capacity)
+                         ? realloc(as->nodes, (size_t)cap * sizeof(AstNode))
+                         : NULL;
+        if (n == NULL) {
+            fprintf(tiny->listing, "Out of memory error at line %d\n",
+                    tiny->lineno);
+            return AST_NULL;
+        }
+        as->nodes = n;
+        as->capacity = cap;
+        if (as->count == 0) {
+            /* skip AST_NULL, zeroed as it is written out
+               with the tree */
+            as->nodes[0] = (AstNode){0, {0}, 0, AST_NULL, AST_NULL, 0};
+            as->count = 1;
+        }
+    }
+    AstIndex i = as->count++;
+    as->nodes[i] =
+        (AstNode){(uint8_t)kind, {0}, tiny->lineno, AST_NULL, AST_NULL, 0};
+    return i;
+}
+
+/* Function astStmt adds a statement node of kind
+ * kind to the vector and returns its index.
+ * Returns AST_NULL if memory runs out
+ */
+AstIndex astStmt(StmtKind kind) { return newNode((AstKind)kind); }
+
+/* Function astExp adds an expression node of kind
+ * kind to the vector and returns its index.
+ * Returns AST_NULL if memory runs out
+ */
+AstIndex astExp(ExpKind kind) { return newNode((AstKind)(AstOp + kind)); }
+
+/* Function astSeq adds an empty statement sequence
+ * to the vector and returns its index. Returns
+ * AST_NULL if memory runs out
+ */
+AstIndex astSeq(void) { return newNode(AstSeq); }
+
+/* Procedure astAddChild makes child the last child
+ * of parent; a child of AST_NULL leaves an empty
+ * slot (AstNil)
+ */
+void astAddChild(AstIndex parent, AstIndex child)
+{
+    if (parent == AST_NULL) {
+        return;
+    }
+    if ((child == AST_NULL) && ((child = newNode(AstNil)) == AST_NULL)) {
+        return;
+    }
+    AstIndex* link = &tiny->ast.nodes[parent].child;
+    while (*link != AST_NULL) {
+        link = &tiny->ast.nodes[*link].next;
+    }
+    *link = child;
+}
+
+/* Procedure astAddSibling makes next the sibling
+ * after node, which must be the last of its chain.
+ * Long statement sequences are built with it, as
+ * astAddChild walks the chain to its end
+ */
+void astAddSibling(AstIndex node, AstIndex next)
+{
+    if (node != AST_NULL) {
+        tiny->ast.nodes[node].next = next;
+    }
+}
+
+/* Procedure astSetValue sets the payload of node */
+void astSetValue(AstIndex node, int value)
+{
+    if (node != AST_NULL) {
+        tiny->ast.nodes[node].value = value;
+    }
+}
+
+/* Procedure astShiftLines adds delta to the line of
+ * the count nodes from first: the nodes of a
+ * statement parsed on its own, which are made in a
+ * run, the statement first
+ */
+void astShiftLines(AstIndex first, size_t count, int delta)
+{
+    if (first == AST_NULL) {
+        return;
+    }
+    AstNode* nodes = tiny->ast.nodes;
+    for (size_t i = 0; i < count; i++) {
+        nodes[first + i].line += delta;
+    }
+}
+
+/* Function astNode returns the node at index i. It
+ * stays valid until the next node is added
+ */
+const AstNode* astNode(AstIndex i) { return &tiny->ast.nodes[i]; }
+
+/* Function astCount returns the number of nodes */
+size_t astCount(void)
+{
+    return (tiny->ast.count == 0) ? 0 : tiny->ast.count - 1;
+}
+
+/* Procedure astTruncate drops every node after the
+ * first n, keeping the vector for the nodes added
+ * next. A tree built one statement at a time so
+ * takes no more room than its largest statement
+ */
+void astTruncate(size_t n)
+{
+    if (!tiny->ast.attached && (n < astCount())) {
+        tiny->ast.count = (AstIndex)n + 1;
+    }
+}
+
+/* Procedure astAttach replaces the vector with the
+ * n entries at vector, entry 0 included, without
+ * copying them. The caller keeps ownership; no node
+ * may be added or changed until freeAst
+ */
+void astAttach(const AstNode* vector, AstIndex n)
+{
+    freeAst();
+    tiny->ast.nodes = (AstNode*)vector;
+    tiny->ast.count = tiny->ast.capacity = n;
+    tiny->ast.attached = true;
+}
+
+/* Procedure freeAst releases every node */
+void freeAst(void)
+{
+    if (!tiny->ast.attached) {
+        free(tiny->ast.nodes);
+    }
+    tiny->ast.nodes = NULL;
+    tiny->ast.count = tiny->ast.capacity = 0;
+    tiny->ast.attached = false;
+    astReleaseScratch();
+}
+
+/* Procedure astReleaseScratch frees the scratch
+ * space the statements expanded on the calling
+ * thread took
+ */
+void astReleaseScratch(void)
+{
+    arenaRelease(&scratch);
+    free(expansions);
+    expansions = NULL;
+    expansionCount = expansionCapacity = 0;
+}
+
+/* pushExpansion adds an expansion to the stack */
+static bool pushExpansion(TreeNode** link, AstIndex node, bool chain)
+{
+    if (expansionCount == expansionCapacity) {
+        size_t cap = (expansionCapacity == 0) ? 256 : 2 * expansionCapacity;
+        Expansion* e = realloc(expansions, cap * sizeof(Expansion));
+        if (e == NULL) {
+            fprintf(tiny->listing, "Out of memory error at line %d\n",
+                    tiny->ast.nodes[node].line);
+            return false;
+        }
+        expansions = e;
+        expansionCapacity = cap;
+    }
+    expansions[expansionCount++] = (Expansion){link, node, chain};
+    return true;
+}
+
+/* expandNode builds the TreeNode form of node i,
+   without its siblings */
+static TreeNode* expandNode(AstIndex i)
+{
+    TreeNode* root = NULL;
+    expansionCount = 0;
+    if (!pushExpansion(&root, i, false)) {
+        return NULL;
+    }
+    while (expansionCount > 0) {
+        Expansion e = expansions[--expansionCount];
+        *e.link = NULL;
+        if (e.node == AST_NULL) {
+            continue; /* the end of a chain */
+        }
+        const AstNode* n = &tiny->ast.nodes[e.node];
+        if (n->kind == AstSeq) {
+            pushExpansion(e.link, n->child, true);
+            continue;
+        }
+        TreeNode* t = NULL;
+        if (n->kind != AstNil) {
+            t = arenaAlloc(&scratch, sizeof(TreeNode));
+            if (t == NULL) {
+                fprintf(tiny->listing, "Out of memory error at line %d\n",
+                        n->line);
+            }
+        }
+        if (t == NULL) {
+            /* nothing to link: a chain goes on from here */
+            if (e.chain) {
+                pushExpansion(e.link, n->next, true);
+            }
+            continue;
+        }
+        if (n->kind < AstOp) {
+            t->nodekind = StmtK;
+            t->kind.stmt = (StmtKind)n->kind;
+        }
+        else {
+            t->nodekind = ExpK;
+            t->kind.exp = (ExpKind)(n->kind - AstOp);
+        }
+        t->lineno = n->line;
+        t->attr.val = n->value;
+        t->type = Void;
+        t->sibling = NULL;
+        *e.link = t;
+        if (e.chain && !pushExpansion(&t->sibling, n->next, true)) {
+            break;
+        }
+        AstIndex slot = n->child;
+        for (int k = 0; k < MAXCHILDREN; k++) {
+            t->child[k] = NULL;
+            if (slot != AST_NULL) {
+                if (!pushExpansion(&t->child[k], slot, false)) {
+                    break;
+                }
+                slot = tiny->ast.nodes[slot].next;
+            }
+        }
+    }
+    return root;
+}
+
+/* Procedure astForEachStatement is the adapter for
+ * the phases written against TreeNode: it expands
+ * each statement of sequence seq in turn into a
+ * scratch TreeNode tree, with no siblings, and
+ * passes it to proc. Only one statement is ever
+ * expanded at a time. A seq that is a statement of
+ * its own is expanded by itself
+ */
+void astForEachStatement(AstIndex seq, TreeProc proc)
+{
+    if (seq == AST_NULL) {
+        return;
+    }
+    if (tiny->ast.nodes[seq].kind != AstSeq) {
+        astForEachStatementOf(seq, 1, proc);
+    }
+    else {
+        astForEachStatementOf(tiny->ast.nodes[seq].child, SIZE_MAX, proc);
+    }
+}
+
+/* Procedure astForEachStatementOf does the work of
+ * astForEachStatement for statement stmt and the
+ * statements after it in its sequence, n at most.
+ * Threads may run it at once, as long as no node is
+ * added: each expands into scratch of its own, kept
+ * until astReleaseScratch
+ */
+void astForEachStatementOf(AstIndex stmt, size_t n, TreeProc proc)
+{
+    for (AstIndex s = stmt; (s != AST_NULL) && (n > 0); n--) {
+        TreeNode* t = expandNode(s);
+        if (t != NULL) {
+            proc(t);
+        }
+        arenaReset(&scratch);
+        s = tiny->ast.nodes[s].next;
+    }
+}
@@ -0,0 +1,211 @@
+/****************************************************/
+/* File: astfile.c                                  */
+/* Binary syntax tree file implementation           */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#include "include/astfile.h"
+#include "include/compiler.h"
+#include "include/intern.h"
+
+#define AST_MAGIC "TINYAST"
+#define BYTE_ORDER_MARK 0x01020304u
+
+/* Function astWrite writes the tree at root and the
+ * names of the intern pool to file. Returns false
+ * if writing fails
+ */
+bool astWrite(FILE* file, AstIndex root)
+{
+    uint32_t symbols = (uint32_t)symbolCount();
+    uint32_t* offsets = malloc((symbols + 1) * sizeof(uint32_t));
+    if (offsets == NULL) {
+        return false;
+    }
+    size_t bytes = 0;
+    for (uint32_t i = 0; i < symbols; i++) {
+        offsets[i] = (uint32_t)bytes;
+        bytes += strlen(symbolName((int)i)) + 1;
+    }
+    AstFileHeader h = {AST_MAGIC,
+                       AST_FILE_VERSION,
+                       BYTE_ORDER_MARK,
+                       sizeof(AstNode),
+                       (uint32_t)astCount() + 1,
+                       root,
+                       symbols,
+                       (uint32_t)bytes,
+                       0};
+    bool ok = (fwrite(&h, sizeof(h), 1, file) == 1);
+    if (ok && (astCount() > 0)) {
+        ok = fwrite(astNode(AST_NULL), sizeof(AstNode), h.nodeCount, file) ==
+             h.nodeCount;
+    }
+    if (ok && (symbols > 0)) {
+        ok = fwrite(offsets, sizeof(uint32_t), symbols, file) == symbols;
+    }
+    for (uint32_t i = 0; ok && (i < symbols); i++) {
+        const char* name = symbolName((int)i);
+        ok = fwrite(name, 1, strlen(name) + 1, file) == strlen(name) + 1;
+    }
+    free(offsets);
+    return ok && (fflush(file) == 0);
+}
+
+/* slotsOf gives the child slots each kind of node
+   holds, in order: 'e' an expression, 's' a
+   statement sequence. The last slot of AstIf, the
+   else part, may be left out. Kinds the parser
+   never makes have none */
+static const char* const slotsOf[AstNil + 1] = {
+    [AstIf] = "ess", [AstRepeat] = "se", [AstAssign] = "e",
+    [AstRead] = "",  [AstWrite] = "e",   [AstWhile] = "es",
+    [AstOp] = "ee",  [AstConst] = "",    [AstId] = ""};
+
+/* validSlots checks that node i has as many
+   children as its kind holds, each of the kind its
+   slot wants: a sequence holds one statement or
+   more, an operator a known operator. The links
+   must be checked already */
+static bool validSlots(const AstNode* nodes, uint32_t i)
+{
+    const AstNode* n = &nodes[i];
+    if (n->kind == AstSeq) {
+        bool ok = (n->child != AST_NULL);
+        for (AstIndex c = n->child; ok && (c != AST_NULL); c = nodes[c].next) {
+            ok = (nodes[c].kind <= AstWhile);
+        }
+        return ok;
+    }
+    const char* slots = slotsOf[n->kind];
+    if (slots == NULL) {
+        return false;
+    }
+    size_t k = 0;
+    for (AstIndex c = n->child; c != AST_NULL; c = nodes[c].next, k++) {
+        uint8_t kind = nodes[c].kind;
+        if ((slots[k] == '\0') ||
+            ((slots[k] == 'e') && ((kind < AstOp) || (kind > AstId))) ||
+            ((slots[k] == 's') && (kind != AstSeq))) {
+            return false;
+        }
+    }
+    if (n->kind == AstOp) {
+        TokenType op = (TokenType)n->value;
+        if ((op != PLUS) && (op != MINUS) && (op != TIMES) && (op != OVER) &&
+            (op != LT) && (op != EQ)) {
+            return false;
+        }
+    }
+    return (k == strlen(slots)) || ((n->kind == AstIf) && (k == 2));
+}
+
+/* validNodes checks that every link and symbol of
+   the node vector is in range, that the nodes
+   reachable from root form a tree: no node but the
+   root lacks a parent, and none has two, and that
+   the root is a sequence and every node has the
+   children its kind holds (see validSlots) */
+static bool validNodes(const AstNode* nodes, const AstFileHeader* h)
+{
+    if ((h->nodeCount == 0) || (h->root == AST_NULL) ||
+        (h->root >= h->nodeCount)) {
+        return false;
+    }
+    unsigned char* linked = calloc(h->nodeCount, 1);
+    if (linked == NULL) {
+        return false;
+    }
+    bool ok = true;
+    for (uint32_t i = 1; ok && (i < h->nodeCount); i++) {
+        const AstNode* n = &nodes[i];
+        AstIndex links[2] = {n->child, n->next};
+        ok = (n->kind <= AstNil);
+        for (int k = 0; ok && (k < 2); k++) {
+            if (links[k] != AST_NULL) {
+                ok = (links[k] < h->nodeCount) && (links[k] != h->root) &&
+                     !linked[links[k]];
+                if (ok) {
+                    linked[links[k]] = 1;
+                }
+            }
+        }
+        if (ok && ((n->kind == AstId) || (n->kind == AstAssign) ||
+                   (n->kind == AstRead))) {
+            ok = (n->value >= 0) && ((uint32_t)n->value < h->symbolCount);
+        }
+    }
+    free(linked);
+    ok = ok && (nodes[h->root].kind == AstSeq) &&
+         (nodes[h->root].next == AST_NULL);
+    for (uint32_t i = 1; ok && (i < h->nodeCount); i++) {
+        ok = validSlots(nodes, i);
+    }
+    return ok;
+}
+
+/* Function astRead maps the tree file file, or reads
+ * it if readSources is set, attaches its nodes with
+ * astAttach and interns its names, so that their
+ * symbol ids match the file. Returns the root, or
+ * AST_NULL if file is not a valid tree file of this
+ * version
+ */
+AstIndex astRead(FILE* file)
+{
+    bool loaded = tiny->readSources ? sourceRead(&tiny->astFile, file)
+                                    : sourceLoad(&tiny->astFile, file);
+    if (!loaded) {
+        return AST_NULL;
+    }
+    const char* data = tiny->astFile.data;
+    AstFileHeader h;
+    if (tiny->astFile.size < sizeof(h)) {
+        releaseAstFile();
+        return AST_NULL;
+    }
+    memcpy(&h, data, sizeof(h));
+    size_t nodeBytes = (size_t)h.nodeCount * sizeof(AstNode);
+    size_t offsetBytes = (size_t)h.symbolCount * sizeof(uint32_t);
+    if ((memcmp(h.magic, AST_MAGIC, sizeof(h.magic)) != 0) ||
+        (h.version != AST_FILE_VERSION) || (h.byteOrder != BYTE_ORDER_MARK) ||
+        (h.nodeSize != sizeof(AstNode)) ||
+        (tiny->astFile.size !=
+         sizeof(h) + nodeBytes + offsetBytes + h.stringBytes)) {
+        releaseAstFile();
+        return AST_NULL;
+    }
+    const AstNode* nodes = (const AstNode*)(data + sizeof(h));
+    const uint32_t* offsets = (const uint32_t*)(data + sizeof(h) + nodeBytes);
+    const char* strings = data + sizeof(h) + nodeBytes + offsetBytes;
+    bool ok = validNodes(nodes, &h) &&
+              ((h.stringBytes == 0) || (strings[h.stringBytes - 1] == '\0'));
+    /* names are interned in file order, so that they
+       get the ids they had when written */
+    freeInternPool();
+    for (uint32_t i = 0; ok && (i < h.symbolCount); i++) {
+        ok = (offsets[i] < h.stringBytes);
+        if (ok) {
+            const char* name = strings + offsets[i];
+            ok = (internName(name, strlen(name)) == (int)i);
+        }
+    }
+    if (!ok) {
+        freeInternPool();
+        releaseAstFile();
+        return AST_NULL;
+    }
+    astAttach(nodes, h.nodeCount);
+    return h.root;
+}
+
+/* Procedure releaseAstFile unmaps the file of
+ * astRead, after freeAst
+ */
+void releaseAstFile(void)
+{
+    if (tiny->astFile.data != NULL) {
+        sourceRelease(&tiny->astFile);
+        tiny->astFile.data = NULL;
+    }
+}
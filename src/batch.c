@@ -0,0 +1,176 @@
+/****************************************************/
+/* File: batch.c                                    */
+/* Work-stealing batch scheduler implementation     */
+/* for the TINY compiler: every thread owns a range */
+/* of the items, guarded by a mutex of its own, and */
+/* takes from its front; idle threads split the     */
+/* largest range left                               */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "include/batch.h"
+#include "include/compiler.h"
+
+/* a Share is the items next up to end - 1 left to
+   a thread */
+typedef struct {
+    pthread_mutex_t lock;
+    int next;
+    int end;
+} Share;
+
+typedef struct {
+    Share* shares;
+    int threads;
+    ItemProc proc;
+    void* arg;
+    TinyCompiler* context; /* the context the items run in */
+} BatchRun;
+
+typedef struct {
+    BatchRun* run;
+    int self; /* the number of its share */
+    pthread_t thread;
+    bool started;
+} Worker;
+
+/* takeItem takes the next item of s into *item.
+   Returns false if s is empty */
+static bool takeItem(Share* s, int* item)
+{
+    pthread_mutex_lock(&s->lock);
+    bool taken = s->next < s->end;
+    if (taken) {
+        *item = s->next++;
+    }
+    pthread_mutex_unlock(&s->lock);
+    return taken;
+}
+
+/* itemsLeft returns the number of items of s */
+static int itemsLeft(Share* s)
+{
+    pthread_mutex_lock(&s->lock);
+    int left = s->end - s->next;
+    pthread_mutex_unlock(&s->lock);
+    return left;
+}
+
+/* steal moves the later half of the largest share
+   left to the empty share self. Only one lock is
+   held at a time, so items on their way between
+   shares may be missed: the thief that holds them
+   runs them. Returns false if every share is
+   empty */
+static bool steal(BatchRun* run, int self)
+{
+    for (;;) {
+        int victim = -1;
+        int most = 0;
+        for (int k = 0; k < run->threads; k++) {
+            int left = itemsLeft(&run->shares[k]);
+            if (left > most) {
+                most = left;
+                victim = k;
+            }
+        }
+        if (victim < 0) {
+            return false;
+        }
+        Share* v = &run->shares[victim];
+        pthread_mutex_lock(&v->lock);
+        int half = (v->end - v->next + 1) / 2;
+        v->end -= half;
+        int first = v->end;
+        pthread_mutex_unlock(&v->lock);
+        if (half > 0) {
+            Share* s = &run->shares[self];
+            pthread_mutex_lock(&s->lock);
+            s->next = first;
+            s->end = first + half;
+            pthread_mutex_unlock(&s->lock);
+            return true;
+        }
+        /* the victim ran out first: look again */
+    }
+}
+
+/* runShares runs the items of share self, then of
+   the shares it steals, until none are left */
+static void runShares(BatchRun* run, int self)
+{
+    int item;
+    do {
+        while (takeItem(&run->shares[self], &item)) {
+            run->proc(item, run->arg);
+        }
+    } while (steal(run, self));
+}
+
+/* worker is the body of a thread of the batch */
+static void* worker(void* arg)
+{
+    Worker* w = arg;
+    tinyUse(w->run->context);
+    runShares(w->run, w->self);
+    return NULL;
+}
+
+/* Procedure batchRun applies proc to every item
+ * from 0 up to count - 1 on threads threads, the
+ * calling thread among them, running in its
+ * context. Each thread starts on an equal share of
+ * the items, taken in order, and a thread whose
+ * share runs out steals the later half of the
+ * largest share left, so that threads given cheap
+ * items take over from those given costly ones.
+ * Threads that cannot be started leave their
+ * shares to be stolen
+ */
+void batchRun(int count, int threads, ItemProc proc, void* arg)
+{
+    if (threads > count) {
+        threads = count;
+    }
+    BatchRun run = {NULL, threads, proc, arg, tiny};
+    Worker* workers = NULL;
+    if (threads > 1) {
+        run.shares = calloc((size_t)threads, sizeof(Share));
+        workers = calloc((size_t)threads, sizeof(Worker));
+    }
+    if ((run.shares == NULL) || (workers == NULL)) {
+        /* one thread, or no memory for more */
+        for (int item = 0; item < count; item++) {
+            proc(item, arg);
+        }
+        free(run.shares);
+        free(workers);
+        return;
+    }
+    for (int k = 0; k < threads; k++) {
+        pthread_mutex_init(&run.shares[k].lock, NULL);
+        run.shares[k].next = (int)((long long)count * k / threads);
+        run.shares[k].end = (int)((long long)count * (k + 1) / threads);
+        workers[k].run = &run;
+        workers[k].self = k;
+    }
+    for (int k = 1; k < threads; k++) {
+        workers[k].started = pthread_create(&workers[k].thread, NULL, worker,
+                                            &workers[k]) == 0;
+    }
+    runShares(&run, 0);
+    for (int k = 1; k < threads; k++) {
+        if (workers[k].started) {
+            pthread_join(workers[k].thread, NULL);
+        }
+    }
+    for (int k = 0; k < threads; k++) {
+        pthread_mutex_destroy(&run.shares[k].lock);
+    }
+    free(run.shares);
+    free(workers);
+}
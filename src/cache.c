@@ -0,0 +1,422 @@
+/****************************************************/
+/* File: cache.c                                    */
+/* Compilation cache implementation for the TINY    */
+/* compiler: an entry is a file named by its key in */
+/* hex, written under another name and renamed into */
+/* place, and its time of modification is the time  */
+/* it was used last                                 */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "include/cache.h"
+
+/* the magic number of an entry, with its version */
+#define CACHE_MAGIC "tinyc\0\0\1"
+
+/* eviction lets go of entries until the cache
+   holds LOW_WATER parts in 4 of its limit, so that
+   it is not done for every entry stored */
+#define LOW_WATER 3
+
+/* TEMP_AGE = seconds after which an entry never
+   renamed into place is let go of */
+#define TEMP_AGE 3600
+
+/* SIZE_NAME names the file keeping the bytes of the
+   entries, so that the directory is only swept when
+   they pass the limit. An entry stored again is
+   counted twice, until the next sweep counts anew */
+#define SIZE_NAME "size"
+
+/* an entry is its header, then its listing,
+   messages and code */
+typedef struct {
+    char magic[8];
+    uint8_t ok;
+    uint8_t errors;
+    uint8_t hasCode;
+    uint8_t zero[5]; /* always 0, so there is no padding */
+    uint64_t listingSize;
+    uint64_t messagesSize;
+    uint64_t codeSize;
+} EntryHeader;
+
+/* the name of an entry: its key in hex */
+#define NAME_SIZE (2 * SHA256_SIZE + 1)
+
+static void entryName(const unsigned char key[SHA256_SIZE],
+                      char name[NAME_SIZE])
+{
+    for (int i = 0; i < SHA256_SIZE; i++) {
+        sprintf(name + 2 * i, "%02x", key[i]);
+    }
+}
+
+/* entryPath returns the path of the file name of c,
+   in memory of its own, or NULL */
+static char* entryPath(const DiskCache* c, const char* name)
+{
+    char* path = malloc(strlen(c->dir) + strlen(name) + 2);
+    if (path != NULL) {
+        sprintf(path, "%s/%s", c->dir, name);
+    }
+    return path;
+}
+
+/* isEntryName tells if name is the name of an entry */
+static bool isEntryName(const char* name)
+{
+    size_t n = strspn(name, "0123456789abcdef");
+    return (n == NAME_SIZE - 1) && (name[n] == '\0');
+}
+
+/* cacheLimit returns the bytes text gives, or
+   CACHE_SIZE if text is NULL or not a size */
+static unsigned long long cacheLimit(const char* text)
+{
+    char* end;
+    if ((text == NULL) || (*text == '\0')) {
+        return CACHE_SIZE;
+    }
+    errno = 0;
+    unsigned long long size = strtoull(text, &end, 10);
+    int shift = (*end == 'K') ? 10 : (*end == 'M') ? 20 : (*end == 'G') ? 30
+                                                                        : 0;
+    end += (shift > 0) ? 1 : 0;
+    if ((errno != 0) || (end == text) || (*end != '\0') ||
+        (size > (~0ull >> shift))) {
+        return CACHE_SIZE;
+    }
+    return size << shift;
+}
+
+/* digestOf sets digest to the digest of the file at
+   path. Returns false if it cannot be read */
+static bool digestOf(const char* path, unsigned char digest[SHA256_SIZE])
+{
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    Sha256 h;
+    sha256Init(&h);
+    char buf[BUFSIZ];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof buf, f)) > 0) {
+        sha256Update(&h, buf, n);
+    }
+    bool ok = !ferror(f);
+    fclose(f);
+    sha256Final(&h, digest);
+    return ok;
+}
+
+/* Function cacheOpen returns the cache CACHE_ENV
+ * names, made if it does not exist, or NULL if it
+ * is unset. Says why on messages if it cannot be
+ * used, and returns NULL
+ */
+DiskCache* cacheOpen(FILE* messages)
+{
+    const char* dir = getenv(CACHE_ENV);
+    if ((dir == NULL) || (*dir == '\0')) {
+        return NULL;
+    }
+    if ((mkdir(dir, 0777) != 0) && (errno != EEXIST)) {
+        fprintf(messages, "tiny: cannot make the cache %s\n", dir);
+        return NULL;
+    }
+    DiskCache* c = calloc(1, sizeof(DiskCache));
+    if ((c == NULL) || ((c->dir = malloc(strlen(dir) + 1)) == NULL)) {
+        fprintf(messages, "Out of memory\n");
+        free(c);
+        return NULL;
+    }
+    /* the compiler is the running executable: any
+       other build of it has its entries apart */
+    if (!digestOf("/proc/self/exe", c->compiler)) {
+        fprintf(messages, "tiny: cannot read this compiler to use the "
+                          "cache\n");
+        free(c->dir);
+        free(c);
+        return NULL;
+    }
+    strcpy(c->dir, dir);
+    c->limit = cacheLimit(getenv(CACHE_SIZE_ENV));
+    pthread_mutex_init(&c->lock, NULL);
+    return c;
+}
+
+/* Procedure cacheClose closes c, if it is not NULL */
+void cacheClose(DiskCache* c)
+{
+    if (c != NULL) {
+        pthread_mutex_destroy(&c->lock);
+        free(c->dir);
+        free(c);
+    }
+}
+
+/* Procedure cacheKeyBegin starts h as a key of c:
+ * what else the compilation depends on is added
+ * to it by sha256Update
+ */
+void cacheKeyBegin(const DiskCache* c, Sha256* h)
+{
+    sha256Init(h);
+    sha256Update(h, CACHE_MAGIC, sizeof CACHE_MAGIC - 1);
+    sha256Update(h, c->compiler, SHA256_SIZE);
+}
+
+/* readPart reads size bytes of f into memory of
+   their own at *text. Returns false if it cannot */
+static bool readPart(FILE* f, uint64_t size, char** text)
+{
+    *text = (size < SIZE_MAX) ? malloc((size_t)size + 1) : NULL;
+    return (*text != NULL) && (fread(*text, 1, (size_t)size, f) == size);
+}
+
+/* Function cacheFetch sets item to the compilation
+ * of c under key, counting a hit, and marks it used
+ * last. Returns false, counting a miss, if c does
+ * not hold one
+ */
+bool cacheFetch(DiskCache* c, const unsigned char key[SHA256_SIZE],
+                CacheItem* item)
+{
+    char name[NAME_SIZE];
+    entryName(key, name);
+    char* path = entryPath(c, name);
+    FILE* f = (path != NULL) ? fopen(path, "rb") : NULL;
+    EntryHeader h;
+    struct stat st;
+    *item = (CacheItem){false, false, NULL, 0, NULL, 0, NULL, 0};
+    bool found = (f != NULL) && (fread(&h, sizeof h, 1, f) == 1) &&
+                 (memcmp(h.magic, CACHE_MAGIC, sizeof h.magic) == 0) &&
+                 (fstat(fileno(f), &st) == 0) &&
+                 ((uint64_t)st.st_size == sizeof h + h.listingSize +
+                                             h.messagesSize + h.codeSize) &&
+                 readPart(f, h.listingSize, &item->listing) &&
+                 readPart(f, h.messagesSize, &item->messages) &&
+                 (!h.hasCode || readPart(f, h.codeSize, &item->code));
+    if (f != NULL) {
+        fclose(f);
+    }
+    if (found) {
+        item->ok = h.ok;
+        item->errors = h.errors;
+        item->listingSize = (size_t)h.listingSize;
+        item->messagesSize = (size_t)h.messagesSize;
+        item->codeSize = (size_t)h.codeSize;
+        /* the time of modification is the time of
+           last use, which eviction goes by */
+        utimensat(AT_FDCWD, path, NULL, 0);
+    }
+    else {
+        cacheFreeItem(item);
+    }
+    free(path);
+    pthread_mutex_lock(&c->lock);
+    if (found) {
+        c->hits++;
+    }
+    else {
+        c->misses++;
+    }
+    pthread_mutex_unlock(&c->lock);
+    return found;
+}
+
+/* an Entry is an entry found by sweep */
+typedef struct {
+    char name[NAME_SIZE];
+    struct timespec used;
+    long long size;
+} Entry;
+
+static int byUse(const void* a, const void* b)
+{
+    const struct timespec* x = &((const Entry*)a)->used;
+    const struct timespec* y = &((const Entry*)b)->used;
+    if (x->tv_sec != y->tv_sec) {
+        return (x->tv_sec < y->tv_sec) ? -1 : 1;
+    }
+    return (x->tv_nsec < y->tv_nsec) ? -1 : (x->tv_nsec > y->tv_nsec);
+}
+
+/* sweep counts the bytes of c, letting go of the
+   entries used longest ago if they are more than
+   its limit, and of entries never renamed into
+   place. Returns the bytes left, or -1 */
+static long long sweep(DiskCache* c)
+{
+    DIR* d = opendir(c->dir);
+    if (d == NULL) {
+        return -1;
+    }
+    Entry* entries = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    long long size = 0;
+    time_t now = time(NULL);
+    struct dirent* de;
+    while ((de = readdir(d)) != NULL) {
+        bool entry = isEntryName(de->d_name);
+        bool temp = strncmp(de->d_name, ".tmp-", 5) == 0;
+        char* path = (entry || temp) ? entryPath(c, de->d_name) : NULL;
+        struct stat st;
+        if ((path == NULL) || (stat(path, &st) != 0)) {
+            free(path);
+            continue;
+        }
+        if (temp && (now - st.st_mtim.tv_sec > TEMP_AGE)) {
+            unlink(path);
+        }
+        else if (entry && (count == capacity)) {
+            capacity = (capacity == 0) ? 256 : 2 * capacity;
+            Entry* grown = realloc(entries, capacity * sizeof(Entry));
+            if (grown == NULL) {
+                free(path);
+                break;
+            }
+            entries = grown;
+        }
+        if (entry) {
+            strcpy(entries[count].name, de->d_name);
+            entries[count].used = st.st_mtim;
+            entries[count].size = (long long)st.st_size;
+            size += entries[count++].size;
+        }
+        free(path);
+    }
+    closedir(d);
+    if ((unsigned long long)size > c->limit) {
+        qsort(entries, count, sizeof(Entry), byUse);
+        long long target = (long long)(c->limit / 4 * LOW_WATER);
+        for (size_t i = 0; (i < count) && (size > target); i++) {
+            char* path = entryPath(c, entries[i].name);
+            if ((path != NULL) && (unlink(path) == 0)) {
+                size -= entries[i].size;
+            }
+            free(path);
+        }
+    }
+    free(entries);
+    return size;
+}
+
+/* addSize adds bytes to the size file of c, which
+   the processes storing to c take in turn, and
+   sweeps c if that passes its limit, or if the
+   file is missing or cannot be read */
+static void addSize(DiskCache* c, long long bytes)
+{
+    char* path = entryPath(c, SIZE_NAME);
+    int fd = (path != NULL) ? open(path, O_RDWR | O_CREAT, 0666) : -1;
+    free(path);
+    struct flock lock = {0};
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    if ((fd < 0) || (fcntl(fd, F_SETLKW, &lock) != 0)) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        sweep(c);
+        return;
+    }
+    char text[32];
+    ssize_t n = pread(fd, text, sizeof text - 1, 0);
+    long long size = -1;
+    if (n > 0) {
+        char* end;
+        text[n] = '\0';
+        errno = 0;
+        size = strtoll(text, &end, 10);
+        size = ((errno != 0) || (end == text) || (*end != '\n')) ? -1 : size;
+    }
+    if ((size < 0) || ((unsigned long long)(size + bytes) > c->limit)) {
+        size = sweep(c);
+    }
+    else {
+        size += bytes;
+    }
+    /* the lock goes with the descriptor */
+    n = (size >= 0) ? snprintf(text, sizeof text, "%lld\n", size) : 0;
+    if ((n == 0) || (pwrite(fd, text, (size_t)n, 0) == n)) {
+        ftruncate(fd, n);
+    }
+    close(fd);
+}
+
+/* writePart writes the size bytes at text to f */
+static bool writePart(FILE* f, const char* text, size_t size)
+{
+    return (size == 0) || (fwrite(text, 1, size, f) == size);
+}
+
+/* Procedure cacheStore writes item to c under key,
+ * replacing the entry whole, and lets go of the
+ * entries used longest ago while c holds more than
+ * its limit
+ */
+void cacheStore(DiskCache* c, const unsigned char key[SHA256_SIZE],
+                const CacheItem* item)
+{
+    char name[NAME_SIZE];
+    entryName(key, name);
+    char* path = entryPath(c, name);
+    char* temp = entryPath(c, ".tmp-XXXXXX");
+    int fd = ((path != NULL) && (temp != NULL)) ? mkstemp(temp) : -1;
+    FILE* f = (fd >= 0) ? fdopen(fd, "wb") : NULL;
+    EntryHeader h = {CACHE_MAGIC,
+                     item->ok,
+                     item->errors,
+                     item->code != NULL,
+                     {0},
+                     item->listingSize,
+                     item->messagesSize,
+                     (item->code != NULL) ? item->codeSize : 0};
+    bool written = (f != NULL) && (fwrite(&h, sizeof h, 1, f) == 1) &&
+                   writePart(f, item->listing, item->listingSize) &&
+                   writePart(f, item->messages, item->messagesSize) &&
+                   writePart(f, item->code, (size_t)h.codeSize);
+    if (f != NULL) {
+        written = (fclose(f) == 0) && written;
+    }
+    else if (fd >= 0) {
+        close(fd);
+    }
+    /* readers see the old entry or the new one, never
+       a part of one */
+    written = written && (rename(temp, path) == 0);
+    if ((fd >= 0) && !written) {
+        unlink(temp);
+    }
+    free(path);
+    free(temp);
+    if (!written) {
+        return;
+    }
+    long long size = (long long)(sizeof h + h.listingSize + h.messagesSize +
+                                 h.codeSize);
+    pthread_mutex_lock(&c->lock);
+    addSize(c, size);
+    pthread_mutex_unlock(&c->lock);
+}
+
+/* Procedure cacheFreeItem frees the text of item */
+void cacheFreeItem(CacheItem* item)
+{
+    free(item->listing);
+    free(item->messages);
+    free(item->code);
+    item->listing = item->messages = item->code = NULL;
+}
@@ -8,271 +8,281 @@
 /****************************************************/
 
 #include "include/cgen.h"
+#include "include/compiler.h"
+#include "include/walk.h"
 
-/* tmpOffset is the memory offset for temps
-   It is decremented each time a temp is
-   stored, and incremeted when loaded again
-*/
-static int tmpOffset = 0;
-
-/* prototype for internal recursive code generator */
+/* prototype for the code generator walk */
 static void cGen(TreeNode* tree);
 
-/* Procedure genStmt generates code at a statement node */
-static void genStmt(TreeNode* tree)
+/* Function genEnter generates the code of a node
+ * that comes before the code of its children, and
+ * tells whether the walk is to generate those
+ */
+static bool genEnter(WalkFrame* frame, size_t depth)
 {
-    TreeNode *p1, *p2, *p3, *curCase;
-    int savedLoc1, savedLoc2, currentLoc;
+    TreeNode* tree = frame->node;
+    TreeNode *p1, *p2, *curCase;
     int loc;
-    switch (tree->kind.stmt) {
-    case SwitchK:
-        if (TraceCode) {
-            emitComment("-> switch");
-        }
-        p1 = tree->child[0];
-        p2 = tree->child[1];
-        // get the variable
-        cGen(p1);
-        // generate Cases
-        cGen(p2);
-        break; /* switch_k */
-    case CaseK:
-        curCase = tree;
+    (void)depth;
+    if (tree->nodekind == StmtK) {
+        switch (tree->kind.stmt) {
+        case SwitchK:
+            if (tiny->traceCode) {
+                emitComment("-> switch");
+            }
+            // get the variable, then generate Cases
+            return true; /* switch_k */
+        case CaseK:
+            curCase = tree;
 
-        if (TraceCode) {
-            emitComment("-> ");
-        }
-        emitRM("LDA", ac1, 0, ac, "tentando colocar o valor de ac em ac1");
-        // loop que gera os cases
-        do {
-            p1 = curCase->child[0];
-            p2 = curCase->child[1];
-            /* get constant */
+            if (tiny->traceCode) {
+                emitComment("-> ");
+            }
+            emitRM("LDA", ac1, 0, ac, "tentando colocar o valor de ac em ac1");
+            // loop que gera os cases
+            do {
+                p1 = curCase->child[0];
+                p2 = curCase->child[1];
+                /* get constant */
 
-            cGen(p1);
+                cGen(p1);
 
-            emitRO("SUB", ac, ac1, ac, "op =="); // subtrai AC de AC1
-            emitRM("JEQ", ac, 1, pc,
-                   "br if true"); // PULA O PROXIMO COMANDO SE O RESULTADO FOR 0
-            int jmpToNextLoc = emitSkip(1); // pula 1 linha pra deixar espaço
-                                            // pro jmp que leva pro proximo case
+                emitRO("SUB", ac, ac1, ac, "op =="); // subtrai AC de AC1
+                emitRM("JEQ", ac, 1, pc,
+                       "br if true"); // PULA O PROXIMO COMANDO SE O
+                                      // RESULTADO FOR 0
+                int jmpToNextLoc = emitSkip(1); // pula 1 linha pra deixar
+                                                // espaço pro jmp que leva
+                                                // pro proximo case
 
-            cGen(p2);                  // gera os statements
-            int lastPos = emitSkip(0); // salva ultima posição
-            emitBackup(jmpToNextLoc); // volta pra local do jmp pro proximo case
-            emitRM("LDA", pc, (lastPos - jmpToNextLoc), pc,
-                   "unconditional jmp"); // pula pra posição do proximo case
-            emitRestore();
+                cGen(p2);                  // gera os statements
+                int lastPos = emitSkip(0); // salva ultima posição
+                emitBackup(
+                    jmpToNextLoc); // volta pra local do jmp pro proximo case
+                emitRM("LDA", pc, (lastPos - jmpToNextLoc), pc,
+                       "unconditional jmp"); // pula pra posição do proximo
+                                             // case
+                emitRestore();
 
-            curCase = curCase->sibling;
-        } while (curCase != NULL);
+                curCase = curCase->sibling;
+            } while (curCase != NULL);
 
-        break; /* switch_k */
-    case IfK:
-        if (TraceCode) {
-            emitComment("-> if");
+            return false; /* switch_k */
+        case IfK:
+            if (tiny->traceCode) {
+                emitComment("-> if");
+            }
+            return true;
+        case RepeatK:
+            if (tiny->traceCode) {
+                emitComment("-> repeat");
+            }
+            frame->saved[0] = emitSkip(0);
+            emitComment("repeat: jump after body comes back here");
+            return true;
+        case WhileK:
+            if (tiny->traceCode) {
+                emitComment("-> while");
+            }
+            frame->saved[0] = emitSkip(0);
+            emitComment("while : jump after body comes back here");
+            return true;
+        case AssignK:
+            if (tiny->traceCode) {
+                emitComment("-> assign");
+            }
+            return true;
+        case ReadK:
+            emitRO("IN", ac, 0, 0, "read integer value");
+            loc = st_lookup(tree->attr.name);
+            emitRM("ST", ac, loc, gp, "read: store value");
+            return false;
+        case WriteK:
+            return true;
+        default:
+            return false;
         }
-        p1 = tree->child[0];
-        p2 = tree->child[1];
-        p3 = tree->child[2];
-        /* generate code for test expression */
-        cGen(p1);
-        savedLoc1 = emitSkip(1);
-        emitComment("if: jump to else belongs here");
-        /* recurse on then part */
-        cGen(p2);
-        savedLoc2 = emitSkip(1);
-        emitComment("if: jump to end belongs here");
-        currentLoc = emitSkip(0);
-        emitBackup(savedLoc1);
-        emitRM_Abs("JEQ", ac, currentLoc, "if: jmp to else");
-        emitRestore();
-        /* recurse on else part */
-        cGen(p3);
-        currentLoc = emitSkip(0);
-        emitBackup(savedLoc2);
-        emitRM_Abs("LDA", pc, currentLoc, "jmp to end");
-        emitRestore();
-        if (TraceCode) {
+    }
+    if (tree->nodekind == ExpK) {
+        switch (tree->kind.exp) {
+        case ConstK:
+            if (tiny->traceCode) {
+                emitComment("-> Const");
+            }
+            /* gen code to load integer constant using LDC */
+            emitRM("LDC", ac, tree->attr.val, 0, "load const");
+            if (tiny->traceCode) {
+                emitComment("<- Const");
+            }
+            return false; /* ConstK */
+        case IdK:
+            if (tiny->traceCode) {
+                emitComment("-> Id");
+            }
+            loc = st_lookup(tree->attr.name);
+            emitRM("LD", ac, loc, gp, "load id value");
+            if (tiny->traceCode) {
+                emitComment("<- Id");
+            }
+            return false; /* IdK */
+        case OpK:
+            if (tiny->traceCode) {
+                emitComment("-> Op");
+            }
+            return true;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+/* Procedure genBetween generates the code of a node
+ * that comes after the code of its child
+ * frame->child - 1
+ */
+static void genBetween(WalkFrame* frame)
+{
+    TreeNode* tree = frame->node;
+    int child = frame->child - 1;
+    int currentLoc;
+    if ((tree->nodekind == StmtK) && (tree->kind.stmt == IfK)) {
+        if (child == 0) {
+            /* after the test expression */
+            frame->saved[0] = emitSkip(1);
+            emitComment("if: jump to else belongs here");
+        }
+        else if (child == 1) {
+            /* after the then part */
+            frame->saved[1] = emitSkip(1);
+            emitComment("if: jump to end belongs here");
+            currentLoc = emitSkip(0);
+            emitBackup(frame->saved[0]);
+            emitRM_Abs("JEQ", ac, currentLoc, "if: jmp to else");
+            emitRestore();
+        }
+        else {
+            /* after the else part */
+            currentLoc = emitSkip(0);
+            emitBackup(frame->saved[1]);
+            emitRM_Abs("LDA", pc, currentLoc, "jmp to end");
+            emitRestore();
+        }
+    }
+    else if ((tree->nodekind == StmtK) && (tree->kind.stmt == WhileK)) {
+        if (child == 0) {
+            /* after the test */
+            frame->saved[1] = emitSkip(1);
+            emitComment("while : jump to end belongs here");
+        }
+    }
+    else if ((tree->nodekind == ExpK) && (tree->kind.exp == OpK)) {
+        if (child == 0) {
+            /* gen code to push left operand */
+            emitRM("ST", ac, tiny->gen.tmpOffset--, mp, "op: push left");
+        }
+        else if (child == 1) {
+            /* now load left operand */
+            emitRM("LD", ac1, ++tiny->gen.tmpOffset, mp, "op: load left");
+            switch (tree->attr.op) {
+            case PLUS:
+                emitRO("ADD", ac, ac1, ac, "op +");
+                break;
+            case MINUS:
+                emitRO("SUB", ac, ac1, ac, "op -");
+                break;
+            case TIMES:
+                emitRO("MUL", ac, ac1, ac, "op *");
+                break;
+            case OVER:
+                emitRO("DIV", ac, ac1, ac, "op /");
+                break;
+            case LT:
+                emitRO("SUB", ac, ac1, ac, "op <");
+                emitRM("JLT", ac, 2, pc, "br if true");
+                emitRM("LDC", ac, 0, ac, "false case");
+                emitRM("LDA", pc, 1, pc, "unconditional jmp");
+                emitRM("LDC", ac, 1, ac, "true case");
+                break;
+            case EQ:
+                emitRO("SUB", ac, ac1, ac, "op ==");
+                emitRM("JEQ", ac, 2, pc, "br if true");
+                emitRM("LDC", ac, 0, ac, "false case");
+                emitRM("LDA", pc, 1, pc, "unconditional jmp");
+                emitRM("LDC", ac, 1, ac, "true case");
+                break;
+            default:
+                emitComment("BUG: Unknown operator");
+                break;
+            } /* case op */
+        }
+    }
+}
+
+/* Procedure genLeave generates the code of a node
+ * that comes after the code of all its children
+ */
+static void genLeave(WalkFrame* frame)
+{
+    TreeNode* tree = frame->node;
+    int currentLoc;
+    int loc;
+    if (tree->nodekind == ExpK) {
+        if ((tree->kind.exp == OpK) && tiny->traceCode) {
+            emitComment("<- Op");
+        }
+        return;
+    }
+    if (tree->nodekind != StmtK) {
+        return;
+    }
+    switch (tree->kind.stmt) {
+    case IfK:
+        if (tiny->traceCode) {
             emitComment("<- if");
         }
         break; /* if_k */
-
     case RepeatK:
-        if (TraceCode) {
-            emitComment("-> repeat");
-        }
-        p1 = tree->child[0];
-        p2 = tree->child[1];
-        savedLoc1 = emitSkip(0);
-        emitComment("repeat: jump after body comes back here");
-        /* generate code for body */
-        cGen(p1);
-        /* generate code for test */
-        cGen(p2);
-        emitRM_Abs("JEQ", ac, savedLoc1, "repeat: jmp back to body");
-        if (TraceCode) {
+        emitRM_Abs("JEQ", ac, frame->saved[0], "repeat: jmp back to body");
+        if (tiny->traceCode) {
             emitComment("<- repeat");
         }
         break; /* repeat */
-
     case WhileK:
-        if (TraceCode) {
-            emitComment("-> while");
-        }
-        p1 = tree->child[0];
-        p2 = tree->child[1];
-        savedLoc1 = emitSkip(0);
-        emitComment("while : jump after body comes back here");
-        /* generate code for test */
-        cGen(p1);
-        savedLoc2 = emitSkip(1);
-        emitComment("while : jump to end belongs here");
-        /* generate code for body */
-        cGen(p2);
-        emitRM_Abs("LDA", pc, savedLoc1, "while : jmp back to test");
+        emitRM_Abs("LDA", pc, frame->saved[0], "while : jmp back to test");
         currentLoc = emitSkip(0);
-        emitBackup(savedLoc2);
+        emitBackup(frame->saved[1]);
         emitRM_Abs("JEQ", ac, currentLoc, "while : jmp to end");
         emitRestore();
 
-        if (TraceCode) {
+        if (tiny->traceCode) {
             emitComment("<- while");
         }
         break; /* while */
-
     case AssignK:
-        if (TraceCode) {
-            emitComment("-> assign");
-        }
-        /* generate code for rhs */
-        cGen(tree->child[0]);
         /* now store value */
         loc = st_lookup(tree->attr.name);
         emitRM("ST", ac, loc, gp, "assign: store value");
-        if (TraceCode) {
+        if (tiny->traceCode) {
             emitComment("<- assign");
         }
         break; /* assign_k */
-
-    case ReadK:
-        emitRO("IN", ac, 0, 0, "read integer value");
-        loc = st_lookup(tree->attr.name);
-        emitRM("ST", ac, loc, gp, "read: store value");
-        break;
     case WriteK:
-        /* generate code for expression to write */
-        cGen(tree->child[0]);
         /* now output it */
         emitRO("OUT", ac, 0, 0, "write ac");
         break;
     default:
         break;
     }
-} /* genStmt */
-
-/* Procedure genExp generates code at an expression node */
-static void genExp(TreeNode* tree)
-{
-    int loc;
-    TreeNode *p1, *p2;
-    switch (tree->kind.exp) {
-
-    case ConstK:
-        if (TraceCode) {
-            emitComment("-> Const");
-        }
-        /* gen code to load integer constant using LDC */
-        emitRM("LDC", ac, tree->attr.val, 0, "load const");
-        if (TraceCode) {
-            emitComment("<- Const");
-        }
-        break; /* ConstK */
-
-    case IdK:
-        if (TraceCode) {
-            emitComment("-> Id");
-        }
-        loc = st_lookup(tree->attr.name);
-        emitRM("LD", ac, loc, gp, "load id value");
-        if (TraceCode) {
-            emitComment("<- Id");
-        }
-        break; /* IdK */
-
-    case OpK:
-        if (TraceCode) {
-            emitComment("-> Op");
-        }
-        p1 = tree->child[0];
-        p2 = tree->child[1];
-        /* gen code for ac = left arg */
-        cGen(p1);
-        /* gen code to push left operand */
-        emitRM("ST", ac, tmpOffset--, mp, "op: push left");
-        /* gen code for ac = right operand */
-        cGen(p2);
-        /* now load left operand */
-        emitRM("LD", ac1, ++tmpOffset, mp, "op: load left");
-        switch (tree->attr.op) {
-        case PLUS:
-            emitRO("ADD", ac, ac1, ac, "op +");
-            break;
-        case MINUS:
-            emitRO("SUB", ac, ac1, ac, "op -");
-            break;
-        case TIMES:
-            emitRO("MUL", ac, ac1, ac, "op *");
-            break;
-        case OVER:
-            emitRO("DIV", ac, ac1, ac, "op /");
-            break;
-        case LT:
-            emitRO("SUB", ac, ac1, ac, "op <");
-            emitRM("JLT", ac, 2, pc, "br if true");
-            emitRM("LDC", ac, 0, ac, "false case");
-            emitRM("LDA", pc, 1, pc, "unconditional jmp");
-            emitRM("LDC", ac, 1, ac, "true case");
-            break;
-        case EQ:
-            emitRO("SUB", ac, ac1, ac, "op ==");
-            emitRM("JEQ", ac, 2, pc, "br if true");
-            emitRM("LDC", ac, 0, ac, "false case");
-            emitRM("LDA", pc, 1, pc, "unconditional jmp");
-            emitRM("LDC", ac, 1, ac, "true case");
-            break;
-        default:
-            emitComment("BUG: Unknown operator");
-            break;
-        } /* case op */
-        if (TraceCode) {
-            emitComment("<- Op");
-        }
-        break; /* OpK */
-
-    default:
-        break;
-    }
-} /* genExp */
+}
 
-/* Procedure cGen recursively generates code by
- * tree traversal
+/* Procedure cGen generates code by a walk of the
+ * tree: the code of each node is split around the
+ * code of its children by the three hooks
  */
 static void cGen(TreeNode* tree)
 {
-    if (tree != NULL) {
-        switch (tree->nodekind) {
-        case StmtK:
-            genStmt(tree);
-            break;
-        case ExpK:
-            genExp(tree);
-            break;
-        default:
-            break;
-        }
-        cGen(tree->sibling);
-    }
+    walkTree(tree, genEnter, genBetween, genLeave);
 }
 
 /**********************************************/
@@ -284,20 +294,45 @@ static void cGen(TreeNode* tree)
  * of the code file, and is used to print the
  * file name as a comment in the code file
  */
-void codeGen(TreeNode* syntaxTree, char* codefile)
+void codeGen(AstIndex syntaxTree, const char* codefile)
+{
+    codeGenBegin(codefile);
+    /* generate code for TINY program */
+    codeGenStatement(syntaxTree);
+    codeGenEnd();
+}
+
+/* Procedure codeGenBegin starts the code of a
+ * program generated a statement at a time, writing
+ * what codeGen writes before the first statement
+ */
+void codeGenBegin(const char* codefile)
 {
     char* s = calloc((strlen(codefile) + 7), sizeof(char));
     strcpy(s, "File: ");
     strcat(s, codefile);
     emitComment("TINY Compilation to TM Code");
     emitComment(s);
+    free(s);
     /* generate standard prelude */
     emitComment("Standard prelude:");
     emitRM("LD", mp, 0, ac, "load maxaddress from location 0");
     emitRM("ST", ac, 0, ac, "clear location 0");
     emitComment("End of standard prelude.");
-    /* generate code for TINY program */
-    cGen(syntaxTree);
+}
+
+/* Procedure codeGenStatement generates the code of
+ * statement stmt, the next of the program begun by
+ * codeGenBegin. Jumps are backpatched within it, so
+ * its tree may be dropped once it returns
+ */
+void codeGenStatement(AstIndex stmt) { astForEachStatement(stmt, cGen); }
+
+/* Procedure codeGenEnd finishes the code of the
+ * program begun by codeGenBegin
+ */
+void codeGenEnd(void)
+{
     /* finish */
     emitComment("End of execution.");
     emitRO("HALT", 0, 0, 0, "");
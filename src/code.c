@@ -7,22 +7,15 @@
 /****************************************************/
 
 #include "include/code.h"
-
-/* TM location number for current instruction emission */
-static int emitLoc = 0;
-
-/* Highest TM location emitted so far
-   For use in conjunction with emitSkip,
-   emitBackup, and emitRestore */
-static int highEmitLoc = 0;
+#include "include/compiler.h"
 
 /* Procedure emitComment prints a comment line
  * with comment c in the code file
  */
 void emitComment(char* c)
 {
-    if (TraceCode) {
-        fprintf(code, "* %s\n", c);
+    if (tiny->traceCode) {
+        fprintf(tiny->code, "* %s\n", c);
     }
 }
 
@@ -36,13 +29,14 @@ void emitComment(char* c)
  */
 void emitRO(char* op, int r, int s, int t, char* c)
 {
-    fprintf(code, "%3d:  %5s  %d,%d,%d ", emitLoc++, op, r, s, t);
-    if (TraceCode) {
-        fprintf(code, "\t%s", c);
+    fprintf(tiny->code, "%3d:  %5s  %d,%d,%d ", tiny->gen.emitLoc++, op, r, s,
+            t);
+    if (tiny->traceCode) {
+        fprintf(tiny->code, "\t%s", c);
     }
-    fprintf(code, "\n");
-    if (highEmitLoc < emitLoc) {
-        highEmitLoc = emitLoc;
+    fprintf(tiny->code, "\n");
+    if (tiny->gen.highEmitLoc < tiny->gen.emitLoc) {
+        tiny->gen.highEmitLoc = tiny->gen.emitLoc;
     }
 } /* emitRO */
 
@@ -56,13 +50,14 @@ void emitRO(char* op, int r, int s, int t, char* c)
  */
 void emitRM(char* op, int r, int d, int s, char* c)
 {
-    fprintf(code, "%3d:  %5s  %d,%d(%d) ", emitLoc++, op, r, d, s);
-    if (TraceCode) {
-        fprintf(code, "\t%s", c);
+    fprintf(tiny->code, "%3d:  %5s  %d,%d(%d) ", tiny->gen.emitLoc++, op, r, d,
+            s);
+    if (tiny->traceCode) {
+        fprintf(tiny->code, "\t%s", c);
     }
-    fprintf(code, "\n");
-    if (highEmitLoc < emitLoc) {
-        highEmitLoc = emitLoc;
+    fprintf(tiny->code, "\n");
+    if (tiny->gen.highEmitLoc < tiny->gen.emitLoc) {
+        tiny->gen.highEmitLoc = tiny->gen.emitLoc;
     }
 } /* emitRM */
 
@@ -72,10 +67,10 @@ void emitRM(char* op, int r, int d, int s, char* c)
  */
 int emitSkip(int howMany)
 {
-    int i = emitLoc;
-    emitLoc += howMany;
-    if (highEmitLoc < emitLoc) {
-        highEmitLoc = emitLoc;
+    int i = tiny->gen.emitLoc;
+    tiny->gen.emitLoc += howMany;
+    if (tiny->gen.highEmitLoc < tiny->gen.emitLoc) {
+        tiny->gen.highEmitLoc = tiny->gen.emitLoc;
     }
     return i;
 } /* emitSkip */
@@ -85,17 +80,17 @@ int emitSkip(int howMany)
  */
 void emitBackup(int loc)
 {
-    if (loc > highEmitLoc) {
+    if (loc > tiny->gen.highEmitLoc) {
         emitComment("BUG in emitBackup");
     }
-    emitLoc = loc;
+    tiny->gen.emitLoc = loc;
 } /* emitBackup */
 
 /* Procedure emitRestore restores the current
  * code position to the highest previously
  * unemitted position
  */
-void emitRestore(void) { emitLoc = highEmitLoc; }
+void emitRestore(void) { tiny->gen.emitLoc = tiny->gen.highEmitLoc; }
 
 /* Procedure emitRM_Abs converts an absolute reference
  * to a pc-relative reference when emitting a
@@ -107,14 +102,14 @@ void emitRestore(void) { emitLoc = highEmitLoc; }
  */
 void emitRM_Abs(char* op, int r, int a, char* c)
 {
-    fprintf(code, "%3d:  %5s  %d,%d(%d) ", emitLoc, op, r, a - (emitLoc + 1),
-            pc);
-    ++emitLoc;
-    if (TraceCode) {
-        fprintf(code, "\t%s", c);
+    fprintf(tiny->code, "%3d:  %5s  %d,%d(%d) ", tiny->gen.emitLoc, op, r,
+            a - (tiny->gen.emitLoc + 1), pc);
+    ++tiny->gen.emitLoc;
+    if (tiny->traceCode) {
+        fprintf(tiny->code, "\t%s", c);
     }
-    fprintf(code, "\n");
-    if (highEmitLoc < emitLoc) {
-        highEmitLoc = emitLoc;
+    fprintf(tiny->code, "\n");
+    if (tiny->gen.highEmitLoc < tiny->gen.emitLoc) {
+        tiny->gen.highEmitLoc = tiny->gen.emitLoc;
     }
 } /* emitRM_Abs */
\ No newline at end of file
@@ -0,0 +1,100 @@
+/****************************************************/
+/* File: compiler.c                                 */
+/* Compilation contexts of the TINY compiler        */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "include/compiler.h"
+#include "include/astfile.h"
+#include "include/intern.h"
+
+/* tiny is the context of the compilation running
+   on this thread */
+_Thread_local TinyCompiler* tiny TINY_TLS = NULL;
+
+/* Function tinyNew returns a new context with every
+ * flag off but one thread for each phase and no
+ * files, or NULL if memory runs out
+ */
+TinyCompiler* tinyNew(void)
+{
+    TinyCompiler* tc = calloc(1, sizeof(TinyCompiler));
+    if (tc != NULL) {
+        tc->filePath = "";
+        tc->lexThreads = 1;
+        tc->analyzeThreads = 1;
+        tc->incr.openHead = (size_t)-1; /* no statement is open */
+    }
+    return tc;
+}
+
+/* Function tinyUse binds tc to the calling thread,
+ * for the compilation run on it, and returns the
+ * context bound before, or NULL
+ */
+TinyCompiler* tinyUse(TinyCompiler* tc)
+{
+    TinyCompiler* previous = tiny;
+    tiny = tc;
+    return previous;
+}
+
+/* Procedure tinyFree releases what the phases of tc
+ * hold and tc itself. It does not close the files
+ * of tc
+ */
+void tinyFree(TinyCompiler* tc)
+{
+    if (tc == NULL) {
+        return;
+    }
+    /* the phases free their state in the context
+       bound to the thread */
+    TinyCompiler* previous = tinyUse(tc);
+    docClose();
+    freeAst();
+    releaseAstFile();
+    releaseScanner();
+    freeInternPool();
+    freeSyntaxTrees();
+    st_free();
+    passClear();
+    freeTokenStream(&tc->parse.tokens);
+    free(tc->parse.symbols.items);
+    free(tc->parse.values.items);
+    free(tc->parse.ops.items);
+    free(tc->analyze.heldErrors.items);
+    free(tc->slots.events);
+    free(tc->slots.blocks);
+    free(tc->slots.names);
+    free(tc->xref.found);
+    free(tc->incr.work);
+    free(tc->incr.workTokens);
+    free(tc->incr.scanned);
+    free(tc->incr.reuses);
+    free(tc->incr.pieces);
+    free(tc->incr.parts);
+    free(tc->incr.pending);
+    free(tc->incr.published);
+    free(tc->incr.found);
+    tinyUse((previous == tc) ? NULL : previous);
+    free(tc);
+}
+
+/* Function pathFrom returns name taken from the
+ * directory directory, in memory of its own: name
+ * itself if it is absolute or directory is NULL.
+ * Returns NULL if memory runs out
+ */
+char* pathFrom(const char* directory, const char* name)
+{
+    if ((directory == NULL) || (name[0] == '/')) {
+        return strdup(name);
+    }
+    char* path = malloc(strlen(directory) + strlen(name) + 2);
+    if (path != NULL) {
+        sprintf(path, "%s/%s", directory, name);
+    }
+    return path;
+}
@@ -0,0 +1,806 @@
+/****************************************************/
+/* File: driver.c                                   */
+/* The compiler driver of the TINY compiler         */
+/* Compiler Construction: Principles and Practice   */
+/* Kenneth C. Louden                                */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <time.h>
+
+#include "include/globals.h"
+
+/* set NO_PARSE to 1 to get a scanner-only compiler */
+#define NO_PARSE false
+/* set NO_ANALYZE to 1 to get a parser-only compiler */
+#define NO_ANALYZE false
+/* set NO_CODE to TRUE to get a compiler that does not
+ * generate code
+ */
+#define NO_CODE false
+/* GEN_FRONTEND is set to 1 by the tiny-gen target,
+ * to parse with the frontend Flex and Bison generate
+ */
+#ifndef GEN_FRONTEND
+#define GEN_FRONTEND false
+#endif
+
+#include "include/analyze.h"
+#include "include/batch.h"
+#include "include/cache.h"
+#include "include/cgen.h"
+#include "include/driver.h"
+#include "include/scan.h"
+#include "include/slots.h"
+#include "include/stream.h"
+#include "include/util.h"
+#if !NO_PARSE
+#include "include/astfile.h"
+#include "include/parse.h"
+#if GEN_FRONTEND
+#include "include/genfront.h"
+#endif
+#if !NO_ANALYZE
+#include "include/xref.h"
+#endif
+#endif
+
+/* extension returns the '.' that starts the
+   extension of the last part of path, or NULL */
+static const char* extension(const char* path)
+{
+    const char* base = strrchr(path, '/');
+    return strrchr((base != NULL) ? base : path, '.');
+}
+
+/* Function sourceName returns the name of the source
+ * file named file: file, or file.tny if it has no
+ * extension, in memory of its own. Returns NULL if
+ * memory runs out
+ */
+char* sourceName(const char* file)
+{
+    char* pgm = malloc(strlen(file) + 5);
+    if (pgm != NULL) {
+        strcpy(pgm, file);
+        if (extension(pgm) == NULL) {
+            strcat(pgm, ".tny");
+        }
+    }
+    return pgm;
+}
+
+/* Function outputName returns the name of pgm with
+ * its extension replaced by ext, in memory of its
+ * own. Returns NULL if memory runs out
+ */
+char* outputName(const char* pgm, const char* ext)
+{
+    const char* dot = extension(pgm);
+    size_t fnlen = (dot != NULL) ? (size_t)(dot - pgm) : strlen(pgm);
+    char* name = calloc(fnlen + strlen(ext) + 1, sizeof(char));
+    if (name != NULL) {
+        strncpy(name, pgm, fnlen);
+        strcat(name, ext);
+    }
+    return name;
+}
+
+#if !NO_PARSE
+/* writeOutput writes the tree at syntaxTree to
+   the file named after pgm with extension ext by
+   proc. Returns false if it cannot be written */
+static bool writeOutput(const char* pgm, const char* ext,
+                        bool (*proc)(FILE*, AstIndex), AstIndex syntaxTree)
+{
+    char* name = outputName(pgm, ext);
+    char* path = (name != NULL) ? pathFrom(tiny->directory, name) : NULL;
+    FILE* out = (path != NULL) ? fopen(path, "wb") : NULL;
+    bool written = (out != NULL) && proc(out, syntaxTree);
+    if (out != NULL) {
+        written = (fclose(out) == 0) && written;
+    }
+    if (!written) {
+        fprintf(tiny->listing, "Unable to write %s\n",
+                (name != NULL) ? name : pgm);
+    }
+    free(path);
+    free(name);
+    return written;
+}
+#endif
+
+/* Function compileTree runs the phases after the
+ * parse over tree, in the context bound to the
+ * thread, each only if those before it found no
+ * error: the semantic analysis, the compaction of
+ * the data memory if compact, and, if codefile is
+ * not NULL, code generation to tiny->code, or to the
+ * file codefile, taken from tiny->directory, if
+ * tiny->code is NULL. Returns false, saying so on
+ * the listing, if that file cannot be opened
+ */
+bool compileTree(AstIndex tree, bool compact, const char* codefile)
+{
+    TinyCompiler* tc = tiny;
+    if (!tc->error) {
+        /* symbol insertion and type checking share a
+           walk of the tree, and the live ranges are of
+           the checked program */
+        int checked = -1;
+        if (tc->analyzeThreads > 1) {
+            analyzeParallel(tree, tc->analyzeThreads);
+        }
+        else {
+            passAdd(&symtabPass);
+            checked = passAdd(&typeCheckPass);
+        }
+        Pass slots = slotPass;
+        if (compact) {
+            slots.needs = (checked >= 0) ? 1u << checked : 0;
+            passAdd(&slots);
+        }
+        passRun(tree);
+        passClear();
+    }
+    if (tc->error || (codefile == NULL)) {
+        return true;
+    }
+    bool opened = (tc->code == NULL);
+    if (opened) {
+        char* path = pathFrom(tc->directory, codefile);
+        tc->code = (path != NULL) ? fopen(path, "w") : NULL;
+        free(path);
+        if (tc->code == NULL) {
+            fprintf(tc->listing, "Unable to open %s\n", codefile);
+            return false;
+        }
+    }
+    codeGen(tree, codefile);
+    if (opened) {
+        fclose(tc->code);
+        tc->code = NULL;
+    }
+    return true;
+}
+
+/* compile runs the phases on the source file pgm,
+   opened in the context bound to the thread, and
+   sets result->tree to its syntax tree. Returns
+   false if the source cannot be read or the output
+   cannot be written */
+static bool compile(const char* pgm, const CompileOptions* o, FILE* messages,
+                    FileResult* result)
+{
+    TinyCompiler* tc = tiny;
+    if (!o->fromAst && !initScanner(tc->source)) {
+        fprintf(messages, "Unable to read %s\n", pgm);
+        return false;
+    }
+#if !NO_CODE
+    if (o->stream) {
+        char* codefile = outputName(pgm, ".tm");
+        bool written = (codefile != NULL) && streamCompile(codefile);
+        free(codefile);
+        return written;
+    }
+#endif
+#if NO_PARSE
+    while (getToken() != ENDFILE) {
+        continue;
+    }
+    (void)result;
+#else
+    AstIndex syntaxTree;
+    if (o->fromAst) {
+        syntaxTree = astRead(tc->source);
+        if (syntaxTree == AST_NULL) {
+            fprintf(messages,
+                    "%s is not a syntax tree file of this compiler\n", pgm);
+            return false;
+        }
+    }
+    else {
+#if GEN_FRONTEND
+        size_t size;
+        const char* text = scannerText(&size);
+        genScanBegin(text, size);
+        syntaxTree = genParse(genScanToken);
+        genScanEnd();
+#else
+        syntaxTree = parse();
+#endif
+    }
+    result->tree = syntaxTree;
+    if (o->emitAst && !tc->error &&
+        !writeOutput(pgm, ".ast", astWrite, syntaxTree)) {
+        return false;
+    }
+    if (tc->traceParse && !tc->error) {
+        fprintf(tc->listing, "\nSyntax tree:\n");
+        astForEachStatement(syntaxTree, printTree);
+    }
+#if !NO_ANALYZE
+    char* codefile = NULL;
+    if (!NO_CODE && !tc->error) {
+        codefile = outputName(pgm, ".tm");
+        if (codefile == NULL) {
+            fprintf(tc->listing, "Unable to open %s\n", pgm);
+            return false;
+        }
+    }
+    bool written = compileTree(syntaxTree, o->compact && !NO_CODE, codefile);
+    free(codefile);
+    if (!written || (o->emitXref && !tc->error &&
+                     !writeOutput(pgm, ".xrf", xrefWrite, syntaxTree))) {
+        return false;
+    }
+#endif
+#endif
+    return true;
+}
+
+/* compileSource compiles pgm, opened in tc, with
+   the listing sent to tc->listing. Returns false if
+   it cannot be read or its output written */
+static bool compileSource(TinyCompiler* tc, const char* pgm,
+                          const CompileOptions* o, FILE* messages,
+                          FileResult* result)
+{
+    TinyCompiler* previous = tinyUse(tc);
+    fprintf(tc->listing, "\nTINY COMPILATION: %s\n", pgm);
+    bool ok = compile(pgm, o, messages, result);
+    fclose(tc->source);
+    tc->source = NULL;
+    result->errors = tc->error;
+    /* only a tree parsed from the source is kept:
+       the source is let go, as it may change */
+    if (ok && result->keep && !tc->error && !o->stream && !o->fromAst) {
+        releaseScanner();
+        tc->filePath = "";
+        tc->directory = NULL;
+        tc->listing = NULL;
+        result->kept = tc;
+    }
+    tinyUse(previous);
+    return ok;
+}
+
+/* sourceKey sets key to the key of pgm, opened in
+   tc, compiled with o. Returns false if it cannot
+   be read */
+static bool sourceKey(TinyCompiler* tc, const char* pgm,
+                      const CompileOptions* o, unsigned char key[SHA256_SIZE])
+{
+    Sha256 h;
+    cacheKeyBegin(o->cache, &h);
+    /* the threads a phase runs on change neither the
+       listing nor the code, so they are left out */
+    char options[64];
+    int n = snprintf(options, sizeof options, "%d %d %d", o->pipelineParse,
+                     o->stackParse, o->compact);
+    sha256Update(&h, options, (size_t)n + 1);
+    /* the name is in the listing and the code */
+    sha256Update(&h, pgm, strlen(pgm) + 1);
+    char buf[BUFSIZ];
+    size_t size;
+    while ((size = fread(buf, 1, sizeof buf, tc->source)) > 0) {
+        sha256Update(&h, buf, size);
+    }
+    bool ok = !ferror(tc->source);
+    rewind(tc->source);
+    sha256Final(&h, key);
+    return ok;
+}
+
+/* writeCode writes the code of item to the code
+   file of pgm, taken from directory, saying so on
+   listing if it cannot. Returns false if it cannot */
+static bool writeCode(const CacheItem* item, const char* directory,
+                      const char* pgm, FILE* listing)
+{
+    char* codefile = outputName(pgm, ".tm");
+    char* path = (codefile != NULL) ? pathFrom(directory, codefile) : NULL;
+    FILE* code = (path != NULL) ? fopen(path, "w") : NULL;
+    bool written =
+        (code != NULL) &&
+        (fwrite(item->code, 1, item->codeSize, code) == item->codeSize);
+    if (code != NULL) {
+        written = (fclose(code) == 0) && written;
+    }
+    if (!written) {
+        fprintf(listing, "Unable to open %s\n",
+                (codefile != NULL) ? codefile : pgm);
+    }
+    free(path);
+    free(codefile);
+    return written;
+}
+
+/* replayItem writes the compilation item of pgm,
+   taken from directory, out as compileSource would.
+   Returns what it did */
+static bool replayItem(const CacheItem* item, const char* directory,
+                       const char* pgm, FILE* listing, FILE* messages,
+                       FileResult* result)
+{
+    fwrite(item->listing, 1, item->listingSize, listing);
+    fwrite(item->messages, 1, item->messagesSize, messages);
+    result->errors = item->errors;
+    if (item->code == NULL) {
+        return item->ok;
+    }
+    return writeCode(item, directory, pgm, listing) && item->ok;
+}
+
+/* compileCached compiles pgm, opened in tc, as
+   compileSource does, unless o->cache holds its
+   compilation already, which is written out
+   instead. What it compiles goes into the cache */
+static bool compileCached(TinyCompiler* tc, const char* pgm,
+                          const CompileOptions* o, FILE* listing,
+                          FILE* messages, FileResult* result)
+{
+    unsigned char key[SHA256_SIZE];
+    CacheItem item;
+    if (!sourceKey(tc, pgm, o, key)) {
+        return compileSource(tc, pgm, o, messages, result);
+    }
+    if (cacheFetch(o->cache, key, &item)) {
+        fclose(tc->source);
+        tc->source = NULL;
+        bool ok =
+            replayItem(&item, o->directory, pgm, listing, messages, result);
+        cacheFreeItem(&item);
+        return ok;
+    }
+    FILE* l = open_memstream(&item.listing, &item.listingSize);
+    FILE* m = open_memstream(&item.messages, &item.messagesSize);
+    /* the code is taken as it is generated, and the
+       code file written from it, so that no other
+       writer of that file can put its code in the
+       cache */
+    FILE* code = open_memstream(&item.code, &item.codeSize);
+    if ((l == NULL) || (m == NULL) || (code == NULL)) {
+        FILE* streams[3] = {l, m, code};
+        for (int i = 0; i < 3; i++) {
+            if (streams[i] != NULL) {
+                fclose(streams[i]);
+            }
+        }
+        cacheFreeItem(&item);
+        return compileSource(tc, pgm, o, messages, result);
+    }
+    tc->listing = l;
+    tc->code = code;
+    item.ok = compileSource(tc, pgm, o, m, result);
+    tc->code = NULL;
+    if (result->kept == NULL) {
+        tc->listing = listing;
+    }
+    fclose(l);
+    fclose(m);
+    fclose(code);
+    fwrite(item.listing, 1, item.listingSize, listing);
+    fwrite(item.messages, 1, item.messagesSize, messages);
+    item.errors = result->errors;
+    if (item.ok && !item.errors) {
+        item.ok = writeCode(&item, o->directory, pgm, listing);
+    }
+    else {
+        free(item.code);
+        item.code = NULL;
+        item.codeSize = 0;
+    }
+    /* a compilation that failed to read or write is
+       not the compilation of its source */
+    if (item.ok) {
+        cacheStore(o->cache, key, &item);
+    }
+    cacheFreeItem(&item);
+    return item.ok;
+}
+
+/* Function compileFile compiles file, or file.tny if
+ * it has no extension, in a context of its own, with
+ * the listing sent to listing and the messages of
+ * tiny to messages. Its files are taken from
+ * o->directory. Returns false if it cannot be read
+ * or its output written
+ */
+bool compileFile(const char* file, const CompileOptions* o, FILE* listing,
+                 FILE* messages, FileResult* result)
+{
+    result->errors = false;
+    result->kept = NULL;
+    result->tree = AST_NULL;
+    TinyCompiler* tc = tinyNew();
+    char* pgm = sourceName(file);
+    if ((tc == NULL) || (pgm == NULL)) {
+        fprintf(messages, "Out of memory\n");
+        free(tc);
+        free(pgm);
+        return false;
+    }
+    /* trace every phase */
+    tc->traceScan = true;
+    tc->traceParse = true;
+    tc->traceAnalyze = true;
+    tc->traceCode = true;
+    tc->lexThreads = o->lexThreads;
+    tc->analyzeThreads = o->analyzeThreads;
+    tc->pipelineParse = o->pipelineParse;
+    tc->stackParse = o->stackParse;
+    tc->readSources = o->readSources;
+    tc->filePath = pgm;
+    tc->directory = o->directory;
+    tc->listing = listing;
+    char* path = pathFrom(o->directory, pgm);
+    tc->source = (path != NULL) ? fopen(path, "r") : NULL;
+    free(path);
+    bool ok = tc->source != NULL;
+    if (!ok) {
+        fprintf(messages, "File %s not found\n", pgm);
+    }
+    /* the cache holds the listing and the code file:
+       the other outputs are always compiled */
+    else if ((o->cache != NULL) && !o->emitAst && !o->fromAst &&
+             !o->stream && !o->emitXref) {
+        ok = compileCached(tc, pgm, o, listing, messages, result);
+    }
+    else {
+        ok = compileSource(tc, pgm, o, messages, result);
+    }
+    if (result->kept == NULL) {
+        tinyFree(tc);
+    }
+    free(pgm);
+    return ok;
+}
+
+/* Function regenerateCode writes the code file of
+ * pgm, taken from directory, again from tc and
+ * tree, kept by compileFile, without compiling it
+ * again. Returns false if it cannot be written
+ */
+bool regenerateCode(TinyCompiler* tc, AstIndex tree, const char* directory,
+                    const char* pgm)
+{
+#if NO_PARSE || NO_ANALYZE || NO_CODE
+    (void)tc;
+    (void)tree;
+    (void)directory;
+    (void)pgm;
+    return false;
+#else
+    char* codefile = outputName(pgm, ".tm");
+    char* path = (codefile != NULL) ? pathFrom(directory, codefile) : NULL;
+    TinyCompiler* previous = tinyUse(tc);
+    tc->code = (path != NULL) ? fopen(path, "w") : NULL;
+    bool ok = tc->code != NULL;
+    if (ok) {
+        tc->gen = (CodeState){0, 0, 0};
+        codeGen(tree, codefile);
+        ok = fclose(tc->code) == 0;
+        tc->code = NULL;
+    }
+    tinyUse(previous);
+    free(path);
+    free(codefile);
+    return ok;
+#endif
+}
+
+/* addFile adds a copy of name to the files of cl.
+   Returns false if memory runs out */
+static bool addFile(CommandLine* cl, const char* name)
+{
+    if (cl->fileCount == cl->fileCapacity) {
+        int cap = (cl->fileCapacity == 0) ? 16 : 2 * cl->fileCapacity;
+        char** f = realloc(cl->files, (size_t)cap * sizeof(char*));
+        if (f == NULL) {
+            return false;
+        }
+        cl->files = f;
+        cl->fileCapacity = cap;
+    }
+    cl->files[cl->fileCount] = strdup(name);
+    return cl->files[cl->fileCount++] != NULL;
+}
+
+/* addFileList adds the files listed in the file
+   named list, one to a line. Returns false if it
+   cannot be read */
+static bool addFileList(CommandLine* cl, const char* list, FILE* messages)
+{
+    char* path = pathFrom(cl->options.directory, list);
+    FILE* f = (path != NULL) ? fopen(path, "r") : NULL;
+    free(path);
+    if (f == NULL) {
+        fprintf(messages, "File %s not found\n", list);
+        return false;
+    }
+    char* line = NULL;
+    size_t lineCapacity = 0;
+    ssize_t n;
+    bool ok = true;
+    while (ok && ((n = getline(&line, &lineCapacity, f)) > 0)) {
+        while ((n > 0) && ((line[n - 1] == '\n') || (line[n - 1] == '\r'))) {
+            line[--n] = '\0';
+        }
+        if (n > 0) {
+            ok = addFile(cl, line);
+        }
+    }
+    if (!ok) {
+        fprintf(messages, "Out of memory\n");
+    }
+    free(line);
+    fclose(f);
+    return ok;
+}
+
+/* Function parseCommandLine parses the argc
+ * arguments at argv, argv[0] naming the program,
+ * into cl. The files it names are taken from
+ * directory, or the current directory if it is
+ * NULL. Returns false, after saying why on
+ * messages, if they are not a command line of tiny
+ * or a file list cannot be read
+ */
+bool parseCommandLine(CommandLine* cl, int argc, char* argv[],
+                      const char* directory, FILE* messages)
+{
+    CompileOptions* o = &cl->options;
+    *cl = (CommandLine){{1, 1, false, false, false, false, false, false,
+                         false, false, directory, NULL},
+                        0, false, false, NULL, 0, 0};
+    bool usage = false;
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "--lex-threads") == 0) && (i + 1 < argc)) {
+            o->lexThreads = atoi(argv[++i]);
+        }
+        else if ((strcmp(argv[i], "--analyze-threads") == 0) &&
+                 (i + 1 < argc)) {
+            o->analyzeThreads = atoi(argv[++i]);
+        }
+        else if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc)) {
+            cl->jobs = atoi(argv[++i]);
+            usage = usage || (cl->jobs < 1);
+        }
+        else if (strcmp(argv[i], "--pipeline") == 0) {
+            o->pipelineParse = true;
+        }
+        else if (strcmp(argv[i], "--stack-parse") == 0) {
+            o->stackParse = true;
+        }
+        else if (strcmp(argv[i], "--emit-ast") == 0) {
+            o->emitAst = true;
+        }
+        else if (strcmp(argv[i], "--from-ast") == 0) {
+            o->fromAst = true;
+        }
+        else if (strcmp(argv[i], "--stream") == 0) {
+            o->stream = true;
+        }
+        else if (strcmp(argv[i], "--compact-slots") == 0) {
+            o->compact = true;
+        }
+        else if (strcmp(argv[i], "--emit-xref") == 0) {
+            o->emitXref = true;
+        }
+        else if ((strcmp(argv[i], "-v") == 0) ||
+                 (strcmp(argv[i], "--verbose") == 0)) {
+            cl->verbose = true;
+        }
+        else if (strcmp(argv[i], "--lsp") == 0) {
+            /* serve editors over stdin and stdout */
+            cl->lsp = true;
+            return true;
+        }
+        else if (argv[i][0] == '@') {
+            if (!addFileList(cl, argv[i] + 1, messages)) {
+                return false;
+            }
+            cl->jobs = (cl->jobs > 0) ? cl->jobs : 1;
+        }
+        else if (!addFile(cl, argv[i])) {
+            fprintf(messages, "Out of memory\n");
+            return false;
+        }
+    }
+    if ((cl->fileCount == 0) || usage || (o->lexThreads < 1) ||
+        (o->analyzeThreads < 1) || (o->emitAst && o->fromAst) ||
+        (o->stream && (o->emitAst || o->fromAst || o->compact ||
+                       o->emitXref))) {
+        fprintf(messages,
+                "usage: %s [-v] [--lex-threads N] [--analyze-threads N] "
+                "[--pipeline] [--stack-parse] [--compact-slots] "
+                "[--emit-xref] [--emit-ast | --from-ast] <filename.tny>\n"
+                "       %s [-v] --stream <filename.tny>\n"
+                "       %s -j N [options] <filename.tny | @filelist> ...\n"
+                "       %s --lsp\n"
+                "       %s --server\n"
+                "       %s --client <arguments of tiny>\n",
+                argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
+        return false;
+    }
+    if ((cl->fileCount > 1) && (cl->jobs == 0)) {
+        cl->jobs = 1;
+    }
+    o->cache = cacheOpen(messages);
+    return true;
+}
+
+/* Procedure freeCommandLine frees the files of cl
+ * and closes its cache
+ */
+void freeCommandLine(CommandLine* cl)
+{
+    cacheClose(cl->options.cache);
+    cl->options.cache = NULL;
+    for (int i = 0; i < cl->fileCount; i++) {
+        free(cl->files[i]);
+    }
+    free(cl->files);
+    cl->files = NULL;
+    cl->fileCount = cl->fileCapacity = 0;
+}
+
+/* plainCompile is the FileProc of compileFile */
+static bool plainCompile(const char* file, const CompileOptions* o,
+                         FILE* listing, FILE* messages, bool* errors,
+                         void* arg)
+{
+    FileResult result = {false, false, NULL, AST_NULL};
+    (void)arg;
+    bool ok = compileFile(file, o, listing, messages, &result);
+    *errors = result.errors;
+    return ok;
+}
+
+/* a Listing is the listing of a file of a batch,
+   held back until those of the files before it are
+   written */
+typedef struct {
+    char* text;
+    size_t size;
+    bool done;
+} Listing;
+
+/* a Batch is the files of a batch compilation and
+   what became of them */
+typedef struct {
+    const CommandLine* cl;
+    FileProc proc;
+    void* arg;
+    FILE* out;
+    FILE* messages;
+    pthread_mutex_t lock; /* guards what follows */
+    Listing* listings;    /* by file, or NULL on one thread */
+    int written;          /* listings written to out */
+    int errors;           /* files whose programs have errors */
+    int failed;           /* files that could not be compiled */
+} Batch;
+
+/* compileItem compiles file item of a batch. Its
+   listing is held back, and written out whole in
+   the order of the files, so that listings never
+   mix and come out the same on every run */
+static void compileItem(int item, void* arg)
+{
+    Batch* b = arg;
+    char* text = NULL;
+    size_t size = 0;
+    FILE* listing = open_memstream(&text, &size);
+    bool errors = false;
+    bool ok = false;
+    if (listing == NULL) {
+        fprintf(b->messages, "Out of memory\n");
+    }
+    else {
+        ok = b->proc(b->cl->files[item], &b->cl->options, listing,
+                     b->messages, &errors, b->arg);
+        ok = (fclose(listing) == 0) && ok;
+    }
+    pthread_mutex_lock(&b->lock);
+    if (b->listings == NULL) {
+        /* one thread: the files come in order */
+        if (text != NULL) {
+            fwrite(text, 1, size, b->out);
+        }
+        free(text);
+    }
+    else {
+        b->listings[item] = (Listing){text, size, true};
+        while ((b->written < b->cl->fileCount) &&
+               b->listings[b->written].done) {
+            Listing* l = &b->listings[b->written++];
+            if (l->text != NULL) {
+                fwrite(l->text, 1, l->size, b->out);
+            }
+            free(l->text);
+            l->text = NULL;
+        }
+    }
+    b->errors += errors ? 1 : 0;
+    b->failed += ok ? 0 : 1;
+    pthread_mutex_unlock(&b->lock);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* reportCache writes the hits and misses of cache to
+   messages, or that there is none */
+static void reportCache(const DiskCache* cache, FILE* messages)
+{
+    if (cache == NULL) {
+        fprintf(messages, "tiny: no cache, %s is not set\n", CACHE_ENV);
+    }
+    else {
+        fprintf(messages, "tiny: cache %s: %lu hits, %lu misses\n",
+                cache->dir, cache->hits, cache->misses);
+    }
+}
+
+/* Function runCommandLine compiles the files of cl
+ * by proc, or compileFile if proc is NULL, the
+ * listing going to out and the messages to
+ * messages. A batch is compiled on cl->jobs threads,
+ * its listings written in the order of the files,
+ * and its throughput, and the hits and misses of
+ * the cache, written to messages; with cl->verbose
+ * the cache is reported for one file as well.
+ * Returns the exit status of tiny
+ */
+int runCommandLine(const CommandLine* cl, FILE* out, FILE* messages,
+                   FileProc proc, void* arg)
+{
+    if (proc == NULL) {
+        proc = plainCompile;
+    }
+    int jobs = cl->jobs;
+#if GEN_FRONTEND
+    /* the generated scanner and parser keep their
+       state in statics of their own */
+    jobs = (jobs > 1) ? 1 : jobs;
+#endif
+    if (jobs == 0) {
+        bool errors;
+        bool ok = proc(cl->files[0], &cl->options, out, messages, &errors,
+                       arg);
+        if (cl->verbose) {
+            reportCache(cl->options.cache, messages);
+        }
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    /* a batch: each file is compiled on its own, on
+       one of jobs threads */
+    Batch b = {cl, proc, arg, out, messages, PTHREAD_MUTEX_INITIALIZER,
+               NULL, 0, 0, 0};
+    if ((jobs > 1) && (cl->fileCount > 1)) {
+        b.listings = calloc((size_t)cl->fileCount, sizeof(Listing));
+        jobs = (b.listings != NULL) ? jobs : 1;
+    }
+    double t0 = now();
+    batchRun(cl->fileCount, jobs, compileItem, &b);
+    double t = now() - t0;
+    free(b.listings);
+    fflush(out);
+    fprintf(messages,
+            "tiny: %d files on %d threads in %.3f s, %.0f files/s "
+            "(%d with errors, %d not compiled)\n",
+            cl->fileCount, (jobs < cl->fileCount) ? jobs : cl->fileCount, t,
+            (t > 0) ? cl->fileCount / t : 0.0, b.errors, b.failed);
+    if ((cl->options.cache != NULL) || cl->verbose) {
+        reportCache(cl->options.cache, messages);
+    }
+    return (b.failed > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -7,17 +7,52 @@
 
 #ifndef _ANALYZE_H_
 #define _ANALYZE_H_
+#include "ast.h"
 #include "globals.h"
+#include "pass.h"
 #include "symtab.h"
 
 /* Function buildSymtab constructs the symbol
  * table by preorder traversal of the syntax tree
  */
-void buildSymtab(TreeNode* tree);
+void buildSymtab(AstIndex tree);
+
+/* Procedure addSymbols enters the identifiers of
+ * statement stmt into the symbol table, as
+ * buildSymtab does for each statement in turn, but
+ * does not list the table
+ */
+void addSymbols(AstIndex stmt);
 
 /* Procedure typeCheck performs type checking
  * by a postorder syntax tree traversal
  */
-void typeCheck(TreeNode* tree);
+void typeCheck(AstIndex tree);
+
+/* symtabPass is buildSymtab as a pass. With
+ * TraceAnalyze it lists its heading as it starts
+ * and the table as it finishes
+ */
+extern const Pass symtabPass;
+
+/* typeCheckPass is typeCheck as a pass. Its errors
+ * are held back and listed as it finishes, after
+ * whatever the passes before it list, under the
+ * headings TraceAnalyze adds
+ */
+extern const Pass typeCheckPass;
+
+/* Procedure analyzeParallel does the work of
+ * symtabPass and typeCheckPass over the statement
+ * sequence tree, with the top level statements
+ * split into slices analyzed on a pool of threads
+ * workers. The names of each slice go to the sharded
+ * symbol table a shard per task, slice by slice, so
+ * the table, the memory locations and the listing
+ * come out as they do from the serial passes. Small
+ * programs or a single thread run the slices on the
+ * calling thread
+ */
+void analyzeParallel(AstIndex tree, int threads);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+/****************************************************/
+/* File: arena.h                                    */
+/* Bump-pointer arena allocator for the TINY        */
+/* compiler: objects are carved out of large blocks */
+/* in allocation order and released all at once     */
+/****************************************************/
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ARENA_ALIGN = alignment of every arenaAlloc result */
+#define ARENA_ALIGN alignof(max_align_t)
+
+/* ARENA_BLOCKSIZE = usual size of an arena block */
+#define ARENA_BLOCKSIZE 65536
+
+typedef struct ArenaBlock ArenaBlock;
+
+/* An Arena is empty when zero-initialized */
+typedef struct {
+    ArenaBlock* blocks; /* newest block first */
+    char* next;         /* first free byte of the newest block */
+    char* limit;        /* end of the newest block */
+} Arena;
+
+/* Function arenaGrow starts a new block holding at
+ * least size bytes and allocates them from it.
+ * Returns NULL if memory runs out
+ */
+void* arenaGrow(Arena* arena, size_t size);
+
+/* Function arenaAlloc returns size bytes of arena,
+ * aligned to ARENA_ALIGN. Returns NULL if memory
+ * runs out
+ */
+static inline void* arenaAlloc(Arena* arena, size_t size)
+{
+    uintptr_t p = ((uintptr_t)arena->next + (ARENA_ALIGN - 1)) &
+                  ~(uintptr_t)(ARENA_ALIGN - 1);
+    if ((p > (uintptr_t)arena->limit) || ((uintptr_t)arena->limit - p < size)) {
+        return arenaGrow(arena, size);
+    }
+    arena->next = (char*)p + size;
+    return (void*)p;
+}
+
+/* Function arenaCopy copies the len characters at s
+ * into arena, with a terminating NUL, unaligned.
+ * Returns NULL if memory runs out
+ */
+char* arenaCopy(Arena* arena, const char* s, size_t len);
+
+/* Procedure arenaReset frees everything allocated
+ * from arena but keeps its newest block for reuse
+ */
+void arenaReset(Arena* arena);
+
+/* Procedure arenaRelease frees every block of arena
+ * and leaves it empty
+ */
+void arenaRelease(Arena* arena);
+
+#endif
@@ -0,0 +1,154 @@
+/****************************************************/
+/* File: ast.h                                      */
+/* Compact syntax tree for the TINY compiler        */
+/* Nodes live in one contiguous vector and refer to */
+/* each other by 32-bit index through first-child   */
+/* and next-sibling links                           */
+/****************************************************/
+
+#ifndef _AST_H_
+#define _AST_H_
+
+#include <stdint.h>
+
+#include "globals.h"
+
+/* an AstIndex names a node of the vector; index 0
+   is never a node and stands for no node */
+typedef uint32_t AstIndex;
+#define AST_NULL 0
+
+/* AstKind folds NodeKind and the statement and
+ * expression kinds into one byte. A statement kind k
+ * is AstKind k, an expression kind k is AstOp + k.
+ * AstSeq holds a statement sequence as its children;
+ * AstNil fills a child slot that holds no node
+ */
+typedef enum {
+    AstIf,
+    AstRepeat,
+    AstAssign,
+    AstRead,
+    AstWrite,
+    AstWhile,
+    AstSwitch,
+    AstCase,
+    AstOp,
+    AstConst,
+    AstId,
+    AstSeq,
+    AstNil
+} AstKind;
+
+/* An AstNode is 20 bytes against 56 for a TreeNode.
+ * Child slot i of a node is its i-th child in the
+ * child chain; slots holding a statement sequence
+ * hold an AstSeq. The value word depends on kind:
+ *   AstOp                      the operator TokenType
+ *   AstConst                   the constant
+ *   AstId, AstAssign, AstRead  the symbol id
+ */
+typedef struct {
+    uint8_t kind;     /* AstKind */
+    uint8_t zero[3];  /* always 0, so a node has no padding */
+    int line;         /* source line of the node */
+    AstIndex child;   /* first child */
+    AstIndex next;    /* next sibling */
+    int value;        /* kind dependent payload */
+} AstNode;
+
+/* Function astStmt adds a statement node of kind
+ * kind to the vector and returns its index.
+ * Returns AST_NULL if memory runs out
+ */
+AstIndex astStmt(StmtKind kind);
+
+/* Function astExp adds an expression node of kind
+ * kind to the vector and returns its index.
+ * Returns AST_NULL if memory runs out
+ */
+AstIndex astExp(ExpKind kind);
+
+/* Function astSeq adds an empty statement sequence
+ * to the vector and returns its index. Returns
+ * AST_NULL if memory runs out
+ */
+AstIndex astSeq(void);
+
+/* Procedure astAddChild makes child the last child
+ * of parent; a child of AST_NULL leaves an empty
+ * slot (AstNil)
+ */
+void astAddChild(AstIndex parent, AstIndex child);
+
+/* Procedure astAddSibling makes next the sibling
+ * after node, which must be the last of its chain.
+ * Long statement sequences are built with it, as
+ * astAddChild walks the chain to its end
+ */
+void astAddSibling(AstIndex node, AstIndex next);
+
+/* Procedure astSetValue sets the payload of node */
+void astSetValue(AstIndex node, int value);
+
+/* Procedure astShiftLines adds delta to the line of
+ * the count nodes from first: the nodes of a
+ * statement parsed on its own, which are made in a
+ * run, the statement first
+ */
+void astShiftLines(AstIndex first, size_t count, int delta);
+
+/* Function astNode returns the node at index i. It
+ * stays valid until the next node is added
+ */
+const AstNode* astNode(AstIndex i);
+
+/* Function astCount returns the number of nodes */
+size_t astCount(void);
+
+/* Procedure astTruncate drops every node after the
+ * first n, keeping the vector for the nodes added
+ * next. A tree built one statement at a time so
+ * takes no more room than its largest statement
+ */
+void astTruncate(size_t n);
+
+/* Procedure astAttach replaces the vector with the
+ * n entries at vector, entry 0 included, without
+ * copying them. The caller keeps ownership; no node
+ * may be added or changed until freeAst
+ */
+void astAttach(const AstNode* vector, AstIndex n);
+
+/* Procedure freeAst releases every node */
+void freeAst(void);
+
+/* a TreeProc handles one expanded syntax tree */
+typedef void (*TreeProc)(TreeNode* tree);
+
+/* Procedure astForEachStatement is the adapter for
+ * the phases written against TreeNode: it expands
+ * each statement of sequence seq in turn into a
+ * scratch TreeNode tree, with no siblings, and
+ * passes it to proc. Only one statement is ever
+ * expanded at a time. A seq that is a statement of
+ * its own is expanded by itself
+ */
+void astForEachStatement(AstIndex seq, TreeProc proc);
+
+/* Procedure astForEachStatementOf does the work of
+ * astForEachStatement for statement stmt and the
+ * statements after it in its sequence, n at most.
+ * Threads may run it at once, as long as no node is
+ * added: each expands into scratch of its own, kept
+ * until astReleaseScratch
+ */
+void astForEachStatementOf(AstIndex stmt, size_t n, TreeProc proc);
+
+/* Procedure astReleaseScratch frees the scratch
+ * space the statements expanded on the calling
+ * thread took
+ */
+void astReleaseScratch(void);
+
+#endif
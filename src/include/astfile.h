@@ -0,0 +1,58 @@
+/****************************************************/
+/* File: astfile.h                                  */
+/* Binary syntax tree files for the TINY compiler   */
+/* A file holds the node vector of ast.h as is and  */
+/* the names of the symbols it uses, so that it can */
+/* be mapped and used without parsing              */
+/****************************************************/
+
+#ifndef _ASTFILE_H_
+#define _ASTFILE_H_
+
+#include "ast.h"
+#include "source.h"
+
+/* AST_FILE_VERSION changes whenever the layout of
+   the file or of AstNode does */
+#define AST_FILE_VERSION 1
+
+/* The file starts with an AstFileHeader, followed by
+ * nodeCount AstNodes (entry 0 unused), symbolCount
+ * uint32_t offsets into the string table, and the
+ * string table of stringBytes NUL terminated names.
+ * Symbol i of the file is symbol id i. Numbers are
+ * in the byte order of the writer
+ */
+typedef struct {
+    char magic[8];        /* "TINYAST" */
+    uint32_t version;     /* AST_FILE_VERSION */
+    uint32_t byteOrder;   /* 0x01020304 as written */
+    uint32_t nodeSize;    /* sizeof(AstNode) */
+    uint32_t nodeCount;   /* entries of the node vector */
+    uint32_t root;        /* the statement sequence of the program */
+    uint32_t symbolCount; /* entries of the offset table */
+    uint32_t stringBytes; /* size of the string table */
+    uint32_t reserved;    /* zero */
+} AstFileHeader;
+
+/* Function astWrite writes the tree at root and the
+ * names of the intern pool to file. Returns false
+ * if writing fails
+ */
+bool astWrite(FILE* file, AstIndex root);
+
+/* Function astRead maps the tree file file, or reads
+ * it if readSources is set, attaches its nodes with
+ * astAttach and interns its names, so that their
+ * symbol ids match the file. Returns the root, or
+ * AST_NULL if file is not a valid tree file of this
+ * version
+ */
+AstIndex astRead(FILE* file);
+
+/* Procedure releaseAstFile unmaps the file of
+ * astRead, after freeAst
+ */
+void releaseAstFile(void);
+
+#endif
@@ -0,0 +1,28 @@
+/****************************************************/
+/* File: batch.h                                    */
+/* Work-stealing batch scheduler for the TINY       */
+/* compiler: runs a procedure on every item of a    */
+/* batch across a number of threads                 */
+/****************************************************/
+
+#ifndef _BATCH_H_
+#define _BATCH_H_
+
+/* an item procedure is applied to the number of one
+   item of a batch and an argument */
+typedef void (*ItemProc)(int item, void* arg);
+
+/* Procedure batchRun applies proc to every item
+ * from 0 up to count - 1 on threads threads, the
+ * calling thread among them, running in its
+ * context. Each thread starts on an equal share of
+ * the items, taken in order, and a thread whose
+ * share runs out steals the later half of the
+ * largest share left, so that threads given cheap
+ * items take over from those given costly ones.
+ * Threads that cannot be started leave their
+ * shares to be stolen
+ */
+void batchRun(int count, int threads, ItemProc proc, void* arg);
+
+#endif
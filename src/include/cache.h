@@ -0,0 +1,87 @@
+/****************************************************/
+/* File: cache.h                                    */
+/* Compilation cache for the TINY compiler: a       */
+/* directory of compilations named by the digest of */
+/* the compiler, its options and the source         */
+/****************************************************/
+
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+#include <pthread.h>
+
+#include "globals.h"
+#include "sha256.h"
+
+/* CACHE_ENV names the variable naming the cache
+   directory; there is no cache if it is unset */
+#define CACHE_ENV "TINY_CACHE"
+/* CACHE_SIZE_ENV names the variable giving the most
+   bytes the cache may hold, with K, M or G after
+   them for kibibytes, mebibytes or gibibytes */
+#define CACHE_SIZE_ENV "TINY_CACHE_SIZE"
+#define CACHE_SIZE (64ull << 20)
+
+/* a CacheItem is a compilation the cache holds */
+typedef struct {
+    bool ok;     /* it was compiled */
+    bool errors; /* the program has errors */
+    char* listing;
+    size_t listingSize;
+    char* messages;
+    size_t messagesSize;
+    char* code; /* the code file, or NULL if none */
+    size_t codeSize;
+} CacheItem;
+
+/* a DiskCache is a cache directory in use, shared
+   by the threads of a batch */
+typedef struct {
+    char* dir;
+    unsigned long long limit; /* the most bytes it holds */
+    /* the digest of the compiler itself, so that no
+       other build of it sees its entries */
+    unsigned char compiler[SHA256_SIZE];
+    /* guards what follows, and the size file among
+       the threads of the process */
+    pthread_mutex_t lock;
+    unsigned long hits;
+    unsigned long misses;
+} DiskCache;
+
+/* Function cacheOpen returns the cache CACHE_ENV
+ * names, made if it does not exist, or NULL if it
+ * is unset. Says why on messages if it cannot be
+ * used, and returns NULL
+ */
+DiskCache* cacheOpen(FILE* messages);
+
+/* Procedure cacheClose closes c, if it is not NULL */
+void cacheClose(DiskCache* c);
+
+/* Procedure cacheKeyBegin starts h as a key of c:
+ * what else the compilation depends on is added
+ * to it by sha256Update
+ */
+void cacheKeyBegin(const DiskCache* c, Sha256* h);
+
+/* Function cacheFetch sets item to the compilation
+ * of c under key, counting a hit, and marks it used
+ * last. Returns false, counting a miss, if c does
+ * not hold one
+ */
+bool cacheFetch(DiskCache* c, const unsigned char key[SHA256_SIZE],
+                CacheItem* item);
+
+/* Procedure cacheStore writes item to c under key,
+ * replacing the entry whole, and lets go of the
+ * entries used longest ago while c holds more than
+ * its limit
+ */
+void cacheStore(DiskCache* c, const unsigned char key[SHA256_SIZE],
+                const CacheItem* item);
+
+/* Procedure cacheFreeItem frees the text of item */
+void cacheFreeItem(CacheItem* item);
+
+#endif
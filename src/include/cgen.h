@@ -7,6 +7,7 @@
 
 #ifndef _CGEN_H_
 #define _CGEN_H_
+#include "ast.h"
 #include "code.h"
 #include "globals.h"
 #include "symtab.h"
@@ -17,6 +18,24 @@
  * of the code file, and is used to print the
  * file name as a comment in the code file
  */
-void codeGen(TreeNode* syntaxTree, char* codefile);
+void codeGen(AstIndex syntaxTree, const char* codefile);
+
+/* Procedure codeGenBegin starts the code of a
+ * program generated a statement at a time, writing
+ * what codeGen writes before the first statement
+ */
+void codeGenBegin(const char* codefile);
+
+/* Procedure codeGenStatement generates the code of
+ * statement stmt, the next of the program begun by
+ * codeGenBegin. Jumps are backpatched within it, so
+ * its tree may be dropped once it returns
+ */
+void codeGenStatement(AstIndex stmt);
+
+/* Procedure codeGenEnd finishes the code of the
+ * program begun by codeGenBegin
+ */
+void codeGenEnd(void);
 
 #endif
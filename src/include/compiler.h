@@ -0,0 +1,447 @@
+/****************************************************/
+/* File: compiler.h                                 */
+/* The compilation context of the TINY compiler:    */
+/* everything a compilation changes as it runs, in  */
+/* one TinyCompiler, so that compilations with      */
+/* contexts of their own share no mutable state and */
+/* may run at once on different threads             */
+/****************************************************/
+
+#ifndef _COMPILER_H_
+#define _COMPILER_H_
+
+#include <pthread.h>
+
+#include "analyze.h"
+#include "arena.h"
+#include "ast.h"
+#include "globals.h"
+#include "incr.h"
+#include "parse.h"
+#include "pass.h"
+#include "ring.h"
+#include "scan.h"
+#include "source.h"
+#include "symtab.h"
+#include "util.h"
+
+/* A Lexer scans one span of the source buffer: the
+ * rest of the buffer, or a chunk that ends at the
+ * start of a line (see tokenizeParallel)
+ */
+typedef struct {
+    const char* cursor; /* next character to be read */
+    const char* limit;  /* end of the span */
+    int line;           /* line count at the cursor */
+    int eofReads;       /* times the end of input has been read */
+    bool inComment;     /* a chunk ended inside a comment */
+} Lexer;
+
+/* ScanState is the state of scan.c */
+typedef struct {
+    /* the whole source text, terminated by a '\0' sentinel */
+    SourceBuffer sourceBuf;
+    const char* text;     /* first character of the source */
+    const char* bufEnd;   /* position of the sentinel */
+    bool endsWithNewline; /* the last line has a '\n' */
+    /* the lexer behind getToken and tokenize */
+    Lexer lexer;
+    /* lexeme of identifier or reserved word */
+    char tokenString[MAXTOKENLEN + 1];
+} ScanState;
+
+/* A Stack is a growable array of symbols, nodes or
+   operator levels */
+typedef struct {
+    uint32_t* items;
+    size_t count;
+    size_t capacity;
+} Stack;
+
+/* ParseState is the state of parse.c */
+typedef struct {
+    TokenType currentToken; /* holds current token */
+    Token token;            /* all of the current token */
+    /* the token stream being parsed, and the index
+       of currentToken in it */
+    TokenStream tokens;
+    size_t tokenPos;
+    /* in pipeline mode the tokens come from a scanner
+       thread through ring instead of from tokens */
+    TokenRing* ring;
+    pthread_t scanner;
+    bool scanFailed; /* the scanner thread ran out of memory */
+    /* a parse begun by parseBegin takes its tokens from
+       tokenSource instead, and statements parsed before
+       from keptSource */
+    TokenSource tokenSource;
+    StatementSource keptSource;
+    /* symbols = the parse stack; values = the nodes
+       built so far; ops = pending operators and open
+       parentheses of the current expression */
+    Stack symbols;
+    Stack values;
+    Stack ops;
+} ParseState;
+
+/* AstState is the state of ast.c: the node vector;
+   nodes[0] is unused so that AST_NULL is never a
+   node */
+typedef struct {
+    AstNode* nodes;
+    AstIndex count;
+    AstIndex capacity;
+    bool attached; /* nodes belongs to astAttach's caller */
+} AstState;
+
+/* InternState is the state of intern.c */
+typedef struct {
+    /* the characters of every name */
+    Arena nameArena;
+    /* per-symbol data, indexed by symbol id */
+    const char** names;
+    size_t* lengths;
+    unsigned* hashes;
+    int count;
+    int capacity;
+    /* the probing table holds id + 1, 0 marks a free
+       slot; its size is a power of two */
+    int* slots;
+    size_t slotMask;
+} InternState;
+
+/* an ErrorList holds type errors back in order */
+typedef struct {
+    struct TypeError* items;
+    size_t count;
+    size_t capacity;
+} ErrorList;
+
+/* AnalyzeState is the state of analyze.c */
+typedef struct {
+    /* counter for variable memory locations */
+    int location;
+    /* symtabPass has entered a node */
+    bool entered;
+    /* while typeCheckPass runs, type errors are held
+       back in heldErrors */
+    ErrorList heldErrors;
+} AnalyzeState;
+
+/* A SymShard holds the names of the symbol table
+ * whose hashes start with its number: its entries,
+ * in order of insertion, the probing table over
+ * them, whose size is a power of two, and the
+ * chunks of their line lists
+ */
+typedef struct {
+    struct SymEntry* entries;
+    int count;
+    int capacity;
+    struct SymSlot* slots;
+    size_t slotMask;
+    Arena lineArena;
+} SymShard;
+
+/* PassState is the state of pass.c */
+typedef struct {
+    /* the passes added, in order */
+    const Pass* passes[MAXPASSES];
+    int passCount;
+    /* the passes of the walk under way: passes[first]
+       up to passes[last] */
+    int first;
+    int last;
+} PassState;
+
+/* CodeState is the state of code.c and cgen.c */
+typedef struct {
+    /* TM location number for current instruction emission */
+    int emitLoc;
+    /* Highest TM location emitted so far
+       For use in conjunction with emitSkip,
+       emitBackup, and emitRestore */
+    int highEmitLoc;
+    /* tmpOffset is the memory offset for temps
+       It is decremented each time a temp is
+       stored, and incremeted when loaded again */
+    int tmpOffset;
+} CodeState;
+
+/* SlotState is the state of slots.c */
+typedef struct {
+    /* the uses and stores of variables, in order */
+    int* events;
+    size_t eventCount;
+    size_t eventCapacity;
+    /* the blocks of the flow graph, in order of their
+       code: the block being filled is always the last */
+    struct SlotBlock* blocks;
+    int blockCount;
+    int blockCapacity;
+    /* names[v] is the name of the variable at v */
+    int* names;
+    int varCount;
+    int varCapacity;
+    /* the flow graph could not be built */
+    bool failed;
+} SlotState;
+
+/* XrefState is the state of xref.c: the occurrences
+   of the tree being indexed */
+typedef struct {
+    struct Occurrence* found;
+    size_t foundCount;
+    size_t foundCapacity;
+    bool foundFailed;
+} XrefState;
+
+/* IncrState is the state of incr.c: the document
+   open in the context and the redoing of an edit */
+typedef struct {
+    /* the segments of the document, in order, and for
+       each whether it is top level and holds errors,
+       and whether its statement is stray or did not
+       parse cleanly */
+    struct Segment** segments;
+    size_t segmentCount;
+    size_t segmentCapacity;
+    unsigned char* flagged;
+    size_t flagCapacity;
+    unsigned char* blocking;
+    size_t blockCapacity;
+
+    /* the top level segment whose statement runs on
+       unclosed to the end, taking in the segments
+       after it, which are left top level segments
+       until an edit reaches them; NONE if there is
+       none */
+    size_t openHead;
+
+    /* the segments from shiftFrom on lie shiftBytes
+       and shiftLines further on than their offset and
+       line say: moving them is left until an edit
+       reaches them, so that edits close together are
+       cheap */
+    size_t shiftFrom;
+    size_t shiftBytes;
+    int shiftLines;
+
+    size_t docLength;   /* bytes in the document */
+    size_t liveNodes;   /* tree nodes still in a segment */
+    size_t syntaxTotal; /* syntax errors of top level segments */
+    size_t typeTotal;   /* type errors of top level segments */
+
+    /* the work area: the text of the segments being
+       redone, edited, with the tokens the parser reads */
+    char* work;
+    size_t workSize;
+    size_t workCapacity;
+    Token* workTokens; /* offsets into work, real lines */
+    size_t workCount;
+    size_t workTokenCapacity;
+    int firstLine;     /* newlines in the document before work */
+    int workLines;     /* newlines in work */
+    size_t prefixSize; /* bytes of the segments before the edit */
+    int prefixLines;   /* and their newlines */
+
+    /* the tokens of relexing work after the prefix */
+    Token* scanned;
+    size_t scannedCount;
+    size_t scannedCapacity;
+
+    /* the parse of the work area. Segments are handed
+       to it whole: those before the edit, then the
+       scanned tokens, then those following */
+    size_t regionFirst; /* the first segment being redone */
+    size_t edited;      /* the first segment relexed */
+    size_t following;   /* the first segment not in work */
+    size_t nextPrefix;  /* the next segment before the edit */
+    size_t prefixAt;    /* where its text is in work */
+    int prefixLine;     /* and the newlines before it */
+    bool scannedOut;    /* the scanned tokens were handed out */
+    size_t pulled;      /* tokens handed to the parser */
+    size_t current;     /* the parser's current token */
+    bool appended;      /* the kept segment is being handed out */
+    bool rest;          /* only its first token is in workTokens */
+    bool keptFollows;   /* it comes after the edit */
+    size_t pieceFrom;   /* the first token of the top statement */
+    bool skipped;       /* the parse was handed the end early */
+    bool skipNested;    /* inside the statement at pieceFrom */
+    size_t keptSegment; /* the last segment handed out whole */
+    size_t keptText;    /* where it starts in work */
+    size_t keptToken;   /* and in workTokens */
+    int keptLine;       /* and the newlines before its text */
+    bool outOfMemory;
+
+    /* the segments taken whole into the statements
+       being parsed, the top level statements parsed
+       and the segments they are cut into */
+    struct Reuse* reuses;
+    size_t reuseCount;
+    size_t reuseCapacity;
+    struct Piece* pieces;
+    size_t pieceCount;
+    size_t pieceCapacity;
+    struct Part* parts;
+    size_t partCount;
+    size_t partCapacity;
+
+    /* errors reported while redoing, with real lines */
+    struct Message* pending;
+    size_t pendingCount;
+    size_t pendingCapacity;
+
+    /* the results of docDiagnostics and docReferences */
+    Diagnostic* published;
+    size_t publishedCapacity;
+    DocPosition* found;
+    size_t foundCapacity;
+
+    /* columns are counted in UTF-16 code units, not
+       bytes (see docUtf16) */
+    bool utf16;
+} IncrState;
+
+/* UtilState is the state of util.c */
+typedef struct {
+    /* every syntax tree node and string copy lives in
+       treeArena, in the order they were made */
+    Arena treeArena;
+    /* the listener set by setDiagnosticProc */
+    DiagnosticProc diagnosticProc;
+} UtilState;
+
+/* A TinyCompiler is the context of a compilation:
+ * its files, its flags and the state of each of its
+ * phases. A compilation runs in the context bound
+ * to its thread by tinyUse; the threads it starts
+ * run in that context too
+ */
+typedef struct TinyCompiler {
+    const char* filePath; /* file path name */
+    const char* directory; /* relative names are from here, if not NULL */
+    FILE* source;   /* source code text file */
+    FILE* listing;  /* listing output text file */
+    FILE* code;     /* code text file for TM simulator */
+
+    int lineno; /* source line number for listing */
+
+    /* echoSource = true causes the source program to
+     * be echoed to the listing file with line numbers
+     * during parsing
+     */
+    bool echoSource;
+
+    /* traceScan = true causes token information to be
+     * printed to the listing file as each token is
+     * recognized by the scanner
+     */
+    bool traceScan;
+
+    /* traceParse = true causes the syntax tree to be
+     * printed to the listing file in linearized form
+     * (using indents for children)
+     */
+    bool traceParse;
+
+    /* traceAnalyze = true causes symbol table inserts
+     * and lookups to be reported to the listing file
+     */
+    bool traceAnalyze;
+
+    /* traceCode = true causes comments to be written
+     * to the TM code file as code is generated
+     */
+    bool traceCode;
+
+    /* lexThreads = number of threads the scanner may
+     * split the source program across
+     */
+    int lexThreads;
+
+    /* analyzeThreads = number of threads semantic
+     * analysis may split the top level statements
+     * across
+     */
+    int analyzeThreads;
+
+    /* pipelineParse = true runs the scanner on a thread
+     * of its own, feeding the parser as it goes
+     */
+    bool pipelineParse;
+
+    /* stackParse = true parses with explicit stacks
+     * instead of recursive descent, so that nesting
+     * depth is bounded by memory rather than the C stack
+     */
+    bool stackParse;
+
+    /* readSources = true reads the source into memory
+     * instead of mapping it, for a resident server:
+     * a mapped file truncated as it is compiled raises
+     * SIGBUS, and one that grows loses its sentinel
+     */
+    bool readSources;
+
+    /* error = true prevents further passes if an error occurs */
+    bool error;
+
+    /* the state of each phase */
+    ScanState scan;
+    ParseState parse;
+    AstState ast;
+    SourceBuffer astFile; /* the mapped file of astRead */
+    InternState intern;
+    SymShard shards[SYMSHARDS]; /* the symbol table */
+    AnalyzeState analyze;
+    PassState pass;
+    CodeState gen;
+    SlotState slots;
+    XrefState xref;
+    IncrState incr;
+    UtilState util;
+    bool streamScanFailed; /* the scanner of stream.c ran out of memory */
+} TinyCompiler;
+
+/* every phase reads tiny: the initial-exec model
+   keeps that a load off the thread pointer, where a
+   call to __tls_get_addr would be made in position
+   independent code. The shared libtiny keeps the
+   default model, which dlopen can always load */
+#if defined(__GNUC__) && !defined(TINY_SHARED)
+#define TINY_TLS __attribute__((tls_model("initial-exec")))
+#else
+#define TINY_TLS
+#endif
+
+/* tiny is the context of the compilation running
+   on this thread */
+extern _Thread_local TinyCompiler* tiny TINY_TLS;
+
+/* Function tinyNew returns a new context with every
+ * flag off but one thread for each phase and no
+ * files, or NULL if memory runs out
+ */
+TinyCompiler* tinyNew(void);
+
+/* Function tinyUse binds tc to the calling thread,
+ * for the compilation run on it, and returns the
+ * context bound before, or NULL
+ */
+TinyCompiler* tinyUse(TinyCompiler* tc);
+
+/* Procedure tinyFree releases what the phases of tc
+ * hold and tc itself. It does not close the files
+ * of tc
+ */
+void tinyFree(TinyCompiler* tc);
+
+/* Function pathFrom returns name taken from the
+ * directory directory, in memory of its own: name
+ * itself if it is absolute or directory is NULL.
+ * Returns NULL if memory runs out
+ */
+char* pathFrom(const char* directory, const char* name);
+
+#endif
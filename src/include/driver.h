@@ -0,0 +1,135 @@
+/****************************************************/
+/* File: driver.h                                   */
+/* The compiler driver of the TINY compiler: parses */
+/* a command line of tiny and compiles its files,   */
+/* one at a time or as a batch                      */
+/****************************************************/
+
+#ifndef _DRIVER_H_
+#define _DRIVER_H_
+
+#include "ast.h"
+#include "cache.h"
+#include "compiler.h"
+
+/* CompileOptions are the options of a command line,
+   which apply to every file compiled */
+typedef struct {
+    int lexThreads;
+    int analyzeThreads;
+    bool pipelineParse;
+    bool stackParse;
+    bool emitAst;  /* write the tree to <name>.ast */
+    bool fromAst;  /* file is a tree written by --emit-ast */
+    bool stream;   /* compile a statement at a time */
+    bool compact;  /* share the locations of variables */
+    bool emitXref; /* write the index to <name>.xrf */
+    bool readSources; /* read sources instead of mapping them */
+    const char* directory; /* of relative names, or NULL for the current */
+    DiskCache* cache; /* compilations by content, or NULL */
+} CompileOptions;
+
+/* A CommandLine is a command line of tiny, parsed */
+typedef struct {
+    CompileOptions options;
+    int jobs;     /* threads for a batch; 0 for one file */
+    bool lsp;     /* serve editors instead */
+    bool verbose; /* report the cache of every run */
+    char** files;
+    int fileCount;
+    int fileCapacity;
+} CommandLine;
+
+/* A FileResult is what became of a file compiled by
+ * compileFile. If keep is set when it is called, the
+ * context of a program compiled without errors is
+ * kept, with its syntax tree, for regenerateCode
+ */
+typedef struct {
+    bool keep;
+    bool errors;        /* the program has errors */
+    TinyCompiler* kept; /* the context kept, or NULL */
+    AstIndex tree;
+} FileResult;
+
+/* a FileProc compiles a file of a command line the
+   way compileFile does, setting *errors, with
+   arg for its own use */
+typedef bool (*FileProc)(const char* file, const CompileOptions* o,
+                         FILE* listing, FILE* messages, bool* errors,
+                         void* arg);
+
+/* Function parseCommandLine parses the argc
+ * arguments at argv, argv[0] naming the program,
+ * into cl, opening the cache CACHE_ENV names. The
+ * files it names are taken from directory, or the
+ * current directory if it is NULL. Returns false,
+ * after saying why on messages, if they are not a
+ * command line of tiny or a file list cannot be
+ * read
+ */
+bool parseCommandLine(CommandLine* cl, int argc, char* argv[],
+                      const char* directory, FILE* messages);
+
+/* Procedure freeCommandLine frees the files of cl
+ * and closes its cache
+ */
+void freeCommandLine(CommandLine* cl);
+
+/* Function sourceName returns the name of the source
+ * file named file: file, or file.tny if it has no
+ * extension, in memory of its own. Returns NULL if
+ * memory runs out
+ */
+char* sourceName(const char* file);
+
+/* Function outputName returns the name of pgm with
+ * its extension replaced by ext, in memory of its
+ * own. Returns NULL if memory runs out
+ */
+char* outputName(const char* pgm, const char* ext);
+
+/* Function compileFile compiles file, or file.tny if
+ * it has no extension, in a context of its own, with
+ * the listing sent to listing and the messages of
+ * tiny to messages. Its files are taken from
+ * o->directory. Returns false if it cannot be read
+ * or its output written
+ */
+bool compileFile(const char* file, const CompileOptions* o, FILE* listing,
+                 FILE* messages, FileResult* result);
+
+/* Function regenerateCode writes the code file of
+ * pgm, taken from directory, again from tc and
+ * tree, kept by compileFile, without compiling it
+ * again. Returns false if it cannot be written
+ */
+bool regenerateCode(TinyCompiler* tc, AstIndex tree, const char* directory,
+                    const char* pgm);
+
+/* Function compileTree runs the phases after the
+ * parse over tree, in the context bound to the
+ * thread, each only if those before it found no
+ * error: the semantic analysis, the compaction of
+ * the data memory if compact, and, if codefile is
+ * not NULL, code generation to tiny->code, or to the
+ * file codefile if tiny->code is NULL. Returns
+ * false, saying so on the listing, if that file
+ * cannot be opened
+ */
+bool compileTree(AstIndex tree, bool compact, const char* codefile);
+
+/* Function runCommandLine compiles the files of cl
+ * by proc, or compileFile if proc is NULL, the
+ * listing going to out and the messages to
+ * messages. A batch is compiled on cl->jobs threads,
+ * its listings written in the order of the files,
+ * and its throughput, and the hits and misses of
+ * the cache, written to messages; with cl->verbose
+ * the cache is reported for one file as well.
+ * Returns the exit status of tiny
+ */
+int runCommandLine(const CommandLine* cl, FILE* out, FILE* messages,
+                   FileProc proc, void* arg);
+
+#endif
@@ -0,0 +1,48 @@
+/****************************************************/
+/* File: genfront.h                                 */
+/* The generated frontend of the TINY compiler:     */
+/* the scanner Flex makes of LEX/TINY.L and the     */
+/* parser Bison makes of YACC/TINY.Y, both under    */
+/* extra/tiny-machine. It accepts the language of   */
+/* scan.c and parse.c and builds the same trees     */
+/****************************************************/
+
+#ifndef _GENFRONT_H_
+#define _GENFRONT_H_
+
+#include "ast.h"
+#include "globals.h"
+#include "parse.h"
+#include "scan.h"
+
+/* Procedure genScanBegin positions the generated
+ * scanner at the start of size bytes of data. Token
+ * offsets are counted from data, so the lexemes of
+ * tokenLexeme are right when data is the buffer of
+ * the hand-written scanner as well
+ */
+void genScanBegin(const char* data, size_t size);
+
+/* Procedure genScanToken is the TokenSource of the
+ * generated scanner: it scans the next token into
+ * tok as nextToken does, interning identifiers. If
+ * memory runs out it reports it and hands out
+ * ENDFILE
+ */
+void genScanToken(Token* tok);
+
+/* Procedure genScanEnd frees what the generated
+ * scanner holds
+ */
+void genScanEnd(void);
+
+/* Function genParse parses the tokens handed out by
+ * from with the generated parser and returns the
+ * statement sequence of the program, as parse does.
+ * Trees and listings match those of parse on valid
+ * programs; on the first syntax error the parse
+ * stops and AST_NULL is returned
+ */
+AstIndex genParse(TokenSource from);
+
+#endif
@@ -1,6 +1,6 @@
 /****************************************************/
 /* File: globals.h                                  */
-/* Global types and vars for TINY compiler          */
+/* Global types for TINY compiler                   */
 /* must come before other include files             */
 /* Compiler Construction: Principles and Practice   */
 /* Kenneth C. Louden                                */
@@ -50,12 +50,8 @@ typedef enum
   DDOT,
 } TokenType;
 
-extern char* filePath; /* file path name */
-extern FILE* source;   /* source code text file */
-extern FILE* listing;  /* listing output text file */
-extern FILE* code;     /* code text file for TM simulator */
-
-extern int lineno; /* source line number for listing */
+/* the files, flags and line number of a compilation
+   are in its context, see compiler.h */
 
 /**************************************************/
 /***********   Syntax tree for parsing ************/
@@ -91,44 +87,9 @@ typedef struct treeNode {
     union {
         TokenType op;
         int val;
-        char* name;
+        int name; /* interned symbol id, see intern.h */
     } attr;
     ExpType type; /* for type checking of exps */
 } TreeNode;
 
-/**************************************************/
-/***********   Flags for tracing       ************/
-/**************************************************/
-
-/* EchoSource = true causes the source program to
- * be echoed to the listing file with line numbers
- * during parsing
- */
-extern bool EchoSource;
-
-/* TraceScan = true causes token information to be
- * printed to the listing file as each token is
- * recognized by the scanner
- */
-extern bool TraceScan;
-
-/* TraceParse = true causes the syntax tree to be
- * printed to the listing file in linearized form
- * (using indents for children)
- */
-extern bool TraceParse;
-
-/* TraceAnalyze = true causes symbol table inserts
- * and lookups to be reported to the listing file
- */
-extern bool TraceAnalyze;
-
-/* TraceCode = true causes comments to be written
- * to the TM code file as code is generated
- */
-extern bool TraceCode;
-
-/* Error = true prevents further passes if an error occurs */
-extern bool Error;
-
 #endif
\ No newline at end of file
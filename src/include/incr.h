@@ -0,0 +1,79 @@
+/****************************************************/
+/* File: incr.h                                     */
+/* Incremental front end for the TINY compiler:     */
+/* keeps the tokens, syntax trees and errors of the */
+/* document of a context between edits and redoes   */
+/* only the top level statements an edit reaches    */
+/****************************************************/
+
+#ifndef _INCR_H_
+#define _INCR_H_
+
+#include "globals.h"
+
+/* A Diagnostic is one error of the document */
+typedef struct {
+    int line;            /* source line, from 1 */
+    const char* message; /* what is wrong */
+} Diagnostic;
+
+/* A DocPosition is a run of bytes on one line */
+typedef struct {
+    int line;      /* source line, from 1 */
+    size_t column; /* bytes from the start of the line */
+    size_t length; /* bytes in the run */
+} DocPosition;
+
+/* Function docOpen makes the size bytes at text the
+ * document, in place of any other, and analyzes it
+ * in full. Returns false if memory runs out
+ */
+bool docOpen(const char* text, size_t size);
+
+/* Function docEdit replaces bytes start up to end of
+ * the document with the size bytes at text and
+ * brings the analysis up to date. Offsets past the
+ * end are taken as the end. Returns false if memory
+ * runs out, which closes the document
+ */
+bool docEdit(size_t start, size_t end, const char* text, size_t size);
+
+/* Function docOffset returns the byte offset of
+ * column column of line line, clamped to the end of
+ * the line and of the document
+ */
+size_t docOffset(int line, size_t column);
+
+/* Function docDiagnostics returns the errors that
+ * compiling the document would report, in order:
+ * its syntax errors, or when there are none its type
+ * errors. *count is set to their number. They stay
+ * valid until the next edit
+ */
+const Diagnostic* docDiagnostics(size_t* count);
+
+/* Function docReferences returns the position of
+ * every occurrence of the identifier at byte offset
+ * offset, in document order. *count is set to their
+ * number, 0 when there is no identifier there. They
+ * stay valid until the next call
+ */
+const DocPosition* docReferences(size_t offset, size_t* count);
+
+/* Function docText returns a copy of the document,
+ * for the caller to free, and its size in *size.
+ * Returns NULL if memory runs out
+ */
+char* docText(size_t* size);
+
+/* Procedure docUtf16 counts the columns of docOffset
+ * and docReferences in UTF-16 code units if on, as
+ * the Language Server Protocol does unless told
+ * otherwise, and in bytes if not, as at first
+ */
+void docUtf16(bool on);
+
+/* Procedure docClose releases the document */
+void docClose(void);
+
+#endif
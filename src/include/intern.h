@@ -0,0 +1,53 @@
+/****************************************************/
+/* File: intern.h                                   */
+/* Identifier intern pool for the TINY compiler     */
+/* Every distinct identifier gets a dense integer   */
+/* symbol id the first time it is scanned, so later */
+/* phases compare ids instead of strings            */
+/****************************************************/
+
+#ifndef _INTERN_H_
+#define _INTERN_H_
+
+#include <stddef.h>
+
+/* Function internName returns the symbol id of the
+ * len characters at name, adding them to the pool
+ * the first time they are seen. Ids are dense and
+ * numbered from 0 in order of first appearance.
+ * Returns -1 if memory runs out
+ */
+int internName(const char* name, size_t len);
+
+/* Function internHash returns the hash internName
+ * uses for the len characters at name. It does not
+ * touch the pool, so any thread may call it
+ */
+unsigned internHash(const char* name, size_t len);
+
+/* Function internHashedName is internName for a
+ * name whose internHash is already known
+ */
+int internHashedName(const char* name, size_t len, unsigned hash);
+
+/* Function symbolName returns the NUL terminated
+ * name of symbol sym
+ */
+const char* symbolName(int sym);
+
+/* Function symbolHash returns the hash of the name
+ * of symbol sym, computed once when it was interned
+ */
+unsigned symbolHash(int sym);
+
+/* Function symbolCount returns the number of
+ * symbols interned so far
+ */
+int symbolCount(void);
+
+/* Procedure freeInternPool releases every name and
+ * invalidates all symbol ids
+ */
+void freeInternPool(void);
+
+#endif
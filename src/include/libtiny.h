@@ -0,0 +1,75 @@
+/****************************************************/
+/* File: libtiny.h                                  */
+/* The interface of libtiny, the TINY compiler as a */
+/* library: a program in memory is compiled to TM   */
+/* code in memory, without touching a file, and     */
+/* any number of threads may compile at once        */
+/****************************************************/
+
+#ifndef _LIBTINY_H_
+#define _LIBTINY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* TINY_API marks what the shared libtiny exports */
+#if defined(__GNUC__)
+#define TINY_API __attribute__((visibility("default")))
+#else
+#define TINY_API
+#endif
+
+/* TinyOptions are the options of a compilation. A
+ * zeroed TinyOptions compiles on one thread with
+ * no traces
+ */
+typedef struct {
+    /* name of the program, for the diagnostics and
+       the comments of the code; NULL for none */
+    const char* name;
+    bool echoSource;   /* echo the source to the diagnostics */
+    bool traceScan;    /* list each token scanned */
+    bool traceParse;   /* list the syntax tree */
+    bool traceAnalyze; /* list the symbol table */
+    bool traceCode;    /* comment the TM code */
+    int lexThreads;     /* threads the scanner may use; 0 is 1 */
+    int analyzeThreads; /* threads analysis may use; 0 is 1 */
+    bool pipelineParse; /* scan on a thread of its own */
+    bool stackParse;    /* parse with explicit stacks */
+    bool compactSlots;  /* share the locations of variables */
+} TinyOptions;
+
+/* A TinyBuffer is memory of the caller that output
+ * is written to. Like snprintf, at most capacity - 1
+ * bytes are written, followed by a '\0', and length
+ * is set to the length of the whole output, so that
+ * length >= capacity tells it was cut short
+ */
+typedef struct {
+    char* data;
+    size_t capacity;
+    size_t length;
+} TinyBuffer;
+
+/* TinyStatus is the outcome of a compilation */
+typedef enum {
+    TINY_OK,        /* the code is complete */
+    TINY_ERROR,     /* the program has errors: see the diagnostics */
+    TINY_TRUNCATED, /* a buffer was too small for its output */
+    TINY_NO_MEMORY  /* memory ran out */
+} TinyStatus;
+
+/* Function tiny_compile compiles the len bytes of
+ * TINY source at src with options, NULL for the
+ * defaults, writing the TM code to code and the
+ * listing, with any errors, to diagnostics. Either
+ * buffer may be NULL if its output is not wanted.
+ * No code is written for a program with errors.
+ * Each call has a compilation context of its own,
+ * so it may be made from many threads at once
+ */
+TINY_API TinyStatus tiny_compile(const char* src, size_t len,
+                                 const TinyOptions* options, TinyBuffer* code,
+                                 TinyBuffer* diagnostics);
+
+#endif
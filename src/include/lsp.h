@@ -0,0 +1,25 @@
+/****************************************************/
+/* File: lsp.h                                      */
+/* Language server front end for the TINY compiler  */
+/****************************************************/
+
+#ifndef _LSP_H_
+#define _LSP_H_
+
+#include "globals.h"
+
+/* Function lspServe runs a language server for TINY
+ * over in and out: JSON-RPC messages with
+ * Content-Length headers, as the Language Server
+ * Protocol lays down, until the client sends exit.
+ * Edits are applied through the incremental front
+ * end and answered with fresh diagnostics. Each
+ * open document is kept in a context of its own,
+ * made from the one bound to the thread, so that
+ * servers on threads with contexts of their own
+ * run apart. Returns true if the
+ * client shut the server down first
+ */
+bool lspServe(FILE* in, FILE* out);
+
+#endif
@@ -8,13 +8,63 @@
 #ifndef _PARSE_H_
 #define _PARSE_H_
 
+#include "ast.h"
 #include "globals.h"
 #include "scan.h"
 #include "util.h"
 
 /* Function parse returns the newly
- * constructed syntax tree
+ * constructed syntax tree: the statement
+ * sequence of the program
  */
-TreeNode* parse(void);
+AstIndex parse(void);
+
+/* a TokenSource hands out the tokens of a parse one
+   at a time into tok, and ENDFILE once they run out */
+typedef void (*TokenSource)(Token* tok);
+
+/* a StatementSource hands the parser the tree of a
+   statement parsed before that starts at the current
+   token, having passed over the rest of its tokens,
+   or AST_NULL to have the statement parsed */
+typedef AstIndex (*StatementSource)(void);
+
+/* Procedure parseBegin starts a parse of the tokens
+ * handed out by from, to be taken one top level
+ * statement at a time by parseNext. Each statement,
+ * at any depth, is first asked of kept, which may
+ * be NULL. With stackParse set the statements are
+ * parsed with the explicit stacks, as parse does
+ */
+void parseBegin(TokenSource from, StatementSource kept);
+
+/* Function parseNext parses the next top level
+ * statement of the parse begun by parseBegin into
+ * *stmt, as the statement sequence of a program is
+ * parsed: the first statement is always parsed,
+ * later ones only up to a token that closes a
+ * sequence. Such a stray token is reported as parse
+ * reports it, then skipped so that the statements
+ * after it are parsed too; *stray tells when that
+ * happened. Returns false, parsing nothing, once
+ * only ENDFILE is left
+ */
+bool parseNext(bool first, AstIndex* stmt, bool* stray);
+
+/* Function parseStatement parses the next top level
+ * statement of the parse begun by parseBegin into
+ * *stmt, exactly as parse does: the first statement
+ * is always parsed, later ones up to a token that
+ * closes a sequence. That token ends the program and
+ * is reported as parse reports it unless it is
+ * ENDFILE. Returns false, parsing nothing, once the
+ * program has ended
+ */
+bool parseStatement(bool first, AstIndex* stmt);
+
+/* Procedure parseEnd ends the parse begun by
+ * parseBegin
+ */
+void parseEnd(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+/****************************************************/
+/* File: pass.h                                     */
+/* Pass manager for the TINY compiler: runs passes  */
+/* over the syntax tree, with the passes that can   */
+/* share a walk of it fused into one walk           */
+/****************************************************/
+
+#ifndef _PASS_H_
+#define _PASS_H_
+
+#include "ast.h"
+#include "globals.h"
+#include "walk.h"
+
+/* MAXPASSES = passes that may be added */
+#define MAXPASSES 32
+
+/* A Pass is work done at each node of the syntax
+ * tree. Any of its hooks may be NULL. A pass that
+ * is not alone shares its walk with others: its
+ * enter hook must always return true and it must
+ * not use the saved words of the frames
+ */
+typedef struct {
+    const char* name;
+    void (*start)(void);  /* before the walk */
+    WalkEnter enter;      /* as walkTree calls them */
+    WalkProc between;
+    WalkProc leave;
+    void (*finish)(void); /* after the walk */
+    unsigned needs;       /* bit i: needs all of pass i done */
+    bool alone;           /* needs a walk of its own */
+} Pass;
+
+/* Function passAdd adds pass, to run after those
+ * added before it. Returns its number, for the needs
+ * of later passes, or -1 if there are MAXPASSES
+ * already or it needs a pass not added yet
+ */
+int passAdd(const Pass* pass);
+
+/* Function passRun runs the passes added over each
+ * statement of tree, in as few walks as their needs
+ * allow: consecutive passes share a walk unless one
+ * of them is alone or needs another pass of the
+ * walk. At each node the passes of a walk are called
+ * in the order they were added, and so are their
+ * start hooks before the walk and their finish hooks
+ * after it. No walk starts once an error has been
+ * reported. Returns the number of walks made
+ */
+int passRun(AstIndex tree);
+
+/* Procedure passClear removes every pass added */
+void passClear(void);
+
+#endif
@@ -0,0 +1,35 @@
+/****************************************************/
+/* File: ring.h                                     */
+/* Single-producer/single-consumer token ring for   */
+/* the pipelined TINY scanner and parser            */
+/****************************************************/
+
+#ifndef _RING_H_
+#define _RING_H_
+
+#include "scan.h"
+
+typedef struct TokenRing TokenRing;
+
+/* Function newTokenRing allocates a ring holding up
+ * to capacity tokens, rounded up to a power of two.
+ * Returns NULL if memory runs out
+ */
+TokenRing* newTokenRing(size_t capacity);
+
+/* Procedure ringPush appends tok to the ring. Only
+ * one thread may push; it waits while the ring is
+ * full
+ */
+void ringPush(TokenRing* ring, const Token* tok);
+
+/* Procedure ringPop removes the oldest token of the
+ * ring into tok. Only one thread may pop; it waits
+ * while the ring is empty
+ */
+void ringPop(TokenRing* ring, Token* tok);
+
+/* Procedure freeTokenRing frees the ring */
+void freeTokenRing(TokenRing* ring);
+
+#endif
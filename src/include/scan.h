@@ -8,19 +8,100 @@
 #ifndef _SCAN_H_
 #define _SCAN_H_
 
+#include <stdint.h>
+
 #include "globals.h"
+#include "intern.h"
+#include "source.h"
 #include "util.h"
 
 /* MAXTOKENLEN is the maximum size of a token */
 #define MAXTOKENLEN 40
 #define ALLOCSIZE 1024
 
-/* tokenString array stores the lexeme of each token */
-extern char tokenString[MAXTOKENLEN + 1]; // Problem with -Wstringop-overflow
-// extern char *allocp = tokenString;
+/* Function initScanner loads the whole of file into
+ * memory, read rather than mapped if readSources is
+ * set, and positions the scanner at its first
+ * character. Returns false if it cannot be read
+ */
+bool initScanner(FILE* file);
+
+/* Procedure initScannerText positions the scanner at
+ * the start of size bytes of data. data[size] must
+ * be '\0', and data must outlive the scan
+ */
+void initScannerText(const char* data, size_t size);
+
+/* Procedure releaseScanner frees the source buffer */
+void releaseScanner(void);
+
+/* Function scannerText returns the source buffer
+ * the scanner was positioned on, its size in *size
+ */
+const char* scannerText(size_t* size);
 
 /* function getToken returns the
  * next token in source file
  */
 TokenType getToken(void);
+
+/* A TokenStream holds the tokens of a source file
+ * as parallel arrays indexed by token number.
+ * Lexemes are not copied: token i spans length[i]
+ * bytes of text starting at offset[i]
+ */
+typedef struct {
+    const char* text;      /* the source buffer the offsets refer to */
+    unsigned char* kind;   /* TokenType of each token */
+    uint32_t* offset;      /* byte offset of each lexeme in text */
+    uint32_t* length;      /* byte length of each lexeme */
+    int* line;             /* source line of each token */
+    int* value;            /* NUM value or ID symbol id, else 0 */
+    size_t count;          /* number of tokens stored */
+    size_t capacity;       /* number of tokens the arrays can hold */
+} TokenStream;
+
+/* A Token is one token of a TokenStream on its own,
+ * as handed from the scanner to the parser one at
+ * a time
+ */
+typedef struct {
+    TokenType kind;  /* the kind of token */
+    int line;        /* source line of the token */
+    uint32_t offset; /* byte offset of the lexeme in the source */
+    uint32_t length; /* byte length of the lexeme */
+    int value;       /* NUM value or ID symbol id, else 0 */
+} Token;
+
+/* Function tokenize scans the rest of the source
+ * buffer into ts, up to and including ENDFILE.
+ * Identifiers are interned as they are scanned.
+ * Returns false if memory runs out
+ */
+bool tokenize(TokenStream* ts);
+
+/* Function tokenizeParallel does the work of tokenize
+ * on a pool of threads workers, and produces the same
+ * token stream. Small inputs, a single thread, or
+ * source echo fall back to tokenize. Returns false if
+ * memory runs out
+ */
+bool tokenizeParallel(TokenStream* ts, int threads);
+
+/* Procedure freeTokenStream releases the arrays of ts */
+void freeTokenStream(TokenStream* ts);
+
+/* Function nextToken scans the next token of the
+ * source buffer into tok, interning identifiers.
+ * Unlike getToken it leaves lineno and tokenString
+ * alone, so it may run on a thread of its own while
+ * nothing else uses the scanner. Returns false if
+ * memory runs out
+ */
+bool nextToken(Token* tok);
+
+/* Function tokenLexeme copies the lexeme of tok into
+ * tokenString, for listings and diagnostics
+ */
+const char* tokenLexeme(const Token* tok);
 #endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+/****************************************************/
+/* File: scandfa.h                                  */
+/* Character classes and transition encoding of the */
+/* table-driven scanner DFA for the TINY compiler   */
+/* The tables themselves are generated at build     */
+/* time by tools/mkscantab.c                        */
+/****************************************************/
+
+#ifndef _SCANDFA_H_
+#define _SCANDFA_H_
+
+#include "globals.h"
+
+/* states in scanner DFA */
+typedef enum { START, INASSIGN, INCOMMENT, INNUM, INID, DONE } StateType;
+
+/* NSTATES = the number of states with outgoing transitions */
+#define NSTATES DONE
+
+/* character classes; every byte of the input
+   belongs to exactly one of them */
+typedef enum {
+    CC_OTHER,      /* any character not listed below */
+    CC_END,        /* '\0', the sentinel after the last byte */
+    CC_NEWLINE,    /* '\n' */
+    CC_SPACE,      /* other characters accepted by isspace */
+    CC_DIGIT,      /* 0-9 */
+    CC_LETTER,     /* A-Z a-z */
+    CC_UNDERSCORE, /* _ */
+    CC_COLON,      /* : */
+    CC_EQ,         /* = */
+    CC_LT,         /* < */
+    CC_PLUS,       /* + */
+    CC_MINUS,      /* - */
+    CC_TIMES,      /* * */
+    CC_OVER,       /* / */
+    CC_LPAREN,     /* ( */
+    CC_RPAREN,     /* ) */
+    CC_SEMI,       /* ; */
+    CC_LBRACE,     /* { */
+    CC_RBRACE,     /* } */
+    NCLASSES
+} CharClass;
+
+/* actions attached to a transition */
+typedef enum {
+    ACT_SHIFT,   /* consume the character as part of the lexeme */
+    ACT_SKIP,    /* consume the character and restart the lexeme */
+    ACT_NEWLINE, /* as ACT_SKIP, and count a new line */
+    ACT_ACCEPT,  /* consume the character and return the token */
+    ACT_BACKUP,  /* return the token, leaving the character unread */
+    ACT_END,     /* the sentinel: end of input returns the token */
+    ACT_SPACE,   /* skip a run of white space with skipSpace */
+    ACT_COMMENT, /* skip a '{ ... }' comment with skipComment */
+    ACT_IDENT    /* consume a run of identifier characters */
+} ScanAction;
+
+/* a transition table entry packs the next state,
+   the action and the token it recognizes */
+#define SCAN_ENTRY(next, action, token)                                    \
+    ((unsigned short)((next) | ((action) << 3) | ((token) << 8)))
+#define SCAN_NEXT(e) ((StateType)((e)&7))
+#define SCAN_ACTION(e) ((ScanAction)(((e) >> 3) & 15))
+#define SCAN_TOKEN(e) ((TokenType)((e) >> 8))
+
+/* KEYWORD_SLOTS = size of the reserved word table */
+#define KEYWORD_SLOTS 16
+
+/* reserved words are 2 to 8 characters long */
+#define KEYWORD_MINLEN 2
+#define KEYWORD_MAXLEN 8
+
+/* KEYWORD_HASH is a perfect hash of the reserved
+   words; tools/mkscantab.c fails the build if two
+   of them share a slot. It reads w[1], so len must
+   be at least KEYWORD_MINLEN */
+#define KEYWORD_HASH(w, len)                                               \
+    (((len) + (unsigned char)(w)[0] + 5u * (unsigned char)(w)[1] +         \
+      (unsigned char)(w)[(len)-1]) &                                       \
+     (KEYWORD_SLOTS - 1))
+
+#endif
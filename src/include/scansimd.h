@@ -0,0 +1,35 @@
+/****************************************************/
+/* File: scansimd.h                                 */
+/* Block-at-a-time scanning kernels for the TINY    */
+/* scanner: AVX2 or SSE2 when the compiler targets  */
+/* them, portable SWAR otherwise                    */
+/****************************************************/
+
+#ifndef _SCANSIMD_H_
+#define _SCANSIMD_H_
+
+#include <stddef.h>
+
+/* Function skipSpace returns the first position in
+ * [p, end) that is not a white space character, or
+ * end. The newlines skipped are added to *lines
+ */
+const char* skipSpace(const char* p, const char* end, int* lines);
+
+/* Function skipComment returns the position of the
+ * first '}' in [p, end), or end. The newlines
+ * skipped are added to *lines
+ */
+const char* skipComment(const char* p, const char* end, int* lines);
+
+/* Function skipIdent returns the first position in
+ * [p, end) that is not in [A-Za-z0-9_], or end
+ */
+const char* skipIdent(const char* p, const char* end);
+
+/* Function scanKernelName names the kernels
+ * selected at compile time
+ */
+const char* scanKernelName(void);
+
+#endif
@@ -0,0 +1,44 @@
+/****************************************************/
+/* File: server.h                                   */
+/* Compile server for the TINY compiler: a resident */
+/* tiny that compiles for tiny --client over a Unix */
+/* domain socket, keeping what it compiled and      */
+/* compiling sources again as soon as they change   */
+/****************************************************/
+
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+#include "globals.h"
+
+/* the socket is named by TINY_SOCKET, or is
+   SOCKETNAME in $XDG_RUNTIME_DIR, or else in
+   SOCKETDIR/tiny-<uid>, a directory the server
+   makes for the user alone */
+#define SOCKETDIR "/tmp"
+#define SOCKETNAME "tiny.sock"
+
+/* Function serverRun serves the command lines of
+ * tiny --client until it is sent SIGINT or SIGTERM.
+ * Each client of the same user is served on a
+ * thread of its own, their command lines running at
+ * once, with names taken from their directories. The listing and code of each
+ * source are kept, and replayed while the source,
+ * the options and the outputs are unchanged; the
+ * directories of the sources are watched, and a
+ * source is compiled again when it is written.
+ * Returns false if it cannot listen on the socket
+ */
+bool serverRun(void);
+
+/* Function clientRun has the server run the command
+ * line argv of argc arguments, argv[0] naming the
+ * program, from the current directory, and writes
+ * its listing to stdout and its messages to stderr.
+ * Returns the exit status of the command line, or
+ * -1 if there is no server of the user to run it,
+ * or it turned the command line away
+ */
+int clientRun(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,35 @@
+/****************************************************/
+/* File: sha256.h                                   */
+/* SHA-256 for the TINY compiler, naming the        */
+/* entries of the compilation cache by content      */
+/****************************************************/
+
+#ifndef _SHA256_H_
+#define _SHA256_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* SHA256_SIZE = bytes in a digest */
+#define SHA256_SIZE 32
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length; /* bytes hashed so far */
+    unsigned char block[64];
+} Sha256;
+
+/* Procedure sha256Init starts the digest h */
+void sha256Init(Sha256* h);
+
+/* Procedure sha256Update adds the size bytes at
+ * data to the digest h
+ */
+void sha256Update(Sha256* h, const void* data, size_t size);
+
+/* Procedure sha256Final writes the digest h to
+ * digest, after which h must be started again
+ */
+void sha256Final(Sha256* h, unsigned char digest[SHA256_SIZE]);
+
+#endif
@@ -0,0 +1,34 @@
+/****************************************************/
+/* File: slots.h                                    */
+/* Data memory compaction for the TINY compiler:    */
+/* variables whose live ranges never meet share a   */
+/* memory location                                  */
+/****************************************************/
+
+#ifndef _SLOTS_H_
+#define _SLOTS_H_
+
+#include "ast.h"
+#include "globals.h"
+#include "pass.h"
+#include "symtab.h"
+
+/* SLOTMAXVARS = most variables a program may have
+   for its slots to be compacted */
+#define SLOTMAXVARS 8192
+
+/* slotPass finds the live ranges of the variables
+ * of the program by a dataflow analysis over the
+ * flow graph of its statements, and as it finishes
+ * moves each variable to the lowest location no
+ * variable live where it is stored holds, listing
+ * how many locations that saved. It runs alone,
+ * once the symbol table is built and checked: a
+ * copy added with typeCheckPass needs that pass.
+ * The locations are those codeGen then uses. A
+ * program with more than SLOTMAXVARS variables is
+ * left as it is
+ */
+extern const Pass slotPass;
+
+#endif
@@ -0,0 +1,43 @@
+/****************************************************/
+/* File: source.h                                   */
+/* Whole-file source buffer for the TINY compiler   */
+/****************************************************/
+
+#ifndef _SOURCE_H_
+#define _SOURCE_H_
+
+#include "globals.h"
+
+/* A SourceBuffer holds the complete text of a
+ * source file in one contiguous block of memory.
+ * The byte at data[size] is always '\0', so the
+ * scanner may look one character past the last
+ * byte of the file without a bounds check
+ */
+typedef struct {
+    const char* data; /* first byte of the source text */
+    size_t size;      /* length of the text, without the sentinel */
+    bool mapped;      /* true if data is an mmap'ed view of the file */
+} SourceBuffer;
+
+/* Function sourceLoad fills buf with the contents
+ * of file. Regular files are memory mapped; pipes,
+ * terminals and files whose size is an exact
+ * multiple of the page size are read into a heap
+ * buffer instead. Returns false on failure
+ */
+bool sourceLoad(SourceBuffer* buf, FILE* file);
+
+/* Function sourceRead fills buf with the contents
+ * of file read into a heap buffer, never mapped, so
+ * that a file changed while it is used cannot reach
+ * the buffer. Returns false on failure
+ */
+bool sourceRead(SourceBuffer* buf, FILE* file);
+
+/* Procedure sourceRelease unmaps or frees the
+ * memory held by buf
+ */
+void sourceRelease(SourceBuffer* buf);
+
+#endif
@@ -0,0 +1,29 @@
+/****************************************************/
+/* File: stream.h                                   */
+/* One pass compilation for the TINY compiler:      */
+/* each top level statement is parsed, analyzed and */
+/* turned into TM code before the next is read      */
+/****************************************************/
+
+#ifndef _STREAM_H_
+#define _STREAM_H_
+
+#include "globals.h"
+
+/* Function streamCompile compiles the source the
+ * scanner was initialized with into the code file
+ * codefile, a top level statement at a time, so
+ * that only one statement's tree is ever held. The
+ * listing and the code file come out as they do
+ * from parse, buildSymtab, typeCheck and codeGen
+ * run one after the other: listings held back until
+ * the program has been parsed wait in temporary
+ * files, and the code file is written under another
+ * name and only renamed to codefile if there are no
+ * errors. A relative codefile is taken from the
+ * directory of the context. Returns false if
+ * codefile cannot be written
+ */
+bool streamCompile(const char* codefile);
+
+#endif
@@ -13,17 +13,42 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "intern.h"
+
+/* SYMSHARDS = shards the symbol table is split into
+   by the hash of each name */
+#define SYMSHARDS 16
+
 /* Procedure st_insert inserts line numbers and
  * memory locations into the symbol table
+ * name = interned symbol id of the variable
  * loc = memory location is inserted only the
  * first time, otherwise ignored
+ * Inserts of names of different shards may run
+ * concurrently
  */
-void st_insert(char* name, int lineno, int loc);
+void st_insert(int name, int lineno, int loc);
 
 /* Function st_lookup returns the memory
  * location of a variable or -1 if not found
  */
-int st_lookup(char* name);
+int st_lookup(int name);
+
+/* Procedure st_relocate moves the variable name
+ * to memory location loc. The listing keeps the
+ * order of the locations first handed out
+ */
+void st_relocate(int name, int loc);
+
+/* Function st_shard returns the shard of the symbol
+ * table name goes to
+ */
+int st_shard(int name);
+
+/* Procedure st_free empties the symbol table and
+ * releases its memory
+ */
+void st_free(void);
 
 /* Procedure printSymTab prints a formatted
  * listing of the symbol table contents
@@ -0,0 +1,39 @@
+/****************************************************/
+/* File: threadpool.h                               */
+/* Fixed-size worker thread pool for the TINY       */
+/* compiler                                         */
+/****************************************************/
+
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+#include <stdbool.h>
+
+/* a task is a function applied to one argument */
+typedef void (*TaskProc)(void* arg);
+
+typedef struct ThreadPool ThreadPool;
+
+/* Function newThreadPool starts a pool of threads
+ * workers, running their tasks in the context of
+ * the calling thread. Returns NULL if they cannot
+ * be started
+ */
+ThreadPool* newThreadPool(int threads);
+
+/* Function poolSubmit queues proc(arg) to run on one
+ * of the workers. Returns false if memory runs out
+ */
+bool poolSubmit(ThreadPool* pool, TaskProc proc, void* arg);
+
+/* Procedure poolWait blocks until every task
+ * submitted so far has finished
+ */
+void poolWait(ThreadPool* pool);
+
+/* Procedure freeThreadPool waits for the queued
+ * tasks, stops the workers and frees the pool
+ */
+void freeThreadPool(ThreadPool* pool);
+
+#endif
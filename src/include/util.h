@@ -9,6 +9,7 @@
 #define _UTIL_H_
 
 #include "globals.h"
+#include "intern.h"
 
 /* Procedure printToken prints a token
  * and its lexeme to the listing file
@@ -35,6 +36,27 @@ char* copyString(char*);
  */
 void printTree(TreeNode*);
 
-void freeTree(TreeNode* tree);
+/* Procedure freeSyntaxTrees releases every node made
+ * by newStmtNode and newExpNode and every string made
+ * by copyString, all at once
+ */
+void freeSyntaxTrees(void);
+
+/* a DiagnosticProc is told of each error the parser
+   and the type checker report, as the line it is on
+   and a message ending in detail */
+typedef void (*DiagnosticProc)(int line, const char* message,
+                               const char* detail);
+
+/* Procedure setDiagnosticProc makes proc hear of
+ * every error reported from now on; NULL stops it
+ */
+void setDiagnosticProc(DiagnosticProc proc);
+
+/* Procedure diagnostic passes an error on to the
+ * DiagnosticProc, if one is set. The listing is
+ * written as before either way
+ */
+void diagnostic(int line, const char* message, const char* detail);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,129 @@
+/****************************************************/
+/* File: walk.h                                     */
+/* Syntax tree walker for the TINY compiler         */
+/* Walks a TreeNode tree and its siblings on an     */
+/* explicit stack, so that neither long statement   */
+/* sequences nor deep nesting use up the C stack    */
+/****************************************************/
+
+#ifndef _WALK_H_
+#define _WALK_H_
+
+#include "globals.h"
+
+/* WALK_FRAMES = frames a walk holds before it moves
+   its stack to the heap */
+#define WALK_FRAMES 64
+
+/* WALK_INLINE makes walkTree part of each caller,
+   even where the compiler would rather not */
+#if defined(__GNUC__)
+#define WALK_INLINE static inline __attribute__((always_inline))
+#else
+#define WALK_INLINE static inline
+#endif
+
+/* A WalkFrame is a node whose children are being
+ * walked: one frame per level of nesting, taken
+ * over by each sibling in turn
+ */
+typedef struct {
+    TreeNode* node;
+    int child;    /* the child to walk next */
+    int saved[2]; /* for a visitor between children */
+} WalkFrame;
+
+/* A TreeWalk is the stack of a walk */
+typedef struct {
+    WalkFrame* frames;
+    size_t count;
+    size_t capacity;
+    WalkFrame first[WALK_FRAMES];
+} TreeWalk;
+
+/* A WalkEnter is called on the frame of a node as
+ * the walk reaches it, with the depth of the node,
+ * 1 for the tree walked and its siblings. Returning
+ * false passes over the children of the node
+ */
+typedef bool (*WalkEnter)(WalkFrame* frame, size_t depth);
+
+/* A WalkProc is called on the frame of a node after
+ * each of its children, frame->child - 1 being the
+ * one just walked, and once they are all walked
+ */
+typedef void (*WalkProc)(WalkFrame* frame);
+
+/* Function walkPush puts a frame for node on top of
+ * walk, moving the stack to the heap when it is
+ * full. Returns false if memory runs out
+ */
+bool walkPush(TreeWalk* walk, TreeNode* node);
+
+/* Procedure walkRelease frees what walk took from
+ * the heap
+ */
+void walkRelease(TreeWalk* walk);
+
+/* Procedure walkTree walks tree and its siblings,
+ * and every node below them, in order. A node is
+ * entered, then its children are walked one after
+ * the other, each with its siblings, then it is
+ * left and its sibling is entered. Any hook may be
+ * NULL. It is inline so that a caller passing its
+ * own static hooks gets a walker with the hooks
+ * called directly and the NULL ones left out
+ */
+WALK_INLINE void walkTree(TreeNode* tree, WalkEnter enter, WalkProc between,
+                           WalkProc leave)
+{
+    TreeWalk walk;
+    walk.frames = walk.first;
+    walk.count = 0;
+    walk.capacity = WALK_FRAMES;
+    if ((tree == NULL) || !walkPush(&walk, tree)) {
+        return;
+    }
+    if ((enter != NULL) && !enter(&walk.frames[0], 1)) {
+        walk.frames[0].child = MAXCHILDREN;
+    }
+    while (walk.count > 0) {
+        WalkFrame* f = &walk.frames[walk.count - 1];
+        if (f->child < MAXCHILDREN) {
+            TreeNode* c = f->node->child[f->child++];
+            if (c == NULL) {
+                if (between != NULL) {
+                    between(f);
+                }
+            }
+            else if (walkPush(&walk, c)) {
+                f = &walk.frames[walk.count - 1];
+                if ((enter != NULL) && !enter(f, walk.count)) {
+                    f->child = MAXCHILDREN;
+                }
+            }
+            else {
+                break;
+            }
+            continue;
+        }
+        if (leave != NULL) {
+            leave(f);
+        }
+        if (f->node->sibling != NULL) {
+            f->node = f->node->sibling;
+            f->child = 0;
+            if ((enter != NULL) && !enter(f, walk.count)) {
+                f->child = MAXCHILDREN;
+            }
+            continue;
+        }
+        walk.count--;
+        if ((walk.count > 0) && (between != NULL)) {
+            between(&walk.frames[walk.count - 1]);
+        }
+    }
+    walkRelease(&walk);
+}
+
+#endif
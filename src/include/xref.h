@@ -0,0 +1,99 @@
+/****************************************************/
+/* File: xref.h                                     */
+/* Cross-reference index files for the TINY         */
+/* compiler: where each variable lives, is stored   */
+/* and is used, in a file tools can map and search  */
+/* without compiling the program again              */
+/****************************************************/
+
+#ifndef _XREF_H_
+#define _XREF_H_
+
+#include <stdint.h>
+
+#include "ast.h"
+#include "source.h"
+
+/* XREF_FILE_VERSION changes whenever the layout of
+   the file does */
+#define XREF_FILE_VERSION 1
+
+/* The file starts with an XrefFileHeader, followed
+ * by symbolCount XrefSymbols sorted by name, the
+ * postings of postingBytes and the string table of
+ * stringBytes NUL terminated names. Numbers are in
+ * the byte order of the writer
+ */
+typedef struct {
+    char magic[8];         /* "TINYXRF" */
+    uint32_t version;      /* XREF_FILE_VERSION */
+    uint32_t byteOrder;    /* 0x01020304 as written */
+    uint32_t symbolCount;  /* entries of the symbol table */
+    uint32_t postingBytes; /* size of the postings */
+    uint32_t stringBytes;  /* size of the string table */
+    uint32_t reserved;     /* zero */
+} XrefFileHeader;
+
+/* An XrefSymbol is a variable: its name, as an
+ * offset into the string table, its memory location
+ * and its postings, the lines it is stored on
+ * (defs) then the lines it is used on (refs), at an
+ * offset into the postings. Each list is sorted,
+ * without repeats, and held as the differences of
+ * each line from the one before it, the first from
+ * 0, in 7 bits a byte, low bits first, the high bit
+ * set on every byte but the last of a number
+ */
+typedef struct {
+    uint32_t name;
+    int32_t location;
+    uint32_t defCount;
+    uint32_t refCount;
+    uint32_t postings;
+} XrefSymbol;
+
+/* An XrefIndex is an index file mapped for queries */
+typedef struct {
+    SourceBuffer file;
+    XrefFileHeader header;
+    const XrefSymbol* symbols;
+    const unsigned char* postings;
+    const char* strings;
+} XrefIndex;
+
+/* Function xrefWrite writes the index of the
+ * variables of the analyzed tree at root to file,
+ * with the memory locations of the symbol table.
+ * Returns false if writing fails
+ */
+bool xrefWrite(FILE* file, AstIndex root);
+
+/* Function xrefOpen maps the index file file into
+ * index. Only the header and the sizes of the parts
+ * are checked, so opening takes the same time for
+ * any index; queries check what they read. Returns
+ * false if file is not an index file of this
+ * version
+ */
+bool xrefOpen(XrefIndex* index, FILE* file);
+
+/* Function xrefFind returns the symbol of index
+ * named name, by binary search, or NULL
+ */
+const XrefSymbol* xrefFind(const XrefIndex* index, const char* name);
+
+/* Function xrefName returns the name of sym */
+const char* xrefName(const XrefIndex* index, const XrefSymbol* sym);
+
+/* Function xrefLines decodes the postings of sym
+ * into defs, for defCount lines, and refs, for
+ * refCount lines. Returns false if they run past
+ * the postings of index
+ */
+bool xrefLines(const XrefIndex* index, const XrefSymbol* sym, int* defs,
+               int* refs);
+
+/* Procedure xrefClose unmaps the file of index */
+void xrefClose(XrefIndex* index);
+
+#endif
@@ -0,0 +1,1248 @@
+/****************************************************/
+/* File: incr.c                                     */
+/* Incremental front end for the TINY compiler.     */
+/* The document is a run of segments, one for each  */
+/* top level statement and for each statement an    */
+/* unclosed one takes in, and each keeps its text,  */
+/* tokens and errors with positions relative to its */
+/* own start. An edit is relexed from the segment   */
+/* it falls in, and reparsed from the top level     */
+/* statement holding it up to the first untouched   */
+/* top level segment the parse lines up with again. */
+/* Statements that parsed cleanly are taken in      */
+/* whole, trees and all; the segments after only    */
+/* move. A statement left unclosed to the end of    */
+/* the document by statements that parsed cleanly   */
+/* leaves them as they are, holding the error at    */
+/* the end on its own                               */
+/****************************************************/
+
+#include <ctype.h>
+
+#include "include/analyze.h"
+#include "include/ast.h"
+#include "include/compiler.h"
+#include "include/incr.h"
+#include "include/parse.h"
+
+/* A Message is an error held by a segment, its line
+   counted from 1 at the first line of the segment */
+typedef struct Message {
+    int line;
+    char* message;
+} Message;
+
+/* A Segment is a statement of the document and the
+ * text from its start up to the next one. A top
+ * level segment holds the errors of all of its
+ * statement, which takes in the nested segments
+ * after it. A nested segment is a statement that
+ * parsed cleanly, kept whole with the errors it has
+ * on its own for when it stands alone again. Token
+ * offsets are from the start of the text and token
+ * lines from 1 at its first line, so edits elsewhere
+ * never touch them
+ */
+typedef struct Segment {
+    char* text;          /* the bytes of the segment, '\0' ended */
+    size_t size;         /* bytes in text */
+    size_t offset;       /* where text starts in the document */
+    int line;            /* newlines in the document before text */
+    int newlines;        /* newlines in text */
+    Token* tokens;       /* the tokens of the segment */
+    size_t count;        /* number of tokens */
+    Message* errors;     /* its syntax errors, then its type errors */
+    size_t syntaxErrors; /* how many of errors are syntax errors */
+    size_t errorCount;   /* number of errors */
+    bool stray;          /* a whole program parse stops here */
+    bool nested;         /* inside a statement begun before it */
+    AstIndex tree;       /* the statement, if the tokens are just it */
+    int treeLine;        /* tree lines are treeLine + token lines */
+    size_t nodes;        /* syntax tree nodes made for it */
+} Segment;
+
+/* NONE is no segment, reuse or piece */
+#define NONE ((size_t)-1)
+
+/* A Reuse is a segment taken whole into a statement
+   being parsed, with where its first token is in
+   workTokens and its text in work */
+typedef struct Reuse {
+    size_t segment;
+    size_t token;
+    size_t text;
+} Reuse;
+
+/* A Piece is a top level statement parsed from the
+   work area, the tokens from up to to, its errors in
+   pending from mark up to markEnd and the segments
+   it took in reuses from reused up to reusedEnd */
+typedef struct Piece {
+    size_t from, to;
+    AstIndex stmt;
+    bool stray;
+    size_t nodes;
+    size_t mark, markEnd;
+    size_t reused, reusedEnd;
+} Piece;
+
+/* A Part is a segment the pieces are cut into: the
+   tokens of a piece from up to to, or a segment it
+   took in when reuse is not NONE, and where its text
+   starts in work */
+typedef struct Part {
+    const Piece* piece;
+    size_t from, to;
+    size_t reuse;
+    bool head;
+    size_t start;
+} Part;
+
+/* grow makes room for need entries of size bytes in
+   array, whose room is *capacity entries. Returns the
+   array, which may have moved, or NULL if memory
+   runs out */
+static void* grow(void* array, size_t* capacity, size_t need, size_t size)
+{
+    if ((need <= *capacity) && (array != NULL)) {
+        return array;
+    }
+    size_t cap = (*capacity == 0) ? 64 : *capacity;
+    while (cap < need) {
+        cap *= 2;
+    }
+    void* p = realloc(array, cap * size);
+    if (p != NULL) {
+        *capacity = cap;
+    }
+    return p;
+}
+
+/* countNewlines counts the '\n' in size bytes */
+static int countNewlines(const char* data, size_t size)
+{
+    int n = 0;
+    const char* end = data + size;
+    while ((data = memchr(data, '\n', (size_t)(end - data))) != NULL) {
+        n++;
+        data++;
+    }
+    return n;
+}
+
+/* offsetOf returns where segment k starts in the
+   document */
+static size_t offsetOf(size_t k)
+{
+    IncrState* is = &tiny->incr;
+    return is->segments[k]->offset +
+           ((k >= is->shiftFrom) ? is->shiftBytes : 0);
+}
+
+/* lineOf returns the newlines before segment k */
+static int lineOf(size_t k)
+{
+    IncrState* is = &tiny->incr;
+    return is->segments[k]->line + ((k >= is->shiftFrom) ? is->shiftLines : 0);
+}
+
+/* settle moves segments from up to to, all from
+   shiftFrom on, where they lie */
+static void settle(size_t from, size_t to)
+{
+    IncrState* is = &tiny->incr;
+    for (size_t k = from; k < to; k++) {
+        is->segments[k]->offset += is->shiftBytes;
+        is->segments[k]->line += is->shiftLines;
+    }
+}
+
+/* freeSegment releases s and what it holds */
+static void freeSegment(Segment* s)
+{
+    if (s == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < s->errorCount; i++) {
+        free(s->errors[i].message);
+    }
+    free(s->errors);
+    free(s->tokens);
+    free(s->text);
+    free(s);
+}
+
+/* appendText adds size bytes to the work area */
+static bool appendText(const char* data, size_t size)
+{
+    IncrState* is = &tiny->incr;
+    char* w = grow(is->work, &is->workCapacity, is->workSize + size + 1, 1);
+    if (w == NULL) {
+        return false;
+    }
+    is->work = w;
+    memcpy(is->work + is->workSize, data, size);
+    is->workSize += size;
+    is->work[is->workSize] = '\0';
+    return true;
+}
+
+/* appendDocument adds bytes from up to to of the
+   document, from segment k on, to the work area */
+static bool appendDocument(size_t k, size_t from, size_t to)
+{
+    IncrState* is = &tiny->incr;
+    for (; (from < to) && (k < is->segmentCount); k++) {
+        const Segment* s = is->segments[k];
+        size_t at = offsetOf(k);
+        if (from >= at + s->size) {
+            continue;
+        }
+        size_t end = (to < at + s->size) ? to : at + s->size;
+        if (!appendText(s->text + (from - at), end - from)) {
+            return false;
+        }
+        from = end;
+    }
+    return true;
+}
+
+/* relex scans the work area after the prefix into
+   scanned */
+static bool relex(void)
+{
+    IncrState* is = &tiny->incr;
+    TokenStream ts = {0};
+    const char* text = is->work + is->prefixSize;
+    size_t size = is->workSize - is->prefixSize;
+    initScannerText(text, size);
+    if (!tokenize(&ts)) {
+        freeTokenStream(&ts);
+        return false;
+    }
+    size_t n = ts.count - 1; /* all but ENDFILE */
+    Token* t = grow(is->scanned, &is->scannedCapacity, n + 1, sizeof(Token));
+    if (t == NULL) {
+        freeTokenStream(&ts);
+        return false;
+    }
+    is->scanned = t;
+    int line = is->firstLine + is->prefixLines;
+    for (size_t i = 0; i < n; i++) {
+        t[i] = (Token){(TokenType)ts.kind[i], line + ts.line[i],
+                       (uint32_t)is->prefixSize + ts.offset[i], ts.length[i],
+                       ts.value[i]};
+    }
+    is->scannedCount = n;
+    is->workLines = is->prefixLines + countNewlines(text, size);
+    if ((n > 0) && (is->following < is->segmentCount) &&
+        (ts.offset[n - 1] + ts.length[n - 1] == size)) {
+        /* the scanner counts a line more for a token cut
+           short by the end of input, but more follows */
+        t[n - 1].line = line + 1 + countNewlines(text, ts.offset[n - 1]);
+    }
+    freeTokenStream(&ts);
+    return true;
+}
+
+/* needsMore tells whether the work area may scan
+ * otherwise once segment following comes after it:
+ * when it ends inside a comment, or in a token the
+ * first character of that segment would continue
+ */
+static bool needsMore(void)
+{
+    IncrState* is = &tiny->incr;
+    size_t p = is->prefixSize;
+    if (is->scannedCount > 0) {
+        const Token* last = &is->scanned[is->scannedCount - 1];
+        p = last->offset + last->length;
+        if (p == is->workSize) {
+            int c = (unsigned char)is->segments[is->following]->text[0];
+            return ((last->kind == ID) && (isalnum(c) || (c == '_'))) ||
+                   ((last->kind == NUM) && isdigit(c)) ||
+                   ((last->kind == DDOT) && (c == '='));
+        }
+    }
+    /* only blanks and comments follow the last token */
+    while (p < is->workSize) {
+        if (is->work[p] == '{') {
+            const char* close = memchr(is->work + p, '}', is->workSize - p);
+            if (close == NULL) {
+                return true;
+            }
+            p = (size_t)(close - is->work);
+        }
+        p++;
+    }
+    return false;
+}
+
+/* addTokens adds tokens from up to to of segment k,
+   its text at at in work after line newlines, to
+   workTokens */
+static void addTokens(size_t k, size_t from, size_t to, size_t at, int line)
+{
+    IncrState* is = &tiny->incr;
+    const Segment* s = is->segments[k];
+    Token* t = grow(is->workTokens, &is->workTokenCapacity,
+                    is->workCount + to - from + 1, sizeof(Token));
+    if (t == NULL) {
+        is->outOfMemory = true;
+        return;
+    }
+    is->workTokens = t;
+    for (size_t i = from; i < to; i++) {
+        Token tok = s->tokens[i];
+        tok.offset += (uint32_t)at;
+        tok.line += line;
+        t[is->workCount++] = tok;
+    }
+}
+
+/* startSegment hands segment k, its text at at in
+   work after line newlines, to the parse: its first
+   token now, the rest when the parser reads on, as
+   the statement may be taken in whole */
+static void startSegment(size_t k, size_t at, int line, bool follows)
+{
+    IncrState* is = &tiny->incr;
+    size_t count = is->segments[k]->count;
+    is->appended = (count > 0);
+    is->rest = (count > 1);
+    is->keptFollows = follows;
+    is->keptSegment = k;
+    is->keptText = at;
+    is->keptToken = is->workCount;
+    is->keptLine = line;
+    addTokens(k, 0, is->appended ? 1 : 0, at, line);
+}
+
+/* lastChar returns the last byte of the document
+   up to the end of the work area */
+static int lastChar(void)
+{
+    IncrState* is = &tiny->incr;
+    if (is->workSize > 0) {
+        return is->work[is->workSize - 1];
+    }
+    if (is->regionFirst > 0) {
+        const Segment* s = is->segments[is->regionFirst - 1];
+        return (s->size > 0) ? s->text[s->size - 1] : '\n';
+    }
+    return '\n';
+}
+
+/* endLine returns the line the scanner gives
+   ENDFILE in the document, whose segments from
+   following on lie as they did before the edit but
+   for the newlines it added */
+static int endLine(void)
+{
+    IncrState* is = &tiny->incr;
+    size_t last = is->segmentCount - 1;
+    int line = is->firstLine + is->workLines + lineOf(last) -
+               lineOf(is->following) + is->segments[last]->newlines;
+    int c = '\n';
+    for (size_t k = last + 1; k > is->following; k--) {
+        const Segment* s = is->segments[k - 1];
+        if (s->size > 0) {
+            c = s->text[s->size - 1];
+            break;
+        }
+        if (k - 1 == is->following) {
+            c = lastChar();
+        }
+    }
+    return line + 1 + ((c != '\n') ? 1 : 0);
+}
+
+/* workToken is the TokenSource of the parse of the
+   work area */
+static void workToken(Token* tok)
+{
+    IncrState* is = &tiny->incr;
+    while ((is->pulled == is->workCount) && !is->outOfMemory) {
+        if (is->rest) {
+            is->rest = false;
+            addTokens(is->keptSegment, 1,
+                      is->segments[is->keptSegment]->count, is->keptText,
+                      is->keptLine);
+        }
+        else if (is->nextPrefix < is->edited) {
+            const Segment* s = is->segments[is->nextPrefix];
+            startSegment(is->nextPrefix++, is->prefixAt, is->prefixLine, false);
+            is->prefixAt += s->size;
+            is->prefixLine += s->newlines;
+        }
+        else if (!is->scannedOut) {
+            is->scannedOut = true;
+            is->appended = false;
+            Token* t =
+                grow(is->workTokens, &is->workTokenCapacity,
+                     is->workCount + is->scannedCount + 1, sizeof(Token));
+            if (t == NULL) {
+                is->outOfMemory = true;
+                break;
+            }
+            is->workTokens = t;
+            memcpy(t + is->workCount, is->scanned,
+                   is->scannedCount * sizeof(Token));
+            is->workCount += is->scannedCount;
+        }
+        else if ((is->following < is->segmentCount) && !is->skipped) {
+            const Segment* s = is->segments[is->following];
+            size_t at = is->workSize;
+            int line = is->firstLine + is->workLines;
+            if (!appendText(s->text, s->size)) {
+                is->outOfMemory = true;
+                break;
+            }
+            is->workLines += s->newlines;
+            /* lexemes are read from work, which may have
+               moved */
+            initScannerText(is->work, is->workSize);
+            startSegment(is->following++, at, line, true);
+        }
+        else {
+            break;
+        }
+    }
+    if (is->pulled < is->workCount) {
+        is->current = is->pulled;
+        *tok = is->workTokens[is->pulled++];
+        return;
+    }
+    /* the end of the document: the line is the one
+       the scanner gives ENDFILE */
+    is->current = is->workCount;
+    int line = is->skipped ? endLine()
+                           : is->firstLine + is->workLines + 1 +
+                                 ((lastChar() != '\n') ? 1 : 0);
+    *tok = (Token){ENDFILE, line, (uint32_t)is->workSize, 0, 0};
+}
+
+/* keptStatement is the StatementSource of the parse
+   of the work area. A segment handed out whole that
+   is a statement that parsed cleanly parses to the
+   same tree wherever it sits, so that tree is taken
+   as it is and its tokens passed over. When the
+   statements after it start with the next segment
+   and all parsed cleanly, they would only be taken
+   in one by one up to the end of the document: the
+   parse is handed the end at once */
+static AstIndex keptStatement(void)
+{
+    IncrState* is = &tiny->incr;
+    if (!is->appended || (is->current != is->keptToken)) {
+        return AST_NULL;
+    }
+    const Segment* s = is->segments[is->keptSegment];
+    if ((s->tree == AST_NULL) || (s->syntaxErrors > 0)) {
+        return AST_NULL;
+    }
+    Reuse* r = grow(is->reuses, &is->reuseCapacity, is->reuseCount + 1,
+                    sizeof(Reuse));
+    if (r == NULL) {
+        return AST_NULL;
+    }
+    is->reuses = r;
+    is->reuses[is->reuseCount++] =
+        (Reuse){is->keptSegment, is->keptToken, is->keptText};
+    is->rest = false;
+    astAddSibling(s->tree, AST_NULL); /* it may have been in a sequence */
+    size_t after = is->keptSegment + 1;
+    if (is->keptFollows && (after < is->segmentCount) &&
+        !is->segments[after]->nested &&
+        (memchr(is->blocking + after, 1, is->segmentCount - after) == NULL)) {
+        is->skipped = true;
+        is->skipNested = (is->keptToken > is->pieceFrom);
+    }
+    return s->tree;
+}
+
+/* collect is the DiagnosticProc while redoing */
+static void collect(int line, const char* message, const char* detail)
+{
+    IncrState* is = &tiny->incr;
+    Message* m = grow(is->pending, &is->pendingCapacity, is->pendingCount + 1,
+                      sizeof(Message));
+    size_t l = strlen(message), d = strlen(detail);
+    char* text = malloc(l + d + 1);
+    if ((m == NULL) || (text == NULL)) {
+        free(text);
+        is->outOfMemory = true;
+        return;
+    }
+    is->pending = m;
+    memcpy(text, message, l);
+    memcpy(text + l, detail, d + 1);
+    is->pending[is->pendingCount++] = (Message){line, text};
+}
+
+/* takeErrors moves pending from up to to into s,
+   lines made relative to s */
+static bool takeErrors(Segment* s, size_t from, size_t to)
+{
+    IncrState* is = &tiny->incr;
+    if (from == to) {
+        return true;
+    }
+    Message* e = realloc(s->errors, (s->errorCount + to - from) *
+                                        sizeof(Message));
+    if (e == NULL) {
+        return false;
+    }
+    s->errors = e;
+    for (size_t i = from; i < to; i++) {
+        e[s->errorCount] = is->pending[i];
+        e[s->errorCount++].line -= s->line;
+        is->pending[i].message = NULL;
+    }
+    return true;
+}
+
+/* parseWork parses the work area into pieces, up to
+   the end of the document or to the first top level
+   segment after the edit that the parse lines up
+   with. It returns true in the second case */
+static bool parseWork(void)
+{
+    IncrState* is = &tiny->incr;
+    is->pieceCount = 0;
+    is->pendingCount = 0;
+    is->reuseCount = 0;
+    is->workCount = 0;
+    is->pulled = 0;
+    is->nextPrefix = is->regionFirst;
+    is->prefixAt = 0;
+    is->prefixLine = is->firstLine;
+    is->scannedOut = false;
+    is->appended = is->rest = false;
+    is->skipped = is->skipNested = false;
+    initScannerText(is->work, is->workSize);
+    setDiagnosticProc(collect);
+    /* a document may nest as deep as it likes: the
+       explicit stacks bound that by memory instead of
+       the C stack */
+    bool stackParse = tiny->stackParse;
+    tiny->stackParse = true;
+    parseBegin(workToken, keptStatement);
+    bool atStart = (is->regionFirst == 0);
+    bool lined = false;
+    while (!is->outOfMemory) {
+        if (!atStart && is->appended && is->keptFollows &&
+            (is->current == is->keptToken) &&
+            !is->segments[is->keptSegment]->nested) {
+            lined = true; /* the rest of the document is as it was */
+            break;
+        }
+        size_t from = is->current;
+        is->pieceFrom = from;
+        size_t nodes = astCount();
+        size_t mark = is->pendingCount;
+        size_t reused = is->reuseCount;
+        AstIndex stmt;
+        bool stray;
+        if (!parseNext(atStart, &stmt, &stray)) {
+            break;
+        }
+        atStart = false;
+        Piece* p = grow(is->pieces, &is->pieceCapacity, is->pieceCount + 1,
+                        sizeof(Piece));
+        if (p == NULL) {
+            is->outOfMemory = true;
+            break;
+        }
+        is->pieces = p;
+        is->pieces[is->pieceCount++] = (Piece){from,
+                                               is->current,
+                                               stmt,
+                                               stray,
+                                               astCount() - nodes,
+                                               mark,
+                                               is->pendingCount,
+                                               reused,
+                                               is->reuseCount};
+    }
+    parseEnd();
+    tiny->stackParse = stackParse;
+    setDiagnosticProc(NULL);
+    return lined;
+}
+
+/* addPart adds a part of piece p to parts */
+static bool addPart(const Piece* p, size_t from, size_t to, size_t reuse,
+                    bool head)
+{
+    IncrState* is = &tiny->incr;
+    Part* q =
+        grow(is->parts, &is->partCapacity, is->partCount + 1, sizeof(Part));
+    if (q == NULL) {
+        return false;
+    }
+    is->parts = q;
+    size_t token = (reuse == NONE) ? from : is->reuses[reuse].token;
+    size_t start = 0;
+    if (is->partCount > 0) {
+        start = (token < is->workCount) ? is->workTokens[token].offset
+                                        : is->workSize;
+    }
+    is->parts[is->partCount++] = (Part){p, from, to, reuse, head, start};
+    return true;
+}
+
+/* cutPieces cuts the pieces into parts: the tokens
+   of each between the segments it took in, which
+   stay as they are. The first part of a piece is its
+   head and holds its errors */
+static bool cutPieces(void)
+{
+    IncrState* is = &tiny->incr;
+    is->partCount = 0;
+    for (size_t i = 0; i < is->pieceCount; i++) {
+        const Piece* p = &is->pieces[i];
+        size_t from = p->from;
+        bool head = true;
+        for (size_t r = p->reused; r <= p->reusedEnd; r++) {
+            size_t to = (r < p->reusedEnd) ? is->reuses[r].token : p->to;
+            if ((from < to) || (head && (r == p->reusedEnd))) {
+                if (!addPart(p, from, to, NONE, head)) {
+                    return false;
+                }
+                head = false;
+            }
+            if (r < p->reusedEnd) {
+                if (!addPart(p, 0, 0, r, head)) {
+                    return false;
+                }
+                head = false;
+                from = is->reuses[r].token + 1;
+            }
+        }
+    }
+    return true;
+}
+
+/* moveText makes the text of segment s the bytes
+   from up to to of the work area, where it was at
+   at before, keeping its tokens where they are */
+static bool moveText(Segment* s, size_t at, size_t from, size_t to)
+{
+    IncrState* is = &tiny->incr;
+    char* text = malloc(to - from + 1);
+    if (text == NULL) {
+        return false;
+    }
+    memcpy(text, is->work + from, to - from);
+    text[to - from] = '\0';
+    int lines = (from <= at) ? countNewlines(is->work + from, at - from)
+                             : -countNewlines(is->work + at, from - at);
+    for (size_t i = 0; i < s->count; i++) {
+        s->tokens[i].offset = (uint32_t)(s->tokens[i].offset + at - from);
+        s->tokens[i].line += lines;
+    }
+    for (size_t i = 0; i < s->errorCount; i++) {
+        s->errors[i].line += lines;
+    }
+    free(s->text);
+    s->text = text;
+    s->size = to - from;
+    s->newlines = countNewlines(text, s->size);
+    s->treeLine -= lines;
+    return true;
+}
+
+/* makePart returns the segment of part q, which
+   owns the bytes from up to to of the work area after
+   line newlines: made anew, or the segment taken in
+   whole moved there. Returns NULL if memory runs out */
+static Segment* makePart(const Part* q, size_t from, size_t to, int line)
+{
+    IncrState* is = &tiny->incr;
+    if (q->reuse != NONE) {
+        const Reuse* r = &is->reuses[q->reuse];
+        Segment* s = is->segments[r->segment];
+        if (((from != r->text) || (to - from != s->size)) &&
+            !moveText(s, r->text, from, to)) {
+            return NULL;
+        }
+        s->line = line;
+        s->nested = !q->head;
+        return s;
+    }
+    const Piece* p = q->piece;
+    Segment* s = malloc(sizeof(Segment));
+    if (s == NULL) {
+        return NULL;
+    }
+    *s = (Segment){0};
+    s->size = to - from;
+    s->line = line;
+    s->newlines = countNewlines(is->work + from, s->size);
+    s->count = q->to - q->from;
+    s->nested = !q->head;
+    s->treeLine = line;
+    s->text = malloc(s->size + 1);
+    s->tokens = malloc((s->count + 1) * sizeof(Token));
+    if ((s->text == NULL) || (s->tokens == NULL)) {
+        freeSegment(s);
+        return NULL;
+    }
+    memcpy(s->text, is->work + from, s->size);
+    s->text[s->size] = '\0';
+    for (size_t i = 0; i < s->count; i++) {
+        Token tok = is->workTokens[q->from + i];
+        tok.offset -= (uint32_t)from;
+        tok.line -= line;
+        s->tokens[i] = tok;
+    }
+    if (q->head) {
+        s->stray = p->stray;
+        s->nodes = p->nodes;
+        s->tree = (p->reused == p->reusedEnd) ? p->stmt : AST_NULL;
+        if (!takeErrors(s, p->mark, p->markEnd)) {
+            freeSegment(s);
+            return NULL;
+        }
+        s->syntaxErrors = s->errorCount;
+    }
+    return s;
+}
+
+/* checkPiece looks for the type errors of the piece
+   made into segments from up to to, its head first,
+   once it parsed cleanly, as the compiler does */
+static bool checkPiece(Segment** made, size_t from, size_t to)
+{
+    IncrState* is = &tiny->incr;
+    const Piece* p = is->parts[from].piece;
+    Segment* head = made[from];
+    if ((is->parts[from].reuse != NONE) || (p->stmt == AST_NULL) ||
+        (head->syntaxErrors > 0)) {
+        return true;
+    }
+    /* the trees taken in have their lines brought up
+       to where they are now */
+    for (size_t i = from + 1; i < to; i++) {
+        if (is->parts[i].reuse != NONE) {
+            astShiftLines(made[i]->tree, made[i]->nodes,
+                          made[i]->line - made[i]->treeLine);
+            made[i]->treeLine = made[i]->line;
+        }
+    }
+    size_t mark = is->pendingCount;
+    setDiagnosticProc(collect);
+    typeCheck(p->stmt);
+    setDiagnosticProc(NULL);
+    bool ok = !is->outOfMemory && takeErrors(head, mark, is->pendingCount);
+    is->pendingCount = mark;
+    return ok;
+}
+
+/* replace puts the parts of the pieces in place of
+   segments regionFirst up to last, the work area up
+   to end */
+static bool replace(size_t last, size_t end)
+{
+    IncrState* is = &tiny->incr;
+    /* settle the shift up to the region, and have it
+       start at last */
+    if (is->shiftFrom < is->regionFirst) {
+        settle(is->shiftFrom, is->regionFirst);
+        is->shiftFrom = is->regionFirst;
+    }
+    else if (is->shiftFrom > last) {
+        for (size_t k = last; k < is->shiftFrom; k++) {
+            is->segments[k]->offset -= is->shiftBytes;
+            is->segments[k]->line -= is->shiftLines;
+        }
+        is->shiftFrom = last;
+    }
+    size_t offset = (is->regionFirst > 0)
+                        ? offsetOf(is->regionFirst - 1) +
+                              is->segments[is->regionFirst - 1]->size
+                        : 0;
+    for (size_t i = is->regionFirst; i < last; i++) {
+        const Segment* s = is->segments[i];
+        if (!s->nested) {
+            is->syntaxTotal -= s->syntaxErrors;
+            is->typeTotal -= s->errorCount - s->syntaxErrors;
+        }
+        is->liveNodes -= s->nodes;
+    }
+    size_t removed = last - is->regionFirst;
+    Segment** fresh = cutPieces()
+                          ? malloc((is->partCount + 1) * sizeof(Segment*))
+                          : NULL;
+    if (fresh == NULL) {
+        return false;
+    }
+    bool ok = true;
+    int line = is->firstLine;
+    size_t made = 0, head = 0;
+    while (ok && (made < is->partCount)) {
+        const Part* q = &is->parts[made];
+        size_t to =
+            (made + 1 < is->partCount) ? is->parts[made + 1].start : end;
+        head = q->head ? made : head;
+        fresh[made] = makePart(q, q->start, to, line);
+        ok = (fresh[made] != NULL);
+        if (ok) {
+            line += fresh[made++]->newlines;
+        }
+        if (ok && ((made == is->partCount) || is->parts[made].head)) {
+            ok = checkPiece(fresh, head, made);
+        }
+    }
+    size_t count = is->segmentCount - removed + is->partCount;
+    Segment** s = ok ? grow(is->segments, &is->segmentCapacity, count + 1,
+                            sizeof(Segment*))
+                     : NULL;
+    unsigned char* f =
+        (s != NULL) ? grow(is->flagged, &is->flagCapacity, count + 1, 1) : NULL;
+    unsigned char* b =
+        (f != NULL) ? grow(is->blocking, &is->blockCapacity, count + 1, 1)
+                    : NULL;
+    if (b == NULL) {
+        for (size_t i = 0; i < made; i++) {
+            if (is->parts[i].reuse == NONE) {
+                freeSegment(fresh[i]);
+            }
+        }
+        free(fresh);
+        is->segments = (s != NULL) ? s : is->segments;
+        is->flagged = (f != NULL) ? f : is->flagged;
+        return false;
+    }
+    is->segments = s;
+    is->flagged = f;
+    is->blocking = b;
+    for (size_t i = 0; i < is->reuseCount; i++) {
+        s[is->reuses[i].segment] = NULL; /* moved, not freed */
+    }
+    for (size_t i = is->regionFirst; i < last; i++) {
+        freeSegment(s[i]);
+    }
+    memmove(s + is->regionFirst + is->partCount, s + last,
+            (is->segmentCount - last) * sizeof(Segment*));
+    memmove(f + is->regionFirst + is->partCount, f + last,
+            is->segmentCount - last);
+    memmove(b + is->regionFirst + is->partCount, b + last,
+            is->segmentCount - last);
+    is->segmentCount = count;
+    if ((is->openHead != NONE) && (is->openHead >= is->regionFirst)) {
+        is->openHead = (is->openHead >= last)
+                           ? is->openHead - removed + is->partCount
+                           : NONE;
+    }
+    for (size_t i = 0; i < is->partCount; i++) {
+        Segment* n = fresh[i];
+        s[is->regionFirst + i] = n;
+        n->offset = offset;
+        offset += n->size;
+        f[is->regionFirst + i] = !n->nested && (n->errorCount > 0);
+        const Piece* p = is->parts[i].piece;
+        b[is->regionFirst + i] = p->stray || (p->stmt == AST_NULL) ||
+                                 (p->markEnd > p->mark);
+        if (is->skipNested && is->parts[i].head) {
+            is->openHead = is->regionFirst + i; /* the last statement is open */
+        }
+        if (!n->nested) {
+            is->syntaxTotal += n->syntaxErrors;
+            is->typeTotal += n->errorCount - n->syntaxErrors;
+        }
+        is->liveNodes += n->nodes;
+    }
+    free(fresh);
+    if ((is->partCount == 0) && (end > 0)) {
+        /* the edit left only blanks and comments: they
+           go to the end of the segment before */
+        Segment* b = s[is->regionFirst - 1];
+        char* t = realloc(b->text, b->size + end + 1);
+        if (t == NULL) {
+            return false;
+        }
+        memcpy(t + b->size, is->work, end);
+        b->text = t;
+        b->size += end;
+        b->text[b->size] = '\0';
+        int lines = countNewlines(is->work, end);
+        b->newlines += lines;
+        line += lines;
+        offset += end;
+    }
+    /* the segments after only move, once an edit
+       reaches them */
+    is->shiftFrom = is->regionFirst + is->partCount;
+    is->shiftBytes = 0;
+    is->shiftLines = 0;
+    if (is->shiftFrom < is->segmentCount) {
+        is->shiftBytes = offset - s[is->shiftFrom]->offset;
+        is->shiftLines = line - s[is->shiftFrom]->line;
+    }
+    return true;
+}
+
+/* redo brings the analysis up to date once the work
+   area holds the text of segments regionFirst up to
+   edited and the edited text of those up to
+   following */
+static bool redo(void)
+{
+    IncrState* is = &tiny->incr;
+    is->outOfMemory = false;
+    for (;;) {
+        if (!relex()) {
+            return false;
+        }
+        if ((is->following == is->segmentCount) || !needsMore()) {
+            break;
+        }
+        const Segment* s = is->segments[is->following++];
+        if (!appendText(s->text, s->size)) {
+            return false;
+        }
+    }
+    bool kept = parseWork();
+    bool ok = !is->outOfMemory &&
+              (kept ? replace(is->keptSegment, is->keptText)
+                    : replace(is->following, is->workSize));
+    for (size_t i = 0; i < is->pendingCount; i++) {
+        free(is->pending[i].message);
+    }
+    is->pendingCount = 0;
+    is->docLength = 0;
+    if (is->segmentCount > 0) {
+        size_t k = is->segmentCount - 1;
+        is->docLength = offsetOf(k) + is->segments[k]->size;
+    }
+    return ok;
+}
+/* segmentAt returns the segment holding byte offset,
+   the last one for offsets at or past the end */
+static size_t segmentAt(size_t offset)
+{
+    IncrState* is = &tiny->incr;
+    size_t lo = 0, hi = is->segmentCount;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (offsetOf(mid) <= offset) {
+            lo = mid;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Function docOpen makes the size bytes at text the
+ * document, in place of any other, and analyzes it
+ * in full. Returns false if memory runs out
+ */
+bool docOpen(const char* text, size_t size)
+{
+    IncrState* is = &tiny->incr;
+    docClose();
+    is->workSize = is->prefixSize = 0;
+    is->firstLine = is->prefixLines = 0;
+    is->regionFirst = is->edited = is->following = 0;
+    if (!appendText(text, size) || !redo()) {
+        docClose();
+        return false;
+    }
+    return true;
+}
+
+/* Function docEdit replaces bytes start up to end of
+ * the document with the size bytes at text and
+ * brings the analysis up to date. Offsets past the
+ * end are taken as the end. Returns false if memory
+ * runs out, which closes the document
+ */
+bool docEdit(size_t start, size_t end, const char* text, size_t size)
+{
+    IncrState* is = &tiny->incr;
+    if ((is->segmentCount == 0) && !docOpen("", 0)) {
+        return false;
+    }
+    end = (end < is->docLength) ? end : is->docLength;
+    start = (start < end) ? start : end;
+    /* the byte before the edit is taken in too, as a
+       token may now run across it */
+    size_t first = segmentAt((start > 0) ? start - 1 : 0);
+    size_t last = segmentAt(end);
+    const Segment* f = is->segments[first];
+    size_t at = offsetOf(first);
+    size_t lead = at + f->size;
+    if (f->count > 0) {
+        lead = at + f->tokens[0].offset + f->tokens[0].length;
+    }
+    /* the parse starts over at the top level statement
+       holding the edit, or the one before when that
+       was parsed looking ahead at the first token */
+    size_t head = ((first > 0) && (start <= lead)) ? first - 1 : first;
+    while ((head > 0) && is->segments[head]->nested) {
+        head--;
+    }
+    /* in the segments an unclosed statement took in,
+       the parse starts over at that statement */
+    if ((is->openHead != NONE) && (head > is->openHead)) {
+        head = is->openHead;
+    }
+    is->workSize = 0;
+    is->firstLine = lineOf(head);
+    is->regionFirst = head;
+    is->edited = first;
+    is->following = last + 1;
+    bool ok = appendDocument(head, offsetOf(head), at);
+    is->prefixSize = is->workSize;
+    is->prefixLines = lineOf(first) - is->firstLine;
+    ok = ok && appendDocument(first, at, start) && appendText(text, size) &&
+         appendDocument(first, end,
+                        offsetOf(last) + is->segments[last]->size) &&
+         redo();
+    if (ok && (astCount() > 4 * is->liveNodes + (1 << 20))) {
+        /* most of the tree vector is left from edits:
+           start it over from the text */
+        size_t n;
+        char* all = docText(&n);
+        ok = (all != NULL) && docOpen(all, n);
+        free(all);
+    }
+    if (!ok) {
+        docClose();
+    }
+    return ok;
+}
+
+/* widthOf is the width in columns of the byte c:
+   1, or with UTF-16 columns the code units of the
+   character it starts, 0 if it continues one */
+static size_t widthOf(unsigned char c)
+{
+    if (!tiny->incr.utf16 || (c < 0x80)) {
+        return 1;
+    }
+    return ((c & 0xC0) == 0x80) ? 0 : (c >= 0xF0) ? 2 : 1;
+}
+
+/* Function docOffset returns the byte offset of
+ * column column of line line, clamped to the end of
+ * the line and of the document
+ */
+size_t docOffset(int line, size_t column)
+{
+    IncrState* is = &tiny->incr;
+    if (is->segmentCount == 0) {
+        return 0;
+    }
+    size_t k = 0, at = 0;
+    if (line > 1) {
+        /* find the newline ending line - 1 */
+        int n = line - 1;
+        size_t e = is->segmentCount - 1;
+        if (n > lineOf(e) + is->segments[e]->newlines) {
+            return is->docLength;
+        }
+        size_t lo = 0, hi = is->segmentCount;
+        while (hi - lo > 1) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (lineOf(mid) < n) {
+                lo = mid;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        k = lo;
+        const Segment* s = is->segments[k];
+        const char* p = s->text;
+        for (int left = n - lineOf(k);; p++) {
+            p = memchr(p, '\n', s->size - (size_t)(p - s->text));
+            if (--left == 0) {
+                break;
+            }
+        }
+        at = (size_t)(p - s->text) + 1;
+    }
+    /* the bytes of a character are taken whole */
+    while (k < is->segmentCount) {
+        if (at == is->segments[k]->size) {
+            k++;
+            at = 0;
+            continue;
+        }
+        unsigned char c = (unsigned char)is->segments[k]->text[at];
+        size_t width = widthOf(c);
+        if ((c == '\n') || (width > column)) {
+            break;
+        }
+        at++;
+        column -= width;
+    }
+    return (k < is->segmentCount) ? offsetOf(k) + at : is->docLength;
+}
+
+/* Function docDiagnostics returns the errors that
+ * compiling the document would report, in order:
+ * its syntax errors, or when there are none its type
+ * errors. *count is set to their number. They stay
+ * valid until the next edit
+ */
+const Diagnostic* docDiagnostics(size_t* count)
+{
+    IncrState* is = &tiny->incr;
+    bool syntax = (is->syntaxTotal > 0);
+    size_t total = syntax ? is->syntaxTotal : is->typeTotal;
+    size_t n = 0;
+    Diagnostic* d = (total == 0)
+                        ? NULL
+                        : grow(is->published, &is->publishedCapacity, total,
+                               sizeof(Diagnostic));
+    if (d != NULL) {
+        is->published = d;
+        for (size_t k = 0; (k < is->segmentCount) && (n < total); k++) {
+            const unsigned char* f =
+                memchr(is->flagged + k, 1, is->segmentCount - k);
+            if (f == NULL) {
+                break;
+            }
+            k = (size_t)(f - is->flagged);
+            const Segment* s = is->segments[k];
+            int line = lineOf(k);
+            size_t from = syntax ? 0 : s->syntaxErrors;
+            size_t to = syntax ? s->syntaxErrors : s->errorCount;
+            for (size_t i = from; i < to; i++) {
+                d[n++] = (Diagnostic){line + s->errors[i].line,
+                                      s->errors[i].message};
+            }
+            if (syntax && s->stray) {
+                break; /* a whole program parse stops here */
+            }
+        }
+    }
+    *count = n;
+    return is->published;
+}
+
+/* columnOf returns the column of byte at of segment
+   k, looking back into earlier segments as needed */
+static size_t columnOf(size_t k, size_t at)
+{
+    IncrState* is = &tiny->incr;
+    size_t column = 0;
+    for (;;) {
+        const char* t = is->segments[k]->text;
+        size_t i = at;
+        while ((i > 0) && (t[i - 1] != '\n')) {
+            column += widthOf((unsigned char)t[--i]);
+        }
+        if ((i > 0) || (k == 0)) {
+            return column;
+        }
+        k--;
+        at = is->segments[k]->size;
+    }
+}
+
+/* Function docReferences returns the position of
+ * every occurrence of the identifier at byte offset
+ * offset, in document order. *count is set to their
+ * number, 0 when there is no identifier there. They
+ * stay valid until the next call
+ */
+const DocPosition* docReferences(size_t offset, size_t* count)
+{
+    IncrState* is = &tiny->incr;
+    *count = 0;
+    if (is->segmentCount == 0) {
+        return is->found;
+    }
+    /* the identifier the offset is in or just after */
+    size_t at = segmentAt(offset);
+    const Segment* s = is->segments[at];
+    int symbol = -1;
+    for (size_t i = 0; i < s->count; i++) {
+        const Token* t = &s->tokens[i];
+        size_t from = offsetOf(at) + t->offset;
+        if ((t->kind == ID) && (from <= offset) &&
+            (offset <= from + t->length)) {
+            symbol = t->value;
+        }
+    }
+    if (symbol < 0) {
+        return is->found;
+    }
+    size_t n = 0;
+    for (size_t k = 0; k < is->segmentCount; k++) {
+        const Segment* g = is->segments[k];
+        for (size_t i = 0; i < g->count; i++) {
+            const Token* t = &g->tokens[i];
+            if ((t->kind != ID) || (t->value != symbol)) {
+                continue;
+            }
+            DocPosition* f = grow(is->found, &is->foundCapacity, n + 1,
+                                  sizeof(DocPosition));
+            if (f == NULL) {
+                return is->found;
+            }
+            is->found = f;
+            is->found[n++] = (DocPosition){lineOf(k) + t->line,
+                                           columnOf(k, t->offset), t->length};
+            *count = n;
+        }
+    }
+    return is->found;
+}
+
+/* Function docText returns a copy of the document,
+ * for the caller to free, and its size in *size.
+ * Returns NULL if memory runs out
+ */
+char* docText(size_t* size)
+{
+    IncrState* is = &tiny->incr;
+    char* t = malloc(is->docLength + 1);
+    if (t == NULL) {
+        return NULL;
+    }
+    size_t at = 0;
+    for (size_t k = 0; k < is->segmentCount; k++) {
+        memcpy(t + at, is->segments[k]->text, is->segments[k]->size);
+        at += is->segments[k]->size;
+    }
+    t[is->docLength] = '\0';
+    *size = is->docLength;
+    return t;
+}
+
+/* Procedure docUtf16 counts the columns of docOffset
+ * and docReferences in UTF-16 code units if on, as
+ * the Language Server Protocol does unless told
+ * otherwise, and in bytes if not, as at first
+ */
+void docUtf16(bool on) { tiny->incr.utf16 = on; }
+
+/* Procedure docClose releases the document */
+void docClose(void)
+{
+    IncrState* is = &tiny->incr;
+    for (size_t k = 0; k < is->segmentCount; k++) {
+        freeSegment(is->segments[k]);
+    }
+    free(is->segments);
+    free(is->flagged);
+    free(is->blocking);
+    is->segments = NULL;
+    is->flagged = NULL;
+    is->blocking = NULL;
+    is->segmentCount = is->segmentCapacity = 0;
+    is->flagCapacity = is->blockCapacity = 0;
+    is->openHead = NONE;
+    is->shiftFrom = is->shiftBytes = 0;
+    is->shiftLines = 0;
+    is->docLength = is->liveNodes = is->syntaxTotal = is->typeTotal = 0;
+    freeAst();
+}
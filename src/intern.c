@@ -0,0 +1,152 @@
+/****************************************************/
+/* File: intern.c                                   */
+/* Identifier intern pool implementation            */
+/* for the TINY compiler                            */
+/* Names live in large character blocks; a linear   */
+/* probing table maps a name to its symbol id       */
+/****************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "include/arena.h"
+#include "include/compiler.h"
+#include "include/intern.h"
+
+/* Function internHash returns the hash internName
+ * uses for the len characters at name (FNV-1a).
+ * It does not touch the pool, so any thread may
+ * call it
+ */
+unsigned internHash(const char* name, size_t len)
+{
+    unsigned h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return h;
+}
+
+/* growSymbols doubles the per-symbol arrays */
+static int growSymbols(void)
+{
+    InternState* in = &tiny->intern;
+    int cap = (in->capacity == 0) ? 256 : 2 * in->capacity;
+    const char** n = realloc(in->names, (size_t)cap * sizeof(*n));
+    if (n != NULL) {
+        in->names = n;
+    }
+    size_t* l = realloc(in->lengths, (size_t)cap * sizeof(*l));
+    if (l != NULL) {
+        in->lengths = l;
+    }
+    unsigned* h = realloc(in->hashes, (size_t)cap * sizeof(*h));
+    if (h != NULL) {
+        in->hashes = h;
+    }
+    if ((n == NULL) || (l == NULL) || (h == NULL)) {
+        return 0;
+    }
+    in->capacity = cap;
+    return 1;
+}
+
+/* growSlots rebuilds the probing table at twice
+   its size, keeping the load factor below 1/2 */
+static int growSlots(void)
+{
+    InternState* in = &tiny->intern;
+    size_t size = (in->slotMask == 0) ? 512 : 2 * (in->slotMask + 1);
+    int* s = calloc(size, sizeof(*s));
+    if (s == NULL) {
+        return 0;
+    }
+    for (int id = 0; id < in->count; id++) {
+        size_t i = in->hashes[id] & (size - 1);
+        while (s[i] != 0) {
+            i = (i + 1) & (size - 1);
+        }
+        s[i] = id + 1;
+    }
+    free(in->slots);
+    in->slots = s;
+    in->slotMask = size - 1;
+    return 1;
+}
+
+/* Function internName returns the symbol id of the
+ * len characters at name, adding them to the pool
+ * the first time they are seen. Ids are dense and
+ * numbered from 0 in order of first appearance.
+ * Returns -1 if memory runs out
+ */
+int internName(const char* name, size_t len)
+{
+    return internHashedName(name, len, internHash(name, len));
+}
+
+/* Function internHashedName is internName for a
+ * name whose internHash is already known
+ */
+int internHashedName(const char* name, size_t len, unsigned h)
+{
+    InternState* in = &tiny->intern;
+    if ((size_t)in->count * 2 >= in->slotMask && !growSlots()) {
+        return -1;
+    }
+    size_t i = h & in->slotMask;
+    while (in->slots[i] != 0) {
+        int id = in->slots[i] - 1;
+        if ((in->hashes[id] == h) && (in->lengths[id] == len) &&
+            (memcmp(in->names[id], name, len) == 0)) {
+            return id;
+        }
+        i = (i + 1) & in->slotMask;
+    }
+    if ((in->count == in->capacity) && !growSymbols()) {
+        return -1;
+    }
+    const char* s = arenaCopy(&in->nameArena, name, len);
+    if (s == NULL) {
+        return -1;
+    }
+    in->names[in->count] = s;
+    in->lengths[in->count] = len;
+    in->hashes[in->count] = h;
+    in->slots[i] = in->count + 1;
+    return in->count++;
+}
+
+/* Function symbolName returns the NUL terminated
+ * name of symbol sym
+ */
+const char* symbolName(int sym) { return tiny->intern.names[sym]; }
+
+/* Function symbolHash returns the hash of the name
+ * of symbol sym, computed once when it was interned
+ */
+unsigned symbolHash(int sym) { return tiny->intern.hashes[sym]; }
+
+/* Function symbolCount returns the number of
+ * symbols interned so far
+ */
+int symbolCount(void) { return tiny->intern.count; }
+
+/* Procedure freeInternPool releases every name and
+ * invalidates all symbol ids
+ */
+void freeInternPool(void)
+{
+    InternState* in = &tiny->intern;
+    arenaRelease(&in->nameArena);
+    free(in->names);
+    free(in->lengths);
+    free(in->hashes);
+    free(in->slots);
+    in->names = NULL;
+    in->lengths = NULL;
+    in->hashes = NULL;
+    in->slots = NULL;
+    in->slotMask = 0;
+    in->count = in->capacity = 0;
+}
@@ -0,0 +1,117 @@
+/****************************************************/
+/* File: libtiny.c                                  */
+/* The TINY compiler as a library: compiles a       */
+/* program in memory to TM code in memory, in a     */
+/* compilation context of its own                   */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "include/libtiny.h"
+#include "include/compiler.h"
+#include "include/driver.h"
+#include "include/parse.h"
+
+/* copyOut copies the size bytes of text to out the
+   way snprintf would. Returns false if they do not
+   all fit */
+static bool copyOut(TinyBuffer* out, const char* text, size_t size)
+{
+    if (out == NULL) {
+        return true;
+    }
+    out->length = size;
+    if (out->capacity == 0) {
+        return size == 0;
+    }
+    size_t n = (size < out->capacity) ? size : out->capacity - 1;
+    memcpy(out->data, text, n);
+    out->data[n] = '\0';
+    return n == size;
+}
+
+/* compileText runs the phases after the scanner was
+   positioned on the source, in the context bound to
+   the thread */
+static void compileText(const TinyOptions* options)
+{
+    AstIndex syntaxTree = parse();
+    if (tiny->traceParse && !tiny->error) {
+        fprintf(tiny->listing, "\nSyntax tree:\n");
+        astForEachStatement(syntaxTree, printTree);
+    }
+    /* the code goes to the stream already open */
+    compileTree(syntaxTree, options->compactSlots, tiny->filePath);
+}
+
+/* Function tiny_compile compiles the len bytes of
+ * TINY source at src with options, NULL for the
+ * defaults, writing the TM code to code and the
+ * listing, with any errors, to diagnostics. Either
+ * buffer may be NULL if its output is not wanted.
+ * No code is written for a program with errors.
+ * Each call has a compilation context of its own,
+ * so it may be made from many threads at once
+ */
+TinyStatus tiny_compile(const char* src, size_t len,
+                        const TinyOptions* options, TinyBuffer* code,
+                        TinyBuffer* diagnostics)
+{
+    static const TinyOptions defaults = {0};
+    if (options == NULL) {
+        options = &defaults;
+    }
+    TinyCompiler* tc = tinyNew();
+    if (tc == NULL) {
+        return TINY_NO_MEMORY;
+    }
+    tc->filePath = (options->name != NULL) ? options->name : "";
+    tc->echoSource = options->echoSource;
+    tc->traceScan = options->traceScan;
+    tc->traceParse = options->traceParse;
+    tc->traceAnalyze = options->traceAnalyze;
+    tc->traceCode = options->traceCode;
+    tc->lexThreads = (options->lexThreads > 1) ? options->lexThreads : 1;
+    tc->analyzeThreads =
+        (options->analyzeThreads > 1) ? options->analyzeThreads : 1;
+    tc->pipelineParse = options->pipelineParse;
+    tc->stackParse = options->stackParse;
+
+    char* listingText = NULL;
+    size_t listingSize = 0;
+    char* codeText = NULL;
+    size_t codeSize = 0;
+    /* the scanner wants a '\0' past the text: the
+       copy is freed with the context */
+    char* text = malloc(len + 1);
+    tc->listing = open_memstream(&listingText, &listingSize);
+    tc->code = open_memstream(&codeText, &codeSize);
+    bool ok = (text != NULL) && (tc->listing != NULL) && (tc->code != NULL);
+    TinyCompiler* previous = tinyUse(tc);
+    if (ok) {
+        memcpy(text, src, len);
+        text[len] = '\0';
+        tc->scan.sourceBuf = (SourceBuffer){text, len, false};
+        initScannerText(text, len);
+        compileText(options);
+    }
+    else {
+        free(text);
+    }
+    bool failed = tc->error;
+    ok = ((tc->listing == NULL) || (fclose(tc->listing) == 0)) && ok;
+    ok = ((tc->code == NULL) || (fclose(tc->code) == 0)) && ok;
+    tinyFree(tc);
+    tinyUse(previous);
+
+    TinyStatus status = TINY_NO_MEMORY;
+    if (ok) {
+        bool fits = copyOut(diagnostics, listingText, listingSize);
+        /* a program with errors has no code */
+        fits = copyOut(code, codeText, failed ? 0 : codeSize) && fits;
+        status = failed ? TINY_ERROR : fits ? TINY_OK : TINY_TRUNCATED;
+    }
+    free(listingText);
+    free(codeText);
+    return status;
+}
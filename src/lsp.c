@@ -0,0 +1,760 @@
+/****************************************************/
+/* File: lsp.c                                      */
+/* Language server front end for the TINY compiler: */
+/* reads JSON-RPC messages from the client, keeps   */
+/* the open documents in the incremental front end  */
+/* and publishes their diagnostics on every change  */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <ctype.h>
+#include <strings.h>
+
+#include "include/arena.h"
+#include "include/compiler.h"
+#include "include/incr.h"
+#include "include/lsp.h"
+
+/* JSON-RPC error codes */
+#define PARSE_ERROR (-32700)
+#define INVALID_REQUEST (-32600)
+#define METHOD_NOT_FOUND (-32601)
+
+/* MAXDEPTH = deepest nesting of a message accepted */
+#define MAXDEPTH 64
+
+/****************************************/
+/* the JSON reader                      */
+/****************************************/
+
+typedef enum {
+    JsonNull,
+    JsonBool,
+    JsonNumber,
+    JsonString,
+    JsonArray,
+    JsonObject
+} JsonKind;
+
+/* A Json is one value of a message. The elements of
+ * an array and the members of an object are its
+ * children, linked by next; a member has a key
+ */
+typedef struct Json Json;
+struct Json {
+    JsonKind kind;
+    const char* key;    /* member name, for object members */
+    const char* string; /* JsonString, '\0' ended */
+    size_t length;      /* bytes in string */
+    double number;      /* JsonNumber, and JsonBool as 0 or 1 */
+    Json* child;        /* first element or member */
+    Json* next;         /* next element or member */
+};
+
+/* A JsonReader walks the text of a message, making
+   its values in arena */
+typedef struct {
+    const char* p;
+    const char* end;
+    int depth;
+    Arena* arena;
+} JsonReader;
+
+static Json* readValue(JsonReader* r);
+
+static void skipBlanks(JsonReader* r)
+{
+    while ((r->p < r->end) && ((*r->p == ' ') || (*r->p == '\t') ||
+                               (*r->p == '\n') || (*r->p == '\r'))) {
+        r->p++;
+    }
+}
+
+/* readWord accepts the literal word at the reader */
+static bool readWord(JsonReader* r, const char* word)
+{
+    size_t n = strlen(word);
+    if (((size_t)(r->end - r->p) < n) || (memcmp(r->p, word, n) != 0)) {
+        return false;
+    }
+    r->p += n;
+    return true;
+}
+
+/* readHex reads the four hex digits of a \u escape */
+static long readHex(JsonReader* r)
+{
+    long v = 0;
+    for (int i = 0; i < 4; i++) {
+        if ((r->p == r->end) || !isxdigit((unsigned char)*r->p)) {
+            return -1;
+        }
+        int c = tolower((unsigned char)*r->p++);
+        v = v * 16 + (isdigit(c) ? c - '0' : c - 'a' + 10);
+    }
+    return v;
+}
+
+/* putUtf8 writes code point c at s as UTF-8 and
+   returns the bytes written */
+static size_t putUtf8(char* s, long c)
+{
+    if (c < 0x80) {
+        s[0] = (char)c;
+        return 1;
+    }
+    if (c < 0x800) {
+        s[0] = (char)(0xC0 | (c >> 6));
+        s[1] = (char)(0x80 | (c & 0x3F));
+        return 2;
+    }
+    if (c < 0x10000) {
+        s[0] = (char)(0xE0 | (c >> 12));
+        s[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        s[2] = (char)(0x80 | (c & 0x3F));
+        return 3;
+    }
+    s[0] = (char)(0xF0 | (c >> 18));
+    s[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+    s[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+    s[3] = (char)(0x80 | (c & 0x3F));
+    return 4;
+}
+
+/* readString reads a string, the opening quote
+   already taken, unescaped into the arena */
+static const char* readString(JsonReader* r, size_t* length)
+{
+    const char* close = r->p;
+    while ((close < r->end) && (*close != '"')) {
+        close += (*close == '\\') ? 2 : 1;
+    }
+    if (close >= r->end) {
+        return NULL;
+    }
+    /* escapes never take more room than they print */
+    char* s = arenaAlloc(r->arena, (size_t)(close - r->p) + 1);
+    size_t n = 0;
+    while ((s != NULL) && (r->p < close)) {
+        char c = *r->p++;
+        if (c != '\\') {
+            s[n++] = c;
+            continue;
+        }
+        c = *r->p++;
+        switch (c) {
+        case 'b':
+            s[n++] = '\b';
+            break;
+        case 'f':
+            s[n++] = '\f';
+            break;
+        case 'n':
+            s[n++] = '\n';
+            break;
+        case 'r':
+            s[n++] = '\r';
+            break;
+        case 't':
+            s[n++] = '\t';
+            break;
+        case 'u': {
+            long u = readHex(r);
+            if ((u >= 0xD800) && (u < 0xDC00) && (close - r->p >= 6) &&
+                (r->p[0] == '\\') && (r->p[1] == 'u')) {
+                r->p += 2;
+                long low = readHex(r);
+                u = ((low >= 0xDC00) && (low < 0xE000))
+                        ? 0x10000 + ((u - 0xD800) << 10) + (low - 0xDC00)
+                        : -1;
+            }
+            if (u < 0) {
+                return NULL;
+            }
+            n += putUtf8(s + n, u);
+            break;
+        }
+        default: /* '"', '\\' and '/' stand for themselves */
+            s[n++] = c;
+            break;
+        }
+    }
+    if (s == NULL) {
+        return NULL;
+    }
+    s[n] = '\0';
+    r->p = close + 1;
+    *length = n;
+    return s;
+}
+
+/* readChildren reads the elements of an array or the
+   members of an object up to close */
+static bool readChildren(JsonReader* r, Json* v, char close)
+{
+    Json** link = &v->child;
+    skipBlanks(r);
+    if ((r->p < r->end) && (*r->p == close)) {
+        r->p++;
+        return true;
+    }
+    for (;;) {
+        const char* key = NULL;
+        size_t length;
+        if (v->kind == JsonObject) {
+            skipBlanks(r);
+            if ((r->p == r->end) || (*r->p++ != '"') ||
+                ((key = readString(r, &length)) == NULL)) {
+                return false;
+            }
+            skipBlanks(r);
+            if ((r->p == r->end) || (*r->p++ != ':')) {
+                return false;
+            }
+        }
+        Json* c = readValue(r);
+        if (c == NULL) {
+            return false;
+        }
+        c->key = key;
+        *link = c;
+        link = &c->next;
+        skipBlanks(r);
+        if (r->p == r->end) {
+            return false;
+        }
+        char sep = *r->p++;
+        if (sep == close) {
+            return true;
+        }
+        if (sep != ',') {
+            return false;
+        }
+    }
+}
+
+/* readValue reads one value; returns NULL if the
+   text is not JSON */
+static Json* readValue(JsonReader* r)
+{
+    skipBlanks(r);
+    Json* v = arenaAlloc(r->arena, sizeof(Json));
+    if ((v == NULL) || (r->p == r->end) || (r->depth >= MAXDEPTH)) {
+        return NULL;
+    }
+    *v = (Json){JsonNull, NULL, NULL, 0, 0, NULL, NULL};
+    bool ok = true;
+    char c = *r->p;
+    if ((c == '{') || (c == '[')) {
+        r->p++;
+        r->depth++;
+        v->kind = (c == '{') ? JsonObject : JsonArray;
+        ok = readChildren(r, v, (c == '{') ? '}' : ']');
+        r->depth--;
+    }
+    else if (c == '"') {
+        r->p++;
+        v->kind = JsonString;
+        ok = ((v->string = readString(r, &v->length)) != NULL);
+    }
+    else if (readWord(r, "true") || readWord(r, "false")) {
+        v->kind = JsonBool;
+        v->number = (c == 't');
+    }
+    else if (readWord(r, "null")) {
+        v->kind = JsonNull;
+    }
+    else {
+        char* after;
+        v->kind = JsonNumber;
+        v->number = strtod(r->p, &after);
+        ok = (after != r->p) && (after <= r->end);
+        r->p = after;
+    }
+    return ok ? v : NULL;
+}
+
+/* member returns the member key of object, or NULL */
+static const Json* member(const Json* object, const char* key)
+{
+    if ((object == NULL) || (object->kind != JsonObject)) {
+        return NULL;
+    }
+    for (const Json* m = object->child; m != NULL; m = m->next) {
+        if (strcmp(m->key, key) == 0) {
+            return m;
+        }
+    }
+    return NULL;
+}
+
+/* stringOf returns a string value, or NULL */
+static const char* stringOf(const Json* v)
+{
+    return ((v != NULL) && (v->kind == JsonString)) ? v->string : NULL;
+}
+
+/* numberOf returns a number value, or otherwise */
+static long numberOf(const Json* v, long otherwise)
+{
+    return ((v != NULL) && (v->kind == JsonNumber)) ? (long)v->number
+                                                    : otherwise;
+}
+
+/****************************************/
+/* the message channel                  */
+/****************************************/
+
+/* An LspDocument is a document the client has
+   open, kept in the incremental front end of a
+   context of its own */
+typedef struct {
+    char* uri;
+    long version;
+    TinyCompiler* context;
+} LspDocument;
+
+/* An LspSession is the state of one client: the
+ * channel to it, the message being read and the one
+ * being written, and the documents it has open
+ */
+typedef struct {
+    FILE* in;
+    FILE* out;
+    /* every Json of the message being handled */
+    Arena json;
+    /* the body of the last message read */
+    char* body;
+    size_t bodyCapacity;
+    /* the message being written */
+    char* message;
+    size_t messageSize;
+    /* the context lspServe runs in */
+    TinyCompiler* context;
+    /* the open documents, in no order */
+    LspDocument* documents;
+    size_t documentCount;
+    size_t documentCapacity;
+    /* columns are counted in UTF-16 code units, as
+       the client does unless it takes utf-8 */
+    bool utf16;
+} LspSession;
+
+/* readMessage reads the next message into the body
+   of ls and returns its size; returns false at end
+   of input */
+static bool readMessage(LspSession* ls, size_t* size)
+{
+    char* header = NULL;
+    size_t headerCapacity = 0;
+    long length = -1;
+    ssize_t n;
+    while ((n = getline(&header, &headerCapacity, ls->in)) > 0) {
+        if ((header[0] == '\r') || (header[0] == '\n')) {
+            if (length >= 0) {
+                break;
+            }
+            continue; /* blank lines before a header */
+        }
+        if (strncasecmp(header, "Content-Length:", 15) == 0) {
+            length = atol(header + 15);
+        }
+    }
+    free(header);
+    if ((n <= 0) || (length < 0)) {
+        return false;
+    }
+    if ((size_t)length + 1 > ls->bodyCapacity) {
+        char* b = realloc(ls->body, (size_t)length + 1);
+        if (b == NULL) {
+            return false;
+        }
+        ls->body = b;
+        ls->bodyCapacity = (size_t)length + 1;
+    }
+    if (fread(ls->body, 1, (size_t)length, ls->in) != (size_t)length) {
+        return false;
+    }
+    ls->body[length] = '\0';
+    *size = (size_t)length;
+    return true;
+}
+
+/* beginMessage opens a new message of ls to write;
+   returns NULL if memory runs out */
+static FILE* beginMessage(LspSession* ls)
+{
+    FILE* m = open_memstream(&ls->message, &ls->messageSize);
+    if (m != NULL) {
+        fprintf(m, "{\"jsonrpc\":\"2.0\",");
+    }
+    return m;
+}
+
+/* sendMessage closes m and sends it to the client */
+static void sendMessage(LspSession* ls, FILE* m)
+{
+    fprintf(m, "}");
+    if (fclose(m) == 0) {
+        fprintf(ls->out, "Content-Length: %zu\r\n\r\n", ls->messageSize);
+        fwrite(ls->message, 1, ls->messageSize, ls->out);
+        fflush(ls->out);
+    }
+    free(ls->message);
+    ls->message = NULL;
+}
+
+/* writeString writes s as a JSON string */
+static void writeString(FILE* m, const char* s)
+{
+    fputc('"', m);
+    for (; *s != '\0'; s++) {
+        unsigned char c = (unsigned char)*s;
+        if ((c == '"') || (c == '\\')) {
+            fprintf(m, "\\%c", c);
+        }
+        else if (c == '\n') {
+            fprintf(m, "\\n");
+        }
+        else if (c < 0x20) {
+            fprintf(m, "\\u%04x", c);
+        }
+        else {
+            fputc(c, m);
+        }
+    }
+    fputc('"', m);
+}
+
+/* writeId writes the id of a request back */
+static void writeId(FILE* m, const Json* id)
+{
+    fprintf(m, "\"id\":");
+    if ((id != NULL) && (id->kind == JsonString)) {
+        writeString(m, id->string);
+    }
+    else if ((id != NULL) && (id->kind == JsonNumber)) {
+        fprintf(m, "%.17g", id->number);
+    }
+    else {
+        fprintf(m, "null");
+    }
+}
+
+/* replyError answers request id with an error */
+static void replyError(LspSession* ls, const Json* id, int code,
+                       const char* text)
+{
+    FILE* m = beginMessage(ls);
+    if (m != NULL) {
+        writeId(m, id);
+        fprintf(m, ",\"error\":{\"code\":%d,\"message\":", code);
+        writeString(m, text);
+        fprintf(m, "}");
+        sendMessage(ls, m);
+    }
+}
+
+/****************************************/
+/* the server                           */
+/****************************************/
+
+/* findDocument returns the document of ls named
+   uri, or NULL if it is not open */
+static LspDocument* findDocument(LspSession* ls, const char* uri)
+{
+    for (size_t i = 0; (uri != NULL) && (i < ls->documentCount); i++) {
+        if (strcmp(ls->documents[i].uri, uri) == 0) {
+            return &ls->documents[i];
+        }
+    }
+    return NULL;
+}
+
+/* addDocument adds the document uri to ls, with a
+   context of its own; returns NULL if memory runs
+   out */
+static LspDocument* addDocument(LspSession* ls, const char* uri)
+{
+    if (ls->documentCount == ls->documentCapacity) {
+        size_t cap = (ls->documentCapacity == 0) ? 8
+                                                 : 2 * ls->documentCapacity;
+        LspDocument* d = realloc(ls->documents, cap * sizeof(LspDocument));
+        if (d == NULL) {
+            return NULL;
+        }
+        ls->documents = d;
+        ls->documentCapacity = cap;
+    }
+    TinyCompiler* tc = tinyNew();
+    char* name = strdup(uri);
+    if ((tc == NULL) || (name == NULL)) {
+        tinyFree(tc);
+        free(name);
+        return NULL;
+    }
+    tc->listing = ls->context->listing;
+    tc->filePath = ls->context->filePath;
+    tinyUse(tc);
+    docUtf16(ls->utf16);
+    tinyUse(ls->context);
+    LspDocument* d = &ls->documents[ls->documentCount++];
+    *d = (LspDocument){name, 0, tc};
+    return d;
+}
+
+/* dropDocument closes d and takes it out of ls */
+static void dropDocument(LspSession* ls, LspDocument* d)
+{
+    tinyFree(d->context);
+    free(d->uri);
+    *d = ls->documents[--ls->documentCount];
+}
+
+/* publish sends the diagnostics of d, whose context
+   is in use, or none once it is closed */
+static void publish(LspSession* ls, const LspDocument* d, bool closed)
+{
+    size_t n = 0;
+    const Diagnostic* diag = closed ? NULL : docDiagnostics(&n);
+    FILE* m = beginMessage(ls);
+    if (m == NULL) {
+        return;
+    }
+    fprintf(m, "\"method\":\"textDocument/publishDiagnostics\","
+               "\"params\":{\"uri\":");
+    writeString(m, d->uri);
+    fprintf(m, ",\"version\":%ld,\"diagnostics\":[", d->version);
+    for (size_t i = 0; i < n; i++) {
+        int line = (diag[i].line > 0) ? diag[i].line - 1 : 0;
+        fprintf(m,
+                "%s{\"range\":{\"start\":{\"line\":%d,\"character\":0},"
+                "\"end\":{\"line\":%d,\"character\":0}},"
+                "\"severity\":1,\"source\":\"tiny\",\"message\":",
+                (i > 0) ? "," : "", line, line + 1);
+        writeString(m, diag[i].message);
+        fprintf(m, "}");
+    }
+    fprintf(m, "]}");
+    sendMessage(ls, m);
+}
+
+/* offsetOf converts an LSP position to an offset */
+static size_t offsetOf(const Json* position)
+{
+    long line = numberOf(member(position, "line"), 0);
+    long column = numberOf(member(position, "character"), 0);
+    return docOffset((int)((line > 0) ? line + 1 : 1),
+                     (size_t)((column > 0) ? column : 0));
+}
+
+/* initialize answers the initialize request */
+static void initialize(LspSession* ls, const Json* id, const Json* params)
+{
+    /* columns are counted in bytes when the client
+       takes utf-8, and in UTF-16 code units if not */
+    const Json* general = member(member(params, "capabilities"), "general");
+    const Json* encodings = member(general, "positionEncodings");
+    bool utf8 = false;
+    for (const Json* e = (encodings != NULL) ? encodings->child : NULL;
+         e != NULL; e = e->next) {
+        const char* s = stringOf(e);
+        utf8 = utf8 || ((s != NULL) && (strcmp(s, "utf-8") == 0));
+    }
+    ls->utf16 = !utf8;
+    FILE* m = beginMessage(ls);
+    if (m != NULL) {
+        writeId(m, id);
+        fprintf(m, ",\"result\":{\"capabilities\":{%s"
+                   "\"textDocumentSync\":{\"openClose\":true,\"change\":2},"
+                   "\"referencesProvider\":true},"
+                   "\"serverInfo\":{\"name\":\"tiny\"}}",
+                utf8 ? "\"positionEncoding\":\"utf-8\"," : "");
+        sendMessage(ls, m);
+    }
+}
+
+/* didOpen opens the document of params, or opens
+   it again if it is open */
+static void didOpen(LspSession* ls, const Json* params)
+{
+    const Json* document = member(params, "textDocument");
+    const Json* text = member(document, "text");
+    const char* name = stringOf(member(document, "uri"));
+    if ((name == NULL) || (stringOf(text) == NULL)) {
+        return;
+    }
+    LspDocument* d = findDocument(ls, name);
+    if ((d == NULL) && ((d = addDocument(ls, name)) == NULL)) {
+        return;
+    }
+    d->version = numberOf(member(document, "version"), 0);
+    tinyUse(d->context);
+    bool ok = docOpen(text->string, text->length);
+    publish(ls, d, !ok);
+    tinyUse(ls->context);
+    if (!ok) {
+        dropDocument(ls, d);
+    }
+}
+
+/* didChange applies the changes of params */
+static void didChange(LspSession* ls, const Json* params)
+{
+    const Json* document = member(params, "textDocument");
+    LspDocument* d = findDocument(ls, stringOf(member(document, "uri")));
+    const Json* changes = member(params, "contentChanges");
+    if ((d == NULL) || (changes == NULL)) {
+        return;
+    }
+    d->version = numberOf(member(document, "version"), d->version);
+    tinyUse(d->context);
+    bool ok = true;
+    for (const Json* c = changes->child; ok && (c != NULL); c = c->next) {
+        const Json* text = member(c, "text");
+        const Json* range = member(c, "range");
+        if (stringOf(text) == NULL) {
+            continue;
+        }
+        if (range == NULL) {
+            ok = docOpen(text->string, text->length);
+        }
+        else {
+            size_t start = offsetOf(member(range, "start"));
+            size_t end = offsetOf(member(range, "end"));
+            ok = docEdit(start, end, text->string, text->length);
+        }
+    }
+    publish(ls, d, !ok);
+    tinyUse(ls->context);
+    if (!ok) {
+        dropDocument(ls, d);
+    }
+}
+
+/* didClose closes the document of params */
+static void didClose(LspSession* ls, const Json* params)
+{
+    const Json* document = member(params, "textDocument");
+    LspDocument* d = findDocument(ls, stringOf(member(document, "uri")));
+    if (d != NULL) {
+        publish(ls, d, true);
+        dropDocument(ls, d);
+    }
+}
+
+/* references answers a references request */
+static void references(LspSession* ls, const Json* id, const Json* params)
+{
+    const Json* document = member(params, "textDocument");
+    LspDocument* d = findDocument(ls, stringOf(member(document, "uri")));
+    size_t n = 0;
+    const DocPosition* p = NULL;
+    if (d != NULL) {
+        tinyUse(d->context);
+        p = docReferences(offsetOf(member(params, "position")), &n);
+    }
+    FILE* m = beginMessage(ls);
+    if (m != NULL) {
+        writeId(m, id);
+        fprintf(m, ",\"result\":[");
+        for (size_t i = 0; i < n; i++) {
+            fprintf(m, "%s{\"uri\":", (i > 0) ? "," : "");
+            writeString(m, d->uri);
+            fprintf(m,
+                    ",\"range\":{\"start\":{\"line\":%d,\"character\":%zu},"
+                    "\"end\":{\"line\":%d,\"character\":%zu}}}",
+                    p[i].line - 1, p[i].column, p[i].line - 1,
+                    p[i].column + p[i].length);
+        }
+        fprintf(m, "]");
+        sendMessage(ls, m);
+    }
+    tinyUse(ls->context);
+}
+
+/* Function lspServe runs a language server for TINY
+ * over in and out: JSON-RPC messages with
+ * Content-Length headers, as the Language Server
+ * Protocol lays down, until the client sends exit.
+ * Edits are applied through the incremental front
+ * end and answered with fresh diagnostics. Each
+ * open document is kept in a context of its own,
+ * made from the one bound to the thread, so that
+ * servers on threads with contexts of their own
+ * run apart. Returns true if the
+ * client shut the server down first
+ */
+bool lspServe(FILE* in, FILE* out)
+{
+    /* the listing is not wanted: errors go to the
+       client as diagnostics */
+    FILE* quiet = fopen("/dev/null", "w");
+    tiny->listing = (quiet != NULL) ? quiet : stderr;
+    tiny->filePath = "(lsp)";
+    tiny->echoSource = tiny->traceScan = tiny->traceParse = false;
+    tiny->traceAnalyze = tiny->traceCode = false;
+    LspSession session = {.in = in, .out = out, .context = tiny, .utf16 = true};
+    LspSession* ls = &session;
+    bool shutdown = false;
+    size_t size;
+    while (readMessage(ls, &size)) {
+        arenaReset(&ls->json);
+        JsonReader r = {ls->body, ls->body + size, 0, &ls->json};
+        const Json* msg = readValue(&r);
+        if ((msg == NULL) || (msg->kind != JsonObject)) {
+            replyError(ls, NULL, PARSE_ERROR, "Parse error");
+            continue;
+        }
+        const char* method = stringOf(member(msg, "method"));
+        const Json* id = member(msg, "id");
+        const Json* params = member(msg, "params");
+        if (method == NULL) {
+            if (id == NULL) {
+                replyError(ls, NULL, INVALID_REQUEST, "Invalid request");
+            }
+            continue; /* a response: the server asks nothing */
+        }
+        if (strcmp(method, "exit") == 0) {
+            break;
+        }
+        else if (strcmp(method, "initialize") == 0) {
+            initialize(ls, id, params);
+        }
+        else if (strcmp(method, "shutdown") == 0) {
+            FILE* m = beginMessage(ls);
+            if (m != NULL) {
+                writeId(m, id);
+                fprintf(m, ",\"result\":null");
+                sendMessage(ls, m);
+            }
+            shutdown = true;
+        }
+        else if (strcmp(method, "textDocument/didOpen") == 0) {
+            didOpen(ls, params);
+        }
+        else if (strcmp(method, "textDocument/didChange") == 0) {
+            didChange(ls, params);
+        }
+        else if (strcmp(method, "textDocument/didClose") == 0) {
+            didClose(ls, params);
+        }
+        else if (strcmp(method, "textDocument/references") == 0) {
+            references(ls, id, params);
+        }
+        else if (id != NULL) {
+            replyError(ls, id, METHOD_NOT_FOUND, "Method not found");
+        }
+    }
+    while (ls->documentCount > 0) {
+        dropDocument(ls, &ls->documents[0]);
+    }
+    free(ls->documents);
+    free(ls->body);
+    arenaRelease(&ls->json);
+    if (quiet != NULL) {
+        fclose(quiet);
+    }
+    return shutdown;
+}
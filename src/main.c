@@ -7,107 +7,41 @@
 
 #include "include/globals.h"
 
-/* set NO_PARSE to 1 to get a scanner-only compiler */
-#define NO_PARSE false
-/* set NO_ANALYZE to 1 to get a parser-only compiler */
-#define NO_ANALYZE false
-/* set NO_CODE to TRUE to get a compiler that does not
- * generate code
- */
-#define NO_CODE false
-
-#include "include/util.h"
-#if NO_PARSE
-#include "include/scan.h"
-#else
-#include "include/parse.h"
-#if !NO_ANALYZE
-#include "include/analyze.h"
-#if !NO_CODE
-#include "include/cgen.h"
-#endif
-#endif
-#endif
-
-/* allocate global variables */
-int lineno = 0;
-char* filePath;
-FILE* source;
-FILE* listing;
-FILE* code;
-
-/* allocate and set tracing flags */
-bool EchoSource = false;
-bool TraceScan = true;
-bool TraceParse = true;
-bool TraceAnalyze = true;
-bool TraceCode = true;
-
-bool Error = false;
+#include "include/compiler.h"
+#include "include/driver.h"
+#include "include/lsp.h"
+#include "include/server.h"
 
 int main(int argc, char* argv[])
 {
-    if (argc != 2) {
-        fprintf(stderr, "usage: %s <filename.tny>\n", argv[0]);
-        exit(EXIT_FAILURE);
+    if ((argc == 2) && (strcmp(argv[1], "--server") == 0)) {
+        return serverRun() ? EXIT_SUCCESS : EXIT_FAILURE;
     }
-    char pgm[120];
-    strcpy(pgm, argv[1]);
-    if (strchr(pgm, '.') == NULL) {
-        strcat(pgm, ".tny");
+    if ((argc > 1) && (strcmp(argv[1], "--client") == 0)) {
+        /* the rest is a command line of tiny, run by the
+           server if there is one and here if not */
+        argv[1] = argv[0];
+        argc--;
+        argv++;
+        int status = clientRun(argc, argv);
+        if (status >= 0) {
+            return status;
+        }
     }
-    source = fopen(pgm, "r");
-    filePath = pgm;
-    if (source == NULL) {
-        fprintf(stderr, "File %s not found\n", pgm);
+    CommandLine cl;
+    if (!parseCommandLine(&cl, argc, argv, NULL, stderr)) {
         exit(EXIT_FAILURE);
     }
-
-    listing = stdout;
-    fprintf(listing, "\nTINY COMPILATION: %s\n", pgm);
-#if NO_PARSE
-    while (getToken() != ENDFILE) {
-        continue;
-    }
-#else
-    TreeNode* syntaxTree;
-    syntaxTree = parse();
-    if (TraceParse && !Error) {
-        fprintf(listing, "\nSyntax tree:\n");
-        printTree(syntaxTree);
-    }
-#if !NO_ANALYZE
-    if (!Error) {
-        if (TraceAnalyze) {
-            fprintf(listing, "\nBuilding Symbol Table...\n");
-        }
-        buildSymtab(syntaxTree);
-        if (TraceAnalyze) {
-            fprintf(listing, "\nChecking Types...\n");
-        }
-        typeCheck(syntaxTree);
-        if (TraceAnalyze) {
-            fprintf(listing, "\nType Checking Finished\n");
-        }
-    }
-#if !NO_CODE
-    if (!Error) {
-        char* codefile;
-        int fnlen = strcspn(pgm, ".");
-        codefile = (char*)calloc(fnlen + 4, sizeof(char));
-        strncpy(codefile, pgm, fnlen);
-        strcat(codefile, ".tm");
-        code = fopen(codefile, "w");
-        if (code == NULL) {
-            printf("Unable to open %s\n", codefile);
-            exit(1);
+    if (cl.lsp) {
+        /* serve editors over stdin and stdout */
+        tinyUse(tinyNew());
+        if (tiny == NULL) {
+            fprintf(stderr, "Out of memory\n");
+            exit(EXIT_FAILURE);
         }
-        codeGen(syntaxTree, codefile);
-        fclose(code);
+        return lspServe(stdin, stdout) ? EXIT_SUCCESS : EXIT_FAILURE;
     }
-#endif
-#endif
-#endif
-    freeTree(syntaxTree);
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+    int status = runCommandLine(&cl, stdout, stderr, NULL, NULL);
+    freeCommandLine(&cl);
+    return status;
+}
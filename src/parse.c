@@ -5,76 +5,182 @@
 /* Kenneth C. Louden                                */
 /****************************************************/
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+
 #include "include/parse.h"
+#include "include/compiler.h"
+#include "include/ring.h"
 
-static TokenType currentToken; /* holds current token */
+/* RINGSIZE = tokens the scanner thread may run ahead */
+#define RINGSIZE 4096
 
 /* function prototypes for recursive calls */
-static TreeNode* stmt_sequence();
-static TreeNode* statement();
-static TreeNode* if_stmt();
-static TreeNode* repeat_stmt();
-static TreeNode* assign_stmt();
-static TreeNode* read_stmt();
-static TreeNode* write_stmt();
-static TreeNode* while_stmt();
-static TreeNode* expr();
-static TreeNode* simple_exp();
-static TreeNode* term();
-static TreeNode* factor();
+static AstIndex stmt_sequence();
+static AstIndex statement();
+static AstIndex if_stmt();
+static AstIndex repeat_stmt();
+static AstIndex assign_stmt();
+static AstIndex read_stmt();
+static AstIndex write_stmt();
+static AstIndex while_stmt();
+static AstIndex expr();
+static AstIndex simple_exp();
+static AstIndex term();
+static AstIndex factor();
 
 static void syntaxError(char* message)
 {
-    fprintf(listing, "\n>>> Error \n");
-    fprintf(listing, "File \"%s\", line %d\n", filePath, lineno);
-    fprintf(listing, "SyntaxError: %s", message);
-    Error = true;
+    fprintf(tiny->listing, "\n>>> Error \n");
+    fprintf(tiny->listing, "File \"%s\", line %d\n", tiny->filePath,
+            tiny->lineno);
+    fprintf(tiny->listing, "SyntaxError: %s", message);
+    tiny->error = true;
+}
+
+/* scanAhead is the scanner thread of pipeline mode:
+   it feeds the ring up to and including ENDFILE, in
+   the context of the parse, arg */
+static void* scanAhead(void* arg)
+{
+    tinyUse(arg);
+    Token t;
+    do {
+        if (!nextToken(&t)) {
+            tiny->parse.scanFailed = true;
+            t.kind = ENDFILE;
+        }
+        ringPush(tiny->parse.ring, &t);
+    } while (t.kind != ENDFILE);
+    return NULL;
+}
+
+/* loadToken makes token the current token */
+static void loadToken(void)
+{
+    tiny->parse.currentToken = tiny->parse.token.kind;
+    tiny->lineno = tiny->parse.token.line;
+    if (tiny->traceScan) {
+        fprintf(tiny->listing, "\t%d: ", tiny->lineno);
+        printToken(tiny->parse.currentToken, tokenLexeme(&tiny->parse.token));
+    }
+}
+
+/* readToken fetches the next token: from the ring
+   in pipeline mode, from tokenSource in a parse
+   begun by parseBegin, else from the stream */
+static void readToken(void)
+{
+    if (tiny->parse.tokenSource != NULL) {
+        tiny->parse.tokenSource(&tiny->parse.token);
+        return;
+    }
+    if (tiny->parse.ring != NULL) {
+        ringPop(tiny->parse.ring, &tiny->parse.token);
+        return;
+    }
+    size_t i = tiny->parse.tokenPos++;
+    tiny->parse.token.kind = (TokenType)tiny->parse.tokens.kind[i];
+    tiny->parse.token.line = tiny->parse.tokens.line[i];
+    tiny->parse.token.offset = tiny->parse.tokens.offset[i];
+    tiny->parse.token.length = tiny->parse.tokens.length[i];
+    tiny->parse.token.value = tiny->parse.tokens.value[i];
+}
+
+/* advance moves to the next token; reading past
+   ENDFILE keeps returning ENDFILE on a new line,
+   as the scanner does */
+static void advance(void)
+{
+    if (tiny->parse.token.kind == ENDFILE) {
+        tiny->parse.token.line++;
+    }
+    else {
+        readToken();
+    }
+    loadToken();
+}
+
+/* unexpected reports currentToken as a syntax error */
+static void unexpected(char* message)
+{
+    syntaxError(message);
+    const char* lexeme = tokenLexeme(&tiny->parse.token);
+    printToken(tiny->parse.currentToken, lexeme);
+    fprintf(tiny->listing, "\n");
+    diagnostic(tiny->lineno, message,
+               (tiny->parse.currentToken == ENDFILE) ? "EOF" : lexeme);
+}
+
+/* codeEndsEarly reports currentToken as ending the
+   statement sequence of the program before ENDFILE */
+static void codeEndsEarly(void)
+{
+    syntaxError("Code ends before file\n");
+    fprintf(tiny->listing, "\n");
+    diagnostic(tiny->lineno, "Code ends before file", "");
 }
 
 static void match(TokenType expected)
 {
-    if (currentToken == expected) {
-        currentToken = getToken();
+    if (tiny->parse.currentToken == expected) {
+        advance();
     }
     else {
-        syntaxError("Unexpected token -> ");
-        printToken(currentToken, tokenString);
-        fprintf(listing, "\n");
+        unexpected("Unexpected token -> ");
     }
 }
 
+/* NOINLINE keeps a function out of its callers:
+   the frames of the recursive descent bound the
+   nesting it can parse, and isEnd inlined would
+   keep the address of tiny in a register of each */
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((noinline))
+#else
+#define NOINLINE
+#endif
+
 // Check if `currentToken` is end of a statement.
-static bool isEnd()
+NOINLINE static bool isEnd()
 {
-    return (currentToken == ENDFILE) || (currentToken == ENDIF) ||
-           (currentToken == ELSE) || (currentToken == UNTIL) ||
-           (currentToken == ENDWHILE);
+    TokenType t = tiny->parse.currentToken;
+    return (t == ENDFILE) || (t == ENDIF) || (t == ELSE) || (t == UNTIL) ||
+           (t == ENDWHILE);
 }
 
-TreeNode* stmt_sequence()
+AstIndex stmt_sequence()
 {
-    TreeNode* t = statement();
-    TreeNode* p = t;
+    AstIndex seq = astSeq();
+    AstIndex p = statement();
+    if (p != AST_NULL) {
+        astAddChild(seq, p);
+    }
     while (!isEnd()) {
-        TreeNode* q;
-        q = statement();
-        if (q != NULL) {
-            if (t == NULL) {
-                t = p = q;
+        AstIndex q = statement();
+        if (q != AST_NULL) {
+            if (p == AST_NULL) {
+                astAddChild(seq, q);
             }
             else {
-                p->sibling = q;
-                p = q;
+                astAddSibling(p, q);
             }
+            p = q;
         }
     }
-    return t;
+    return seq;
 }
 
-TreeNode* statement()
+AstIndex statement()
 {
-    TreeNode* t = NULL;
-    switch (currentToken) {
+    AstIndex t = AST_NULL;
+    StatementSource kept = tiny->parse.keptSource;
+    if ((kept != NULL) && ((t = kept()) != AST_NULL)) {
+        advance();
+        return t;
+    }
+    switch (tiny->parse.currentToken) {
     case IF:
         t = if_stmt();
         break;
@@ -94,168 +200,164 @@ TreeNode* statement()
         t = while_stmt();
         break;
     default:
-        syntaxError("Unexpected token (statement) -> ");
-        printToken(currentToken, tokenString);
-        fprintf(listing, "\n");
-        currentToken = getToken();
+        unexpected("Unexpected token (statement) -> ");
+        advance();
         break;
     } /* end case */
     return t;
 }
 
-TreeNode* if_stmt()
+AstIndex if_stmt()
 {
-    TreeNode* stmt = newStmtNode(IfK);
+    AstIndex stmt = astStmt(IfK);
     match(IF);
-    if (stmt != NULL) {
-        stmt->child[0] = expr();
+    if (stmt != AST_NULL) {
+        astAddChild(stmt, expr());
     }
     match(THEN);
-    if (stmt != NULL) {
-        stmt->child[1] = stmt_sequence();
+    if (stmt != AST_NULL) {
+        astAddChild(stmt, stmt_sequence());
     }
-    if (currentToken == ELSE) {
+    if (tiny->parse.currentToken == ELSE) {
         match(ELSE);
-        if (stmt != NULL) {
-            stmt->child[2] = stmt_sequence();
+        if (stmt != AST_NULL) {
+            astAddChild(stmt, stmt_sequence());
         }
     }
     match(ENDIF);
     return stmt;
 }
 
-TreeNode* repeat_stmt()
+AstIndex repeat_stmt()
 {
-    TreeNode* stmt = newStmtNode(RepeatK);
-    if (stmt == NULL) {
+    AstIndex stmt = astStmt(RepeatK);
+    if (stmt == AST_NULL) {
         match(REPEAT);
         match(UNTIL);
-        return NULL;
+        return AST_NULL;
     }
     match(REPEAT);
-    stmt->child[0] = stmt_sequence();
+    astAddChild(stmt, stmt_sequence());
     match(UNTIL);
-    stmt->child[1] = expr();
+    astAddChild(stmt, expr());
     match(SEMI);
     return stmt;
 }
 
-TreeNode* while_stmt()
+AstIndex while_stmt()
 {
-    TreeNode* stmt = newStmtNode(WhileK);
+    AstIndex stmt = astStmt(WhileK);
     match(WHILE);
-    if (stmt != NULL) {
-        stmt->child[0] = expr();
-        stmt->child[1] = stmt_sequence();
+    if (stmt != AST_NULL) {
+        astAddChild(stmt, expr());
+        astAddChild(stmt, stmt_sequence());
     }
     match(ENDWHILE);
     return stmt;
 }
 
-TreeNode* assign_stmt()
+AstIndex assign_stmt()
 {
-    TreeNode* stmt = newStmtNode(AssignK);
-    if ((stmt != NULL) && (currentToken == ID)) {
-        stmt->attr.name = copyString(tokenString);
+    AstIndex stmt = astStmt(AssignK);
+    if (tiny->parse.currentToken == ID) {
+        astSetValue(stmt, tiny->parse.token.value);
     }
     match(ID);
     match(ASSIGN);
-    if (stmt != NULL) {
-        stmt->child[0] = expr();
+    if (stmt != AST_NULL) {
+        astAddChild(stmt, expr());
     }
     match(SEMI);
     return stmt;
 }
 
-TreeNode* read_stmt()
+AstIndex read_stmt()
 {
-    TreeNode* stmt = newStmtNode(ReadK);
+    AstIndex stmt = astStmt(ReadK);
     match(READ);
-    if ((stmt != NULL) && (currentToken == ID)) {
-        stmt->attr.name = copyString(tokenString);
+    if (tiny->parse.currentToken == ID) {
+        astSetValue(stmt, tiny->parse.token.value);
     }
     match(ID);
     match(SEMI);
     return stmt;
 }
 
-TreeNode* write_stmt()
+AstIndex write_stmt()
 {
-    TreeNode* stmt = newStmtNode(WriteK);
+    AstIndex stmt = astStmt(WriteK);
     match(WRITE);
-    if (stmt != NULL) {
-        stmt->child[0] = expr();
+    if (stmt != AST_NULL) {
+        astAddChild(stmt, expr());
     }
     match(SEMI);
     return stmt;
 }
 
-TreeNode* expr()
+AstIndex expr()
 {
-    TreeNode* ex = simple_exp();
-    if ((currentToken == LT) || (currentToken == EQ)) {
-        TreeNode* op = newExpNode(OpK);
-        if (op != NULL) {
-            op->child[0] = ex;
-            op->attr.op = currentToken;
+    AstIndex ex = simple_exp();
+    if ((tiny->parse.currentToken == LT) || (tiny->parse.currentToken == EQ)) {
+        AstIndex op = astExp(OpK);
+        if (op != AST_NULL) {
+            astAddChild(op, ex);
+            astSetValue(op, tiny->parse.currentToken);
             ex = op;
         }
-        match(currentToken);
-        if (ex != NULL) {
-            ex->child[1] = simple_exp();
+        match(tiny->parse.currentToken);
+        if (ex != AST_NULL) {
+            astAddChild(ex, simple_exp());
         }
     }
     return ex;
 }
 
-TreeNode* simple_exp()
+AstIndex simple_exp()
 {
-    TreeNode* t = term();
-    while ((currentToken == PLUS) || (currentToken == MINUS)) {
-        TreeNode* p = newExpNode(OpK);
-        if (p != NULL) {
-            p->child[0] = t;
-            p->attr.op = currentToken;
+    AstIndex t = term();
+    while ((tiny->parse.currentToken == PLUS) ||
+           (tiny->parse.currentToken == MINUS)) {
+        AstIndex p = astExp(OpK);
+        if (p != AST_NULL) {
+            astAddChild(p, t);
+            astSetValue(p, tiny->parse.currentToken);
             t = p;
-            match(currentToken);
-            t->child[1] = term();
+            match(tiny->parse.currentToken);
+            astAddChild(t, term());
         }
     }
     return t;
 }
 
-TreeNode* term()
+AstIndex term()
 {
-    TreeNode* f = factor();
-    while ((currentToken == TIMES) || (currentToken == OVER)) {
-        TreeNode* p = newExpNode(OpK);
-        if (p != NULL) {
-            p->child[0] = f;
-            p->attr.op = currentToken;
+    AstIndex f = factor();
+    while ((tiny->parse.currentToken == TIMES) ||
+           (tiny->parse.currentToken == OVER)) {
+        AstIndex p = astExp(OpK);
+        if (p != AST_NULL) {
+            astAddChild(p, f);
+            astSetValue(p, tiny->parse.currentToken);
             f = p;
-            match(currentToken);
-            p->child[1] = factor();
+            match(tiny->parse.currentToken);
+            astAddChild(p, factor());
         }
     }
     return f;
 }
 
-TreeNode* factor()
+AstIndex factor()
 {
-    TreeNode* t = NULL;
-    switch (currentToken) {
+    AstIndex t = AST_NULL;
+    switch (tiny->parse.currentToken) {
     case NUM:
-        t = newExpNode(ConstK);
-        if ((t != NULL) && (currentToken == NUM)) {
-            t->attr.val = atoi(tokenString);
-        }
+        t = astExp(ConstK);
+        astSetValue(t, tiny->parse.token.value);
         match(NUM);
         break;
     case ID:
-        t = newExpNode(IdK);
-        if ((t != NULL) && (currentToken == ID)) {
-            t->attr.name = copyString(tokenString);
-        }
+        t = astExp(IdK);
+        astSetValue(t, tiny->parse.token.value);
         match(ID);
         break;
     case LPAREN:
@@ -264,29 +366,481 @@ TreeNode* factor()
         match(RPAREN);
         break;
     default:
-        syntaxError("unexpected token -> ");
-        printToken(currentToken, tokenString);
-        fprintf(listing, "\n");
-        currentToken = getToken();
+        unexpected("unexpected token -> ");
+        advance();
         break;
     }
     return t;
 }
 
+/****************************************/
+/* the explicit stack parser            */
+/****************************************/
+/* The stack parser accepts the same language,
+ * reports the same errors and builds the same tree
+ * as the recursive descent parser above, but keeps
+ * its state in growable arrays instead of on the C
+ * stack, so nesting depth is bounded only by memory.
+ * Statements are parsed LL(1): the current token
+ * selects a production from stmtTable, whose
+ * symbols are pushed on the parse stack. Expressions
+ * are parsed by operator precedence.
+ */
+
+/* parse stack symbols: a TokenType is a terminal to
+   match; the others are nonterminals and actions */
+typedef enum {
+    SYM_SEQ = 64, /* a statement sequence */
+    SYM_SEQ_NEXT, /* attach a statement, parse another */
+    SYM_STMT,     /* a statement */
+    SYM_EXPR,     /* an expression */
+    SYM_ELSE,     /* an optional else part */
+    SYM_ADD,      /* make a value the last child of the node below it */
+    SYM_NAME,     /* an identifier names the node on top */
+    SYM_SKIP,     /* report a token that cannot start a statement */
+    SYM_END,      /* ends a production */
+    SYM_NEW = 96  /* SYM_NEW + k starts a statement node of kind k */
+} ParseSymbol;
+
+/* the LL(1) productions of the statements */
+static const unsigned short ifProduction[] = {
+    SYM_NEW + IfK, IF,      SYM_EXPR, SYM_ADD, THEN,
+    SYM_SEQ,       SYM_ADD, SYM_ELSE, ENDIF,   SYM_END};
+static const unsigned short repeatProduction[] = {
+    SYM_NEW + RepeatK, REPEAT,  SYM_SEQ, SYM_ADD, UNTIL,
+    SYM_EXPR,          SYM_ADD, SEMI,    SYM_END};
+static const unsigned short assignProduction[] = {
+    SYM_NEW + AssignK, SYM_NAME, ID,   ASSIGN,
+    SYM_EXPR,          SYM_ADD,  SEMI, SYM_END};
+static const unsigned short readProduction[] = {
+    SYM_NEW + ReadK, READ, SYM_NAME, ID, SEMI, SYM_END};
+static const unsigned short writeProduction[] = {
+    SYM_NEW + WriteK, WRITE, SYM_EXPR, SYM_ADD, SEMI, SYM_END};
+static const unsigned short whileProduction[] = {
+    SYM_NEW + WhileK, WHILE, SYM_EXPR, SYM_ADD,
+    SYM_SEQ,          SYM_ADD, ENDWHILE, SYM_END};
+static const unsigned short errorProduction[] = {SYM_SKIP, SYM_END};
+
+/* NTOKENS = the number of token types */
+#define NTOKENS (DDOT + 1)
+
+/* stmtTable selects the production of a statement
+   by its first token */
+static const unsigned short* const stmtTable[NTOKENS] = {
+    [IF] = ifProduction,       [REPEAT] = repeatProduction,
+    [ID] = assignProduction,   [READ] = readProduction,
+    [WRITE] = writeProduction, [WHILE] = whileProduction,
+};
+
+/* the else part of an if statement */
+static const unsigned short elseProduction[] = {ELSE, SYM_SEQ, SYM_ADD,
+                                                SYM_END};
+
+/* push adds item to the top of stack */
+static bool push(Stack* stack, uint32_t item)
+{
+    if (stack->count == stack->capacity) {
+        size_t cap = (stack->capacity == 0) ? 256 : 2 * stack->capacity;
+        uint32_t* items = realloc(stack->items, cap * sizeof(uint32_t));
+        if (items == NULL) {
+            fprintf(tiny->listing, "Out of memory error at line %d\n",
+                    tiny->lineno);
+            tiny->error = true;
+            return false;
+        }
+        stack->items = items;
+        stack->capacity = cap;
+    }
+    stack->items[stack->count++] = item;
+    return true;
+}
+
+static uint32_t pop(Stack* stack) { return stack->items[--stack->count]; }
+
+static uint32_t* top(Stack* stack) { return &stack->items[stack->count - 1]; }
+
+/* pushProduction pushes the symbols of a production
+   so that its first symbol is on top */
+static bool pushProduction(const unsigned short* production)
+{
+    size_t n = 0;
+    while (production[n] != SYM_END) {
+        n++;
+    }
+    while (n > 0) {
+        if (!push(&tiny->parse.symbols, production[--n])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* an entry of ops is an operator node shifted left
+   by 2 with its level in the low bits, or a mark
+   opening a parenthesized expression */
+#define OP_ENTRY(node, level) (((node) << 2) | (uint32_t)(level))
+#define OP_NODE(entry) ((entry) >> 2)
+#define OP_LEVEL(entry) ((entry)&3)
+/* MARK opens an expression; MARK_CMP after one
+   comparison has been seen in it */
+#define MARK 3
+#define MARK_CMP 7
+
+/* opLevel returns the precedence level of tok as a
+   binary operator, or -1 */
+static int opLevel(TokenType tok)
+{
+    switch (tok) {
+    case LT:
+    case EQ:
+        return 0;
+    case PLUS:
+    case MINUS:
+        return 1;
+    case TIMES:
+    case OVER:
+        return 2;
+    default:
+        return -1;
+    }
+}
+
+/* reduce completes pending operators of level at
+   least level, each taking the value on top as its
+   right operand */
+static void reduce(int level)
+{
+    ParseState* ps = &tiny->parse;
+    while ((ps->ops.count > 0) && (*top(&ps->ops) != MARK) &&
+           (*top(&ps->ops) != MARK_CMP) &&
+           ((int)OP_LEVEL(*top(&ps->ops)) >= level)) {
+        AstIndex op = OP_NODE(pop(&ps->ops));
+        astAddChild(op, pop(&ps->values));
+        push(&ps->values, op);
+    }
+}
+
+/* stackExpression parses an expression by operator
+   precedence and pushes its tree on values */
+static bool stackExpression(void)
+{
+    ParseState* ps = &tiny->parse;
+    size_t base = ps->ops.count;
+    if (!push(&ps->ops, MARK)) {
+        return false;
+    }
+    while (ps->ops.count > base) {
+        /* an operand, after any open parentheses */
+        while (ps->currentToken == LPAREN) {
+            match(LPAREN);
+            if (!push(&ps->ops, MARK)) {
+                return false;
+            }
+        }
+        AstIndex t = AST_NULL;
+        switch (ps->currentToken) {
+        case NUM:
+            t = astExp(ConstK);
+            astSetValue(t, ps->token.value);
+            match(NUM);
+            break;
+        case ID:
+            t = astExp(IdK);
+            astSetValue(t, ps->token.value);
+            match(ID);
+            break;
+        default:
+            unexpected("unexpected token -> ");
+            advance();
+            break;
+        }
+        if (!push(&ps->values, t)) {
+            return false;
+        }
+        /* then operators, or the end of expressions */
+        while (ps->ops.count > base) {
+            int level = opLevel(ps->currentToken);
+            size_t mark = ps->ops.count - 1;
+            while ((ps->ops.items[mark] != MARK) &&
+                   (ps->ops.items[mark] != MARK_CMP)) {
+                mark--;
+            }
+            /* a comparison does not associate */
+            if ((level == 0) && (ps->ops.items[mark] == MARK_CMP)) {
+                level = -1;
+            }
+            if (level >= 0) {
+                reduce(level);
+                AstIndex op = astExp(OpK);
+                if (op != AST_NULL) {
+                    astAddChild(op, pop(&ps->values));
+                    astSetValue(op, ps->currentToken);
+                }
+                if (level == 0) {
+                    ps->ops.items[mark] = MARK_CMP;
+                }
+                match(ps->currentToken);
+                if (!push(&ps->ops, OP_ENTRY(op, level))) {
+                    return false;
+                }
+                break;
+            }
+            reduce(0);
+            ps->ops.count--; /* the mark */
+            if (ps->ops.count > base) {
+                match(RPAREN);
+            }
+        }
+    }
+    return true;
+}
+
+/* stackRun parses start, a statement sequence or a
+   statement, with the explicit stacks and returns
+   its tree. Each statement, at any depth, is first
+   asked of keptSource, as statement does */
+static AstIndex stackRun(ParseSymbol start)
+{
+    ParseState* ps = &tiny->parse;
+    ps->symbols.count = ps->values.count = ps->ops.count = 0;
+    bool ok = push(&ps->symbols, start);
+    while (ok && (ps->symbols.count > 0)) {
+        uint32_t sym = pop(&ps->symbols);
+        AstIndex t;
+        if (sym < SYM_SEQ) {
+            match((TokenType)sym);
+            continue;
+        }
+        switch (sym) {
+        case SYM_SEQ:
+            /* values: the sequence, its last statement */
+            ok = push(&ps->values, astSeq()) && push(&ps->values, AST_NULL) &&
+                 push(&ps->symbols, SYM_SEQ_NEXT) &&
+                 push(&ps->symbols, SYM_STMT);
+            break;
+        case SYM_SEQ_NEXT:
+            t = pop(&ps->values);
+            if (t != AST_NULL) {
+                AstIndex last = *top(&ps->values);
+                if (last == AST_NULL) {
+                    astAddChild(ps->values.items[ps->values.count - 2], t);
+                }
+                else {
+                    astAddSibling(last, t);
+                }
+                *top(&ps->values) = t;
+            }
+            if (isEnd()) {
+                ps->values.count--; /* the sequence is the value */
+            }
+            else {
+                ok = push(&ps->symbols, SYM_SEQ_NEXT) &&
+                     push(&ps->symbols, SYM_STMT);
+            }
+            break;
+        case SYM_STMT:
+            if ((ps->keptSource != NULL) &&
+                ((t = ps->keptSource()) != AST_NULL)) {
+                advance();
+                ok = push(&ps->values, t);
+            }
+            else if (stmtTable[ps->currentToken] != NULL) {
+                ok = pushProduction(stmtTable[ps->currentToken]);
+            }
+            else {
+                ok = pushProduction(errorProduction);
+            }
+            break;
+        case SYM_SKIP:
+            unexpected("Unexpected token (statement) -> ");
+            advance();
+            ok = push(&ps->values, AST_NULL);
+            break;
+        case SYM_EXPR:
+            ok = stackExpression();
+            break;
+        case SYM_ELSE:
+            if (ps->currentToken == ELSE) {
+                ok = pushProduction(elseProduction);
+            }
+            break;
+        case SYM_ADD:
+            t = pop(&ps->values);
+            astAddChild(*top(&ps->values), t);
+            break;
+        case SYM_NAME:
+            if (ps->currentToken == ID) {
+                astSetValue(*top(&ps->values), ps->token.value);
+            }
+            break;
+        default: /* SYM_NEW + kind */
+            ok = push(&ps->values, astStmt((StmtKind)(sym - SYM_NEW)));
+            break;
+        }
+    }
+    return (ok && (ps->values.count > 0)) ? ps->values.items[0] : AST_NULL;
+}
+
+/* freeStacks lets go of the explicit stacks */
+static void freeStacks(void)
+{
+    ParseState* ps = &tiny->parse;
+    free(ps->symbols.items);
+    free(ps->values.items);
+    free(ps->ops.items);
+    ps->symbols = ps->values = ps->ops = (Stack){NULL, 0, 0};
+}
+
+/* stackParse parses a statement sequence with the
+   explicit stacks and returns its tree */
+static AstIndex stackParse(void)
+{
+    AstIndex t = stackRun(SYM_SEQ);
+    freeStacks();
+    return t;
+}
+
+/* topStatement parses a top level statement with
+   the parser tiny->stackParse selects; the stacks
+   are kept for the next until parseEnd */
+static AstIndex topStatement(void)
+{
+    return tiny->stackParse ? stackRun(SYM_STMT) : statement();
+}
+
 /****************************************/
 /* the primary function of the parser   */
 /****************************************/
 /* Function parse returns the newly
- * constructed syntax tree
+ * constructed syntax tree: the statement
+ * sequence of the program
  */
-TreeNode* parse()
+AstIndex parse()
 {
-    TreeNode* t;
-    currentToken = getToken();
-    t = stmt_sequence();
-    if (currentToken != ENDFILE) {
-        syntaxError("Code ends before file\n");
-        fprintf(listing, "\n");
+    ParseState* ps = &tiny->parse;
+    AstIndex t;
+    /* source echo stays with the serial scanner, to
+       keep the listing in order */
+    if (tiny->pipelineParse && !tiny->echoSource) {
+        ps->ring = newTokenRing(RINGSIZE);
+        ps->scanFailed = false;
+        if ((ps->ring != NULL) &&
+            (pthread_create(&ps->scanner, NULL, scanAhead, tiny) != 0)) {
+            freeTokenRing(ps->ring);
+            ps->ring = NULL;
+        }
+    }
+    if ((ps->ring == NULL) &&
+        !tokenizeParallel(&ps->tokens, tiny->lexThreads)) {
+        fprintf(tiny->listing, "Out of memory error at line %d\n",
+                tiny->lineno);
+        tiny->error = true;
+        freeTokenStream(&ps->tokens);
+        return AST_NULL;
+    }
+    ps->tokenPos = 0;
+    readToken();
+    loadToken();
+    t = tiny->stackParse ? stackParse() : stmt_sequence();
+    if (ps->currentToken != ENDFILE) {
+        codeEndsEarly();
     }
+    if (ps->ring != NULL) {
+        /* let the scanner thread run to ENDFILE */
+        while (ps->token.kind != ENDFILE) {
+            ringPop(ps->ring, &ps->token);
+        }
+        pthread_join(ps->scanner, NULL);
+        freeTokenRing(ps->ring);
+        ps->ring = NULL;
+        if (ps->scanFailed) {
+            fprintf(tiny->listing, "Out of memory error at line %d\n",
+                    tiny->lineno);
+            tiny->error = true;
+        }
+    }
+    freeTokenStream(&ps->tokens);
     return t;
-}
\ No newline at end of file
+}
+
+/****************************************/
+/* the statement at a time parser       */
+/****************************************/
+/* Procedure parseBegin starts a parse of the tokens
+ * handed out by from, to be taken one top level
+ * statement at a time by parseNext. Each statement,
+ * at any depth, is first asked of kept, which may
+ * be NULL. With stackParse set the statements are
+ * parsed with the explicit stacks, as parse does
+ */
+void parseBegin(TokenSource from, StatementSource kept)
+{
+    tiny->parse.tokenSource = from;
+    tiny->parse.keptSource = kept;
+    readToken();
+    loadToken();
+}
+
+/* Function parseNext parses the next top level
+ * statement of the parse begun by parseBegin into
+ * *stmt, as the statement sequence of a program is
+ * parsed: the first statement is always parsed,
+ * later ones only up to a token that closes a
+ * sequence. Such a stray token is reported as parse
+ * reports it, then skipped so that the statements
+ * after it are parsed too; *stray tells when that
+ * happened. Returns false, parsing nothing, once
+ * only ENDFILE is left
+ */
+bool parseNext(bool first, AstIndex* stmt, bool* stray)
+{
+    *stmt = AST_NULL;
+    *stray = false;
+    if (first) {
+        *stmt = topStatement();
+    }
+    else if (tiny->parse.currentToken == ENDFILE) {
+        return false;
+    }
+    else if (isEnd()) {
+        codeEndsEarly();
+        advance();
+        *stray = true;
+    }
+    else {
+        *stmt = topStatement();
+    }
+    return true;
+}
+
+/* Function parseStatement parses the next top level
+ * statement of the parse begun by parseBegin into
+ * *stmt, exactly as parse does: the first statement
+ * is always parsed, later ones up to a token that
+ * closes a sequence. That token ends the program and
+ * is reported as parse reports it unless it is
+ * ENDFILE. Returns false, parsing nothing, once the
+ * program has ended
+ */
+bool parseStatement(bool first, AstIndex* stmt)
+{
+    *stmt = AST_NULL;
+    if (!first && isEnd()) {
+        if (tiny->parse.currentToken != ENDFILE) {
+            codeEndsEarly();
+        }
+        return false;
+    }
+    *stmt = topStatement();
+    return true;
+}
+
+/* Procedure parseEnd ends the parse begun by
+ * parseBegin
+ */
+void parseEnd(void)
+{
+    tiny->parse.tokenSource = NULL;
+    tiny->parse.keptSource = NULL;
+    freeStacks();
+}
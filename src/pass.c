@@ -0,0 +1,131 @@
+/****************************************************/
+/* File: pass.c                                     */
+/* Pass manager implementation                      */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#include "include/pass.h"
+#include "include/compiler.h"
+
+/* enterAll calls the enter hooks of the walk */
+static bool enterAll(WalkFrame* frame, size_t depth)
+{
+    PassState* ps = &tiny->pass;
+    bool down = true;
+    for (int i = ps->first; i < ps->last; i++) {
+        const Pass* p = ps->passes[i];
+        if ((p->enter != NULL) && !p->enter(frame, depth)) {
+            down = false;
+        }
+    }
+    return down;
+}
+
+/* betweenAll calls the between hooks of the walk */
+static void betweenAll(WalkFrame* frame)
+{
+    PassState* ps = &tiny->pass;
+    for (int i = ps->first; i < ps->last; i++) {
+        if (ps->passes[i]->between != NULL) {
+            ps->passes[i]->between(frame);
+        }
+    }
+}
+
+/* leaveAll calls the leave hooks of the walk */
+static void leaveAll(WalkFrame* frame)
+{
+    PassState* ps = &tiny->pass;
+    for (int i = ps->first; i < ps->last; i++) {
+        if (ps->passes[i]->leave != NULL) {
+            ps->passes[i]->leave(frame);
+        }
+    }
+}
+
+/* walkAll walks one statement for every pass of the
+   walk */
+static void walkAll(TreeNode* tree)
+{
+    walkTree(tree, enterAll, betweenAll, leaveAll);
+}
+
+/* walkOne walks one statement for a walk with a
+   single pass */
+static void walkOne(TreeNode* tree)
+{
+    PassState* ps = &tiny->pass;
+    const Pass* p = ps->passes[ps->first];
+    walkTree(tree, p->enter, p->between, p->leave);
+}
+
+/* joins tells whether passes[i] can share the walk
+   of passes[first] up to passes[i - 1] */
+static bool joins(int i)
+{
+    PassState* ps = &tiny->pass;
+    if (ps->passes[i]->alone || ps->passes[ps->first]->alone) {
+        return false;
+    }
+    for (int k = ps->first; k < i; k++) {
+        if (ps->passes[i]->needs & (1u << k)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Function passAdd adds pass, to run after those
+ * added before it. Returns its number, for the needs
+ * of later passes, or -1 if there are MAXPASSES
+ * already or it needs a pass not added yet
+ */
+int passAdd(const Pass* pass)
+{
+    PassState* ps = &tiny->pass;
+    if ((ps->passCount == MAXPASSES) || ((pass->needs >> ps->passCount) != 0)) {
+        return -1;
+    }
+    ps->passes[ps->passCount] = pass;
+    return ps->passCount++;
+}
+
+/* Function passRun runs the passes added over each
+ * statement of tree, in as few walks as their needs
+ * allow: consecutive passes share a walk unless one
+ * of them is alone or needs another pass of the
+ * walk. At each node the passes of a walk are called
+ * in the order they were added, and so are their
+ * start hooks before the walk and their finish hooks
+ * after it. No walk starts once an error has been
+ * reported. Returns the number of walks made
+ */
+int passRun(AstIndex tree)
+{
+    PassState* ps = &tiny->pass;
+    int walks = 0;
+    for (ps->first = 0; (ps->first < ps->passCount) && !tiny->error;
+         ps->first = ps->last) {
+        ps->last = ps->first + 1;
+        while ((ps->last < ps->passCount) && joins(ps->last)) {
+            ps->last++;
+        }
+        for (int i = ps->first; i < ps->last; i++) {
+            if (ps->passes[i]->start != NULL) {
+                ps->passes[i]->start();
+            }
+        }
+        astForEachStatement(tree,
+                            (ps->last - ps->first == 1) ? walkOne : walkAll);
+        for (int i = ps->first; i < ps->last; i++) {
+            if (ps->passes[i]->finish != NULL) {
+                ps->passes[i]->finish();
+            }
+        }
+        walks++;
+    }
+    return walks;
+}
+
+/* Procedure passClear removes every pass added */
+void passClear(void) { tiny->pass.passCount = 0; }
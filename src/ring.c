@@ -0,0 +1,114 @@
+/****************************************************/
+/* File: ring.c                                     */
+/* Single-producer/single-consumer token ring for   */
+/* the pipelined TINY scanner and parser: a         */
+/* lock-free circular buffer with one index owned   */
+/* by each side                                     */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "include/ring.h"
+
+/* CACHELINE keeps the indices of the two sides on
+   separate cache lines */
+#define CACHELINE 64
+
+/* SPINS = polls of the other side before a waiting
+   thread gives up its time slice */
+#define SPINS 64
+
+struct TokenRing {
+    /* written by the consumer */
+    alignas(CACHELINE) atomic_size_t head; /* next token to pop */
+    size_t tailSeen; /* last tail read by the consumer */
+    /* written by the producer */
+    alignas(CACHELINE) atomic_size_t tail; /* next free slot */
+    size_t headSeen; /* last head read by the producer */
+    /* read only */
+    alignas(CACHELINE) size_t mask; /* capacity - 1 */
+    Token* slots;
+};
+
+/* Function newTokenRing allocates a ring holding up
+ * to capacity tokens, rounded up to a power of two.
+ * Returns NULL if memory runs out
+ */
+TokenRing* newTokenRing(size_t capacity)
+{
+    size_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+    TokenRing* ring = aligned_alloc(CACHELINE, sizeof(TokenRing));
+    if (ring == NULL) {
+        return NULL;
+    }
+    ring->slots = malloc(size * sizeof(Token));
+    if (ring->slots == NULL) {
+        free(ring);
+        return NULL;
+    }
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->tailSeen = ring->headSeen = 0;
+    ring->mask = size - 1;
+    return ring;
+}
+
+/* Procedure ringPush appends tok to the ring. Only
+ * one thread may push; it waits while the ring is
+ * full
+ */
+void ringPush(TokenRing* ring, const Token* tok)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    int spins = 0;
+    /* the cached head is re-read only when the ring
+       looks full */
+    while (tail - ring->headSeen > ring->mask) {
+        ring->headSeen =
+            atomic_load_explicit(&ring->head, memory_order_acquire);
+        if ((tail - ring->headSeen > ring->mask) && (++spins >= SPINS)) {
+            sched_yield();
+            spins = 0;
+        }
+    }
+    ring->slots[tail & ring->mask] = *tok;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+/* Procedure ringPop removes the oldest token of the
+ * ring into tok. Only one thread may pop; it waits
+ * while the ring is empty
+ */
+void ringPop(TokenRing* ring, Token* tok)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    int spins = 0;
+    /* the cached tail is re-read only when the ring
+       looks empty */
+    while (head == ring->tailSeen) {
+        ring->tailSeen =
+            atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if ((head == ring->tailSeen) && (++spins >= SPINS)) {
+            sched_yield();
+            spins = 0;
+        }
+    }
+    *tok = ring->slots[head & ring->mask];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/* Procedure freeTokenRing frees the ring */
+void freeTokenRing(TokenRing* ring)
+{
+    if (ring != NULL) {
+        free(ring->slots);
+        free(ring);
+    }
+}
@@ -6,224 +6,591 @@
 /****************************************************/
 
 #include "include/scan.h"
+#include "include/compiler.h"
+#include "include/scandfa.h"
+#include "include/scansimd.h"
+#include "include/threadpool.h"
 
-/* states in scanner DFA */
-typedef enum { START, INASSIGN, INCOMMENT, INNUM, INID, DONE } StateType;
+/* charClass, scanTable and keywordTable */
+#include "scantab.h"
 
-/* lexeme of identifier or reserved word */
-char tokenString[MAXTOKENLEN + 1]; // Problem with -Wstringop-overflow
-
-/* BUFLEN = length of the input buffer for
-   source code lines */
-#define BUFLEN 256
-
-static char lineBuf[BUFLEN];  /* holds the current line */
-static size_t linepos = 0;    /* current position in LineBuf */
-static size_t bufsize = 0;    /* current size of buffer string */
-static bool EOF_flag = false; /* corrects ungetNextChar behavior on EOF */
+/* echoLine prints the line starting at p
+   to the listing file */
+static void echoLine(const char* p, int line)
+{
+    const char* end = memchr(p, '\n', (size_t)(tiny->scan.bufEnd - p));
+    end = (end == NULL) ? tiny->scan.bufEnd : end + 1;
+    fprintf(tiny->listing, "%4d: %.*s", line, (int)(end - p), p);
+}
 
-/* getNextChar fetches the next non-blank character
-   from lineBuf, reading in a new line if lineBuf is
-   exhausted */
-static int getNextChar(void)
+/* echoNewLines echoes every line that starts
+   after a newline in [from, to) */
+static void echoNewLines(const char* from, const char* to, int line)
 {
-    if (!(linepos < bufsize)) {
-        lineno++;
-        if (fgets(lineBuf, BUFLEN - 1, source)) {
-            if (EchoSource) {
-                fprintf(listing, "%4d: %s", lineno, lineBuf);
-            }
-            bufsize = strlen(lineBuf);
-            linepos = 0;
-            return lineBuf[linepos++];
+    const char* nl;
+    while ((nl = memchr(from, '\n', (size_t)(to - from))) != NULL) {
+        from = nl + 1;
+        line++;
+        if (from != tiny->scan.bufEnd) {
+            echoLine(from, line);
         }
-        EOF_flag = true;
-        return EOF;
     }
-    return lineBuf[linepos++];
 }
 
-/* ungetNextChar backtracks one character
-   in lineBuf */
-static void ungetNextChar(void)
+/* Procedure initScannerText positions the scanner at
+ * the start of size bytes of data. data[size] must
+ * be '\0', and data must outlive the scan
+ */
+void initScannerText(const char* data, size_t size)
 {
-    if (!EOF_flag) {
-        linepos--;
+    tiny->scan.text = data;
+    tiny->scan.bufEnd = data + size;
+    tiny->scan.endsWithNewline = (size == 0) || (data[size - 1] == '\n');
+    tiny->scan.lexer = (Lexer){data, tiny->scan.bufEnd, 1, 0, false};
+    tiny->lineno = 1;
+    if (tiny->echoSource && (size > 0)) {
+        echoLine(data, tiny->lineno);
     }
 }
 
-/* lookup table of reserved words */
-static struct resWord {
-    char* str;
-    TokenType tok;
-} reservedWords[MAXRESERVED] = {{"else", ELSE},         {"endif", ENDIF},
-                                {"endwhile", ENDWHILE}, {"if", IF},
-                                {"read", READ},         {"repeat", REPEAT},
-                                {"then", THEN},         {"until", UNTIL},
-                                {"while", WHILE},       {"write", WRITE}};
+/* Function initScanner loads the whole of file into
+ * memory, read rather than mapped if readSources is
+ * set, and positions the scanner at its first
+ * character. Returns false if it cannot be read
+ */
+bool initScanner(FILE* file)
+{
+    bool loaded = tiny->readSources ? sourceRead(&tiny->scan.sourceBuf, file)
+                                    : sourceLoad(&tiny->scan.sourceBuf, file);
+    if (!loaded) {
+        return false;
+    }
+    initScannerText(tiny->scan.sourceBuf.data, tiny->scan.sourceBuf.size);
+    return true;
+}
+
+/* Procedure releaseScanner frees the source buffer */
+void releaseScanner(void)
+{
+    sourceRelease(&tiny->scan.sourceBuf);
+    tiny->scan.text = tiny->scan.bufEnd = NULL;
+    tiny->scan.lexer = (Lexer){NULL, NULL, 0, 0, false};
+}
+
+/* Function scannerText returns the source buffer
+ * the scanner was positioned on, its size in *size
+ */
+const char* scannerText(size_t* size)
+{
+    *size = (size_t)(tiny->scan.bufEnd - tiny->scan.text);
+    return tiny->scan.text;
+}
 
 /* lookup an identifier to see if it is a reserved word */
-/* uses binary search */
-static TokenType reservedLookup(char* word)
-{
-    int start = 0;
-    int end = MAXRESERVED - 1;
-    while (start <= end) {
-        int mid = (start + end) / 2;
-        int comparison = strcmp(word, reservedWords[mid].str);
-        if (comparison == 0) {
-            return reservedWords[mid].tok;
-        }
-        else if (comparison < 0) {
-            end = mid - 1;
-        }
-        else {
-            start = mid + 1;
-        }
+/* uses the perfect hash of scandfa.h: one probe */
+static TokenType reservedLookup(const char* word, size_t len)
+{
+    if ((len < KEYWORD_MINLEN) || (len > KEYWORD_MAXLEN)) {
+        return ID;
+    }
+    unsigned h = KEYWORD_HASH(word, len);
+    if ((keywordTable[h].len == len) &&
+        (memcmp(word, keywordTable[h].str, len) == 0)) {
+        return keywordTable[h].tok;
     }
     return ID;
 }
 
-/****************************************/
-/* the primary function of the scanner  */
-/****************************************/
-/* function getToken returns the
- * next token in source file
+/* scanToken runs the scanner DFA over the span of
+ * lx and returns the next token. The lexeme is the
+ * span from *lexeme up to the cursor; it is never
+ * copied. Each character costs one class lookup
+ * and one transition lookup, except inside runs of
+ * white space, comments and identifiers, which the
+ * kernels of scansimd.c skip a block of bytes at a
+ * time. A chunk that does not reach the end of the
+ * buffer ends with ENDFILE at its limit
  */
-TokenType getToken(void)
+static TokenType scanToken(Lexer* lx, const char** lexeme)
 {
-    /* index for storing into tokenString */
-    int tokenStringIndex = 0;
-    /* holds current token to be returned */
-    TokenType currentToken = ENDFILE;
+    const char* p = lx->cursor;
+    const char* limit = lx->limit;
+    const char* bufEnd = tiny->scan.bufEnd;
+    /* first character of the lexeme */
+    const char* start = p;
     /* current state - always begins at START */
     StateType state = START;
+    int line = lx->line;
+    TokenType currentToken = ENDFILE;
+    bool done = false;
+    const char* q; /* end of a run skipped by a kernel */
+    int first;     /* line at the start of that run */
 
-    // Solving `[-Wstringop - overflow]` write a byte in size 0
-    /* holds the current `tokenString` temporarily. */
-    char tokenLexeme[MAXTOKENLEN + 1] = "";
-
-    while (state != DONE) {
-        int c = getNextChar();
-        bool save = true;
-        switch (state) {
-        case START:
-            if (isdigit(c)) {
-                state = INNUM;
-            }
-            else if (isalpha(c)) {
-                state = INID;
-            }
-            else if (c == ':') {
-                state = INASSIGN;
-            }
-            else if (isspace(c)) {
-                save = false;
-            }
-            else if (c == '{') {
-                save = false;
-                state = INCOMMENT;
+    while (!done) {
+        CharClass cls = (CharClass)charClass[(unsigned char)*p];
+        if ((cls == CC_END) && (p != bufEnd)) {
+            cls = CC_OTHER; /* a NUL byte inside the file */
+        }
+        unsigned short e = scanTable[state][cls];
+        state = SCAN_NEXT(e);
+        switch (SCAN_ACTION(e)) {
+        case ACT_SHIFT:
+            p++;
+            break;
+        case ACT_SKIP:
+            start = ++p;
+            break;
+        case ACT_NEWLINE:
+            start = ++p;
+            line++;
+            if (tiny->echoSource && (p != bufEnd)) {
+                echoLine(p, line);
             }
-            else {
-                state = DONE;
-                switch (c) {
-                case EOF:
-                    save = false;
-                    currentToken = ENDFILE;
-                    break;
-                case '=':
-                    currentToken = EQ;
-                    break;
-                case '<':
-                    currentToken = LT;
-                    break;
-                case '+':
-                    currentToken = PLUS;
-                    break;
-                case '-':
-                    currentToken = MINUS;
-                    break;
-                case '*':
-                    currentToken = TIMES;
-                    break;
-                case '/':
-                    currentToken = OVER;
-                    break;
-                case '(':
-                    currentToken = LPAREN;
-                    break;
-                case ')':
-                    currentToken = RPAREN;
-                    break;
-                case ';':
-                    currentToken = SEMI;
-                    break;
-                default:
-                    currentToken = ERROR;
-                    break;
-                }
+            break;
+        case ACT_SPACE:
+            first = line;
+            q = skipSpace(p, limit, &line);
+            if (tiny->echoSource) {
+                echoNewLines(p, q, first);
             }
+            start = p = q;
+            done = (p == limit) && (limit != bufEnd);
             break;
-        case INCOMMENT:
-            save = false;
-            if (c == EOF) {
-                state = DONE;
-                currentToken = ENDFILE;
+        case ACT_COMMENT:
+            first = line;
+            q = skipComment(p + 1, limit, &line);
+            if (tiny->echoSource) {
+                echoNewLines(p, q, first);
             }
-            else if (c == '}') {
+            if (q != limit) { /* past the closing '}' */
+                q++;
                 state = START;
             }
+            start = p = q;
+            done = (p == limit) && (limit != bufEnd);
+            lx->inComment = done;
             break;
-        case INASSIGN:
-            state = DONE;
-            if (c == '=') {
-                currentToken = ASSIGN;
-            }
-            else { /* backup in the input */
-                ungetNextChar();
-                save = false;
-                currentToken = DDOT;
-            }
+        case ACT_IDENT:
+            p = skipIdent(p + 1, limit);
             break;
-        case INNUM:
-            if (!isdigit(c)) { /* backup in the input */
-                ungetNextChar();
-                save = false;
-                state = DONE;
-                currentToken = NUM;
-            }
+        case ACT_ACCEPT:
+            p++;
+            currentToken = SCAN_TOKEN(e);
+            done = true;
+            break;
+        case ACT_BACKUP:
+            currentToken = SCAN_TOKEN(e);
+            done = true;
             break;
-        case INID:
-            if (!(isalnum(c)) && (c != '_')) { /* backup in the input */
-                ungetNextChar();
-                save = false;
-                state = DONE;
-                currentToken = ID;
+        case ACT_END:
+            /* the line count goes past the last line
+               on every read of the end of input */
+            if ((lx->eofReads > 0) || !tiny->scan.endsWithNewline) {
+                line++;
             }
+            lx->eofReads++;
+            currentToken = SCAN_TOKEN(e);
+            done = true;
             break;
-        case DONE:
         default: /* should never happen */
-            fprintf(listing, "Scanner Bug: state= %d\n", state);
-            state = DONE;
+            fprintf(tiny->listing, "Scanner Bug: state= %d\n", state);
             currentToken = ERROR;
+            done = true;
+            break;
+        }
+    }
+    if (currentToken == ENDFILE) {
+        start = p;
+    }
+    else if (currentToken == ID) {
+        currentToken = reservedLookup(start, (size_t)(p - start));
+    }
+    lx->cursor = p;
+    lx->line = line;
+    *lexeme = start;
+    return currentToken;
+}
+
+/* copyLexeme stores at most MAXTOKENLEN characters
+   of a lexeme in tokenString */
+static void copyLexeme(const char* lexeme, size_t len)
+{
+    if (len > MAXTOKENLEN) {
+        len = MAXTOKENLEN;
+    }
+    memcpy(tiny->scan.tokenString, lexeme, len);
+    tiny->scan.tokenString[len] = '\0';
+}
+
+/****************************************/
+/* the primary function of the scanner  */
+/****************************************/
+/* function getToken returns the
+ * next token in source file
+ */
+TokenType getToken(void)
+{
+    const char* lexeme;
+    TokenType currentToken = scanToken(&tiny->scan.lexer, &lexeme);
+    tiny->lineno = tiny->scan.lexer.line;
+    copyLexeme(lexeme, (size_t)(tiny->scan.lexer.cursor - lexeme));
+    if (tiny->traceScan) {
+        fprintf(tiny->listing, "\t%d: ", tiny->lineno);
+        printToken(currentToken, tiny->scan.tokenString);
+    }
+    return currentToken;
+} /* end getToken */
+
+/* growTokenStream doubles the capacity of every
+   array in ts */
+static bool growTokenStream(TokenStream* ts)
+{
+    size_t cap = (ts->capacity == 0) ? 1024 : 2 * ts->capacity;
+    unsigned char* kind = realloc(ts->kind, cap * sizeof(*kind));
+    if (kind != NULL) {
+        ts->kind = kind;
+    }
+    uint32_t* offset = realloc(ts->offset, cap * sizeof(*offset));
+    if (offset != NULL) {
+        ts->offset = offset;
+    }
+    uint32_t* length = realloc(ts->length, cap * sizeof(*length));
+    if (length != NULL) {
+        ts->length = length;
+    }
+    int* line = realloc(ts->line, cap * sizeof(*line));
+    if (line != NULL) {
+        ts->line = line;
+    }
+    int* value = realloc(ts->value, cap * sizeof(*value));
+    if (value != NULL) {
+        ts->value = value;
+    }
+    if ((kind == NULL) || (offset == NULL) || (length == NULL) ||
+        (line == NULL) || (value == NULL)) {
+        return false;
+    }
+    ts->capacity = cap;
+    return true;
+}
+
+/* numValue converts the digits of a NUM lexeme */
+static int numValue(const char* digits, size_t len)
+{
+    unsigned int val = 0;
+    for (size_t i = 0; i < len; i++) {
+        val = val * 10 + (unsigned int)(digits[i] - '0');
+    }
+    return (int)val;
+}
+
+/* lexToken scans the next token of the span of lx
+ * into tok. Identifiers are interned if intern is
+ * true; otherwise their value is their internHash,
+ * for the caller to intern later. Returns false if
+ * memory runs out
+ */
+static inline bool lexToken(Lexer* lx, Token* tok, bool intern)
+{
+    const char* lexeme;
+    TokenType kind = scanToken(lx, &lexeme);
+    size_t len = (size_t)(lx->cursor - lexeme);
+    tok->kind = kind;
+    tok->line = lx->line;
+    tok->offset = (uint32_t)(lexeme - tiny->scan.text);
+    tok->length = (uint32_t)len;
+    tok->value = 0;
+    if (kind == NUM) {
+        tok->value = numValue(lexeme, len);
+    }
+    else if (kind != ID) {
+        /* no value */
+    }
+    else if (!intern) {
+        tok->value = (int)internHash(lexeme, len);
+    }
+    else if ((tok->value = internName(lexeme, len)) < 0) {
+        return false;
+    }
+    return true;
+}
+
+/* scanSpan appends the tokens of the span of lx to
+ * ts, interning identifiers as lexToken does.
+ * Returns false if memory runs out
+ */
+static bool scanSpan(Lexer* lx, TokenStream* ts, bool intern)
+{
+    Token tok;
+    ts->text = tiny->scan.text;
+    do {
+        if (!lexToken(lx, &tok, intern)) {
+            return false;
+        }
+        if ((tok.kind == ENDFILE) && (lx->limit != tiny->scan.bufEnd)) {
+            break; /* end of a chunk */
+        }
+        if ((ts->count == ts->capacity) && !growTokenStream(ts)) {
+            return false;
+        }
+        size_t i = ts->count++;
+        ts->kind[i] = (unsigned char)tok.kind;
+        ts->offset[i] = tok.offset;
+        ts->length[i] = tok.length;
+        ts->line[i] = tok.line;
+        ts->value[i] = tok.value;
+    } while (tok.kind != ENDFILE);
+    return true;
+}
+
+/* Function tokenize scans the rest of the source
+ * buffer into ts, up to and including ENDFILE.
+ * Identifiers are interned as they are scanned.
+ * Returns false if memory runs out
+ */
+bool tokenize(TokenStream* ts)
+{
+    bool ok = scanSpan(&tiny->scan.lexer, ts, true);
+    tiny->lineno = tiny->scan.lexer.line;
+    return ok;
+}
+
+/****************************************/
+/* the parallel tokenizer               */
+/****************************************/
+
+/* MINCHUNK = smallest chunk worth a task, in bytes */
+#define MINCHUNK (1 << 20)
+
+/* CHUNKSPERTHREAD = chunks per worker, to even out
+   chunks that take longer to scan than others */
+#define CHUNKSPERTHREAD 4
+
+/* A Chunk is a span of the buffer that starts at the
+ * beginning of a line and is scanned on its own.
+ * Whether it starts inside a comment is only known
+ * once the chunks before it are scanned, so it is
+ * always scanned as if it did not. Both readings
+ * agree from the first '}' of the chunk onward:
+ * either way the DFA is in START just after it, on
+ * the same line. Starting inside a comment therefore
+ * just drops the tokens up to that '}'
+ */
+typedef struct {
+    Lexer lx;          /* scans the chunk as if outside a comment */
+    TokenStream ts;    /* the tokens found, lines relative to the chunk */
+    const char* end;   /* end of the chunk */
+    size_t afterClose; /* first token past the first '}', or ts.count */
+    bool hasClose;     /* the chunk contains a '}' */
+    int newlines;      /* number of newlines in the chunk */
+    size_t from;       /* first token kept in the merged stream */
+    size_t dest;       /* index of that token in the merged stream */
+    int base;          /* line of the first line of the chunk */
+    bool ok;           /* false if memory ran out */
+    TokenStream* out;  /* the merged stream */
+} Chunk;
+
+/* lexChunk scans one chunk on a worker thread */
+static void lexChunk(void* arg)
+{
+    Chunk* c = arg;
+    const char* start = c->lx.cursor;
+    c->ok = scanSpan(&c->lx, &c->ts, false);
+    c->newlines = c->lx.line;
+    /* take off the ENDFILE line increments */
+    if (c->end == tiny->scan.bufEnd) {
+        c->newlines -= c->lx.eofReads - (tiny->scan.endsWithNewline ? 1 : 0);
+    }
+    const char* close = memchr(start, '}', (size_t)(c->end - start));
+    c->hasClose = (close != NULL);
+    c->afterClose = c->ts.count;
+    if (c->hasClose) {
+        /* offsets are increasing: binary search */
+        size_t lo = 0;
+        size_t hi = c->ts.count;
+        uint32_t closeOffset = (uint32_t)(close - tiny->scan.text);
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (c->ts.offset[mid] > closeOffset) {
+                hi = mid;
+            }
+            else {
+                lo = mid + 1;
+            }
+        }
+        c->afterClose = lo;
+    }
+}
+
+/* copyChunk moves the kept tokens of a chunk to
+   their place in the merged stream */
+static void copyChunk(void* arg)
+{
+    Chunk* c = arg;
+    TokenStream* out = c->out;
+    size_t n = c->ts.count - c->from;
+    memcpy(out->kind + c->dest, c->ts.kind + c->from, n);
+    memcpy(out->offset + c->dest, c->ts.offset + c->from,
+           n * sizeof(uint32_t));
+    memcpy(out->length + c->dest, c->ts.length + c->from,
+           n * sizeof(uint32_t));
+    memcpy(out->value + c->dest, c->ts.value + c->from, n * sizeof(int));
+    for (size_t i = 0; i < n; i++) {
+        out->line[c->dest + i] = c->base + c->ts.line[c->from + i];
+    }
+}
+
+/* splitChunks cuts [from, bufEnd) into at most n
+   chunks, each ending just after a newline except
+   the last; returns the number of chunks */
+static int splitChunks(Chunk* chunks, int n, const char* from)
+{
+    size_t size = (size_t)(tiny->scan.bufEnd - from);
+    int count = 0;
+    const char* start = from;
+    for (int i = 1; (i < n) && (start < tiny->scan.bufEnd); i++) {
+        const char* cut = from + size / (size_t)n * (size_t)i;
+        if (cut <= start) {
+            continue;
+        }
+        const char* nl = memchr(cut, '\n', (size_t)(tiny->scan.bufEnd - cut));
+        if ((nl == NULL) || (nl + 1 == tiny->scan.bufEnd)) {
             break;
         }
-        if ((save) && (tokenStringIndex <= MAXTOKENLEN)) {
-            char tmp[] = {(char)c, '\0'};
-            strcat(tokenLexeme, tmp);
-            tokenStringIndex++;
+        chunks[count].lx = (Lexer){start, nl + 1, 0, 0, false};
+        chunks[count].end = nl + 1;
+        count++;
+        start = nl + 1;
+    }
+    chunks[count].lx =
+        (Lexer){start, tiny->scan.bufEnd, 0, tiny->scan.lexer.eofReads, false};
+    chunks[count].end = tiny->scan.bufEnd;
+    return count + 1;
+}
+
+/* Function tokenizeParallel does the work of tokenize
+ * on a pool of threads workers, and produces the same
+ * token stream. Small inputs, a single thread, or
+ * source echo fall back to tokenize. Returns false if
+ * memory runs out
+ */
+bool tokenizeParallel(TokenStream* ts, int threads)
+{
+    size_t size = (size_t)(tiny->scan.bufEnd - tiny->scan.lexer.cursor);
+    int n = threads * CHUNKSPERTHREAD;
+    if ((size_t)n > size / MINCHUNK) {
+        n = (int)(size / MINCHUNK);
+    }
+    if ((threads < 2) || (n < 2) || tiny->echoSource || (ts->count != 0)) {
+        return tokenize(ts);
+    }
+    Chunk* chunks = calloc((size_t)n, sizeof(Chunk));
+    ThreadPool* pool = (chunks == NULL) ? NULL : newThreadPool(threads);
+    if (pool == NULL) {
+        free(chunks);
+        return tokenize(ts);
+    }
+    n = splitChunks(chunks, n, tiny->scan.lexer.cursor);
+
+    bool ok = true;
+    for (int i = 0; i < n; i++) {
+        ok = ok && poolSubmit(pool, lexChunk, &chunks[i]);
+    }
+    poolWait(pool);
+
+    /* settle where each chunk really starts, and
+       where its tokens go in the merged stream */
+    bool inComment = false;
+    int base = tiny->scan.lexer.line;
+    size_t total = 0;
+    for (int i = 0; ok && (i < n); i++) {
+        Chunk* c = &chunks[i];
+        ok = c->ok;
+        c->from = 0;
+        if (inComment) {
+            c->from = c->afterClose;
+            if (!c->hasClose) {
+                /* wholly inside the comment; only the
+                   last chunk keeps its ENDFILE */
+                c->from = c->ts.count - ((c->end == tiny->scan.bufEnd) ? 1 : 0);
+            }
+        }
+        if (c->hasClose || !inComment) {
+            inComment = c->lx.inComment;
         }
-        if (state == DONE) {
-            strcpy(tokenString, tokenLexeme);
-            if (currentToken == ID) {
-                currentToken = reservedLookup(tokenString);
+        if ((c->end == tiny->scan.bufEnd) && inComment && !c->hasClose) {
+            /* ENDFILE read once, in the comment */
+            c->ts.line[c->from] =
+                c->newlines + (tiny->scan.endsWithNewline ? 0 : 1);
+        }
+        c->dest = total;
+        c->base = base;
+        total += c->ts.count - c->from;
+        base += c->newlines;
+    }
+
+    ts->text = tiny->scan.text;
+    while (ok && (ts->capacity < total)) {
+        ok = growTokenStream(ts);
+    }
+    for (int i = 0; ok && (i < n); i++) {
+        chunks[i].out = ts;
+        ok = poolSubmit(pool, copyChunk, &chunks[i]);
+    }
+    poolWait(pool);
+    freeThreadPool(pool);
+
+    /* interning is in token order, so that symbol
+       ids come out as tokenize numbers them */
+    if (ok) {
+        ts->count = total;
+        for (size_t i = 0; ok && (i < total); i++) {
+            if (ts->kind[i] == ID) {
+                ts->value[i] = internHashedName(ts->text + ts->offset[i],
+                                                ts->length[i],
+                                                (unsigned)ts->value[i]);
+                ok = (ts->value[i] >= 0);
             }
-            memset(tokenLexeme, 0, MAXTOKENLEN);
         }
+        tiny->scan.lexer.cursor = tiny->scan.bufEnd;
+        tiny->scan.lexer.line = tiny->lineno = ts->line[total - 1];
+        tiny->scan.lexer.eofReads = chunks[n - 1].lx.eofReads;
     }
-    if (TraceScan) {
-        fprintf(listing, "\t%d: ", lineno);
-        printToken(currentToken, tokenString);
+    for (int i = 0; i < n; i++) {
+        freeTokenStream(&chunks[i].ts);
     }
-    return currentToken;
-} /* end getToken */
\ No newline at end of file
+    free(chunks);
+    return ok;
+}
+
+/* Procedure freeTokenStream releases the arrays of ts */
+void freeTokenStream(TokenStream* ts)
+{
+    free(ts->kind);
+    free(ts->offset);
+    free(ts->length);
+    free(ts->line);
+    free(ts->value);
+    memset(ts, 0, sizeof(*ts));
+}
+
+/* Function nextToken scans the next token of the
+ * source buffer into tok, interning identifiers.
+ * Unlike getToken it leaves lineno and tokenString
+ * alone, so it may run on a thread of its own while
+ * nothing else uses the scanner. Returns false if
+ * memory runs out
+ */
+bool nextToken(Token* tok)
+{
+    return lexToken(&tiny->scan.lexer, tok, true);
+}
+
+/* Function tokenLexeme copies the lexeme of tok into
+ * tokenString, for listings and diagnostics
+ */
+const char* tokenLexeme(const Token* tok)
+{
+    copyLexeme(tiny->scan.text + tok->offset, tok->length);
+    return tiny->scan.tokenString;
+}
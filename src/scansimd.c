@@ -0,0 +1,215 @@
+/****************************************************/
+/* File: scansimd.c                                 */
+/* Block-at-a-time scanning kernels for the TINY    */
+/* scanner. Each kernel tests 32 (AVX2), 16 (SSE2)  */
+/* or 8 (SWAR) bytes per step and finishes the last */
+/* partial block one byte at a time, so it never    */
+/* reads past end                                   */
+/****************************************************/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "include/scansimd.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/* the scalar definitions, shared by every variant
+   for the tail of the input */
+static int isSpaceChar(unsigned char c)
+{
+    return (c == ' ') || ((c >= '\t') && (c <= '\r'));
+}
+
+static int isIdentChar(unsigned char c)
+{
+    return ((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'z')) ||
+           ((c >= 'A') && (c <= 'Z')) || (c == '_');
+}
+
+#if defined(__AVX2__)
+
+/* BLOCK = bytes tested per step */
+#define BLOCK 32
+typedef __m256i Vec;
+typedef uint32_t Mask;
+#define ALLSET 0xFFFFFFFFu
+#define LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define SPLAT(c) _mm256_set1_epi8((char)(c))
+#define EQ(v, c) _mm256_cmpeq_epi8((v), SPLAT(c))
+#define OR(a, b) _mm256_or_si256((a), (b))
+#define MASK(v) ((Mask)_mm256_movemask_epi8(v))
+/* bytes with lo <= v <= lo + span, compared unsigned */
+#define RANGE(v, lo, span)                                                 \
+    _mm256_cmpeq_epi8(                                                     \
+        _mm256_subs_epu8(_mm256_sub_epi8((v), SPLAT(lo)), SPLAT(span)),    \
+        _mm256_setzero_si256())
+#define KERNELS "avx2"
+
+#elif defined(__SSE2__)
+
+#define BLOCK 16
+typedef __m128i Vec;
+typedef uint32_t Mask;
+#define ALLSET 0xFFFFu
+#define LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#define SPLAT(c) _mm_set1_epi8((char)(c))
+#define EQ(v, c) _mm_cmpeq_epi8((v), SPLAT(c))
+#define OR(a, b) _mm_or_si128((a), (b))
+#define MASK(v) ((Mask)_mm_movemask_epi8(v))
+#define RANGE(v, lo, span)                                                 \
+    _mm_cmpeq_epi8(_mm_subs_epu8(_mm_sub_epi8((v), SPLAT(lo)), SPLAT(span)), \
+                   _mm_setzero_si128())
+#define KERNELS "sse2"
+
+#endif
+
+#ifdef BLOCK
+
+/* masks hold one bit per byte of the block */
+#define MASKBITS 1
+#define SPACEMASK(v) MASK(OR(EQ((v), ' '), RANGE((v), '\t', '\r' - '\t')))
+#define NEWLINEMASK(v) MASK(EQ((v), '\n'))
+#define CLOSEMASK(v) MASK(EQ((v), '}'))
+#define IDENTMASK(v)                                                       \
+    MASK(OR(OR(RANGE((v), '0', 9), RANGE((v), 'a', 25)),                  \
+            OR(RANGE((v), 'A', 25), EQ((v), '_'))))
+#define FIRST(m) ((size_t)__builtin_ctz(m))
+#define COUNT(m) __builtin_popcount(m)
+
+#elif __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+
+/* SWAR: eight bytes in a uint64_t, with the high
+   bit of a byte set in a mask when the byte matches */
+#define BLOCK 8
+typedef uint64_t Vec;
+typedef uint64_t Mask;
+#define ONES 0x0101010101010101ull
+#define HIGHS 0x8080808080808080ull
+#define ALLSET HIGHS
+
+static Vec swarLoad(const char* p)
+{
+    Vec v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* bytes with lo <= v <= hi; exact for every byte
+   because bytes with the high bit set never match */
+static Mask swarRange(Vec v, unsigned lo, unsigned hi)
+{
+    Vec low7 = v & ~HIGHS;
+    Vec geLo = (low7 | HIGHS) - lo * ONES;
+    Vec leHi = ((hi * ONES) | HIGHS) - low7;
+    return geLo & leHi & ~v & HIGHS;
+}
+
+#define MASKBITS 8
+#define LOAD(p) swarLoad(p)
+#define SPACEMASK(v) (swarRange((v), ' ', ' ') | swarRange((v), '\t', '\r'))
+#define NEWLINEMASK(v) swarRange((v), '\n', '\n')
+#define CLOSEMASK(v) swarRange((v), '}', '}')
+#define IDENTMASK(v)                                                       \
+    (swarRange((v), '0', '9') | swarRange((v), 'a', 'z') |                 \
+     swarRange((v), 'A', 'Z') | swarRange((v), '_', '_'))
+#define FIRST(m) ((size_t)__builtin_ctzll(m) / 8)
+#define COUNT(m) __builtin_popcountll(m)
+#define KERNELS "swar"
+
+#else
+
+#define KERNELS "scalar"
+
+#endif
+
+/* BEFORE(m, n) keeps the bits of m for the bytes
+   in front of byte n of the block */
+#ifdef BLOCK
+#define BEFORE(m, n) ((m) & ((((Mask)1) << ((n)*MASKBITS)) - 1))
+#endif
+
+/* Function skipSpace returns the first position in
+ * [p, end) that is not a white space character, or
+ * end. The newlines skipped are added to *lines
+ */
+const char* skipSpace(const char* p, const char* end, int* lines)
+{
+#ifdef BLOCK
+    while (end - p >= BLOCK) {
+        Vec v = LOAD(p);
+        Mask other = ~SPACEMASK(v) & ALLSET;
+        Mask nl = NEWLINEMASK(v);
+        if (other != 0) {
+            size_t n = FIRST(other);
+            *lines += COUNT(BEFORE(nl, n));
+            return p + n;
+        }
+        *lines += COUNT(nl);
+        p += BLOCK;
+    }
+#endif
+    while ((p < end) && isSpaceChar((unsigned char)*p)) {
+        if (*p == '\n') {
+            (*lines)++;
+        }
+        p++;
+    }
+    return p;
+}
+
+/* Function skipComment returns the position of the
+ * first '}' in [p, end), or end. The newlines
+ * skipped are added to *lines
+ */
+const char* skipComment(const char* p, const char* end, int* lines)
+{
+#ifdef BLOCK
+    while (end - p >= BLOCK) {
+        Vec v = LOAD(p);
+        Mask close = CLOSEMASK(v);
+        Mask nl = NEWLINEMASK(v);
+        if (close != 0) {
+            size_t n = FIRST(close);
+            *lines += COUNT(BEFORE(nl, n));
+            return p + n;
+        }
+        *lines += COUNT(nl);
+        p += BLOCK;
+    }
+#endif
+    while ((p < end) && (*p != '}')) {
+        if (*p == '\n') {
+            (*lines)++;
+        }
+        p++;
+    }
+    return p;
+}
+
+/* Function skipIdent returns the first position in
+ * [p, end) that is not in [A-Za-z0-9_], or end
+ */
+const char* skipIdent(const char* p, const char* end)
+{
+#ifdef BLOCK
+    while (end - p >= BLOCK) {
+        Mask other = ~IDENTMASK(LOAD(p)) & ALLSET;
+        if (other != 0) {
+            return p + FIRST(other);
+        }
+        p += BLOCK;
+    }
+#endif
+    while ((p < end) && isIdentChar((unsigned char)*p)) {
+        p++;
+    }
+    return p;
+}
+
+/* Function scanKernelName names the kernels
+ * selected at compile time
+ */
+const char* scanKernelName(void) { return KERNELS; }
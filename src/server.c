@@ -0,0 +1,1103 @@
+/****************************************************/
+/* File: server.c                                   */
+/* Compile server implementation for the TINY       */
+/* compiler: a poll loop over the socket and an     */
+/* inotify descriptor, a thread for each client and */
+/* a cache of compilations keyed by the absolute    */
+/* path of their source                             */
+/****************************************************/
+
+/* struct ucred, for SO_PEERCRED, is a GNU extension */
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "include/driver.h"
+#include "include/server.h"
+
+/* MAXARGS = most arguments of a request, and
+   MAXARGBYTES most bytes in one */
+#define MAXARGS 65536
+#define MAXARGBYTES 65536
+
+/* TIMEOUT = seconds a client may take to send its
+   request or to take its reply */
+#define TIMEOUT 10
+
+/* MAXCLIENTS = most threads at once, serving
+   clients or compiling on change; a client past
+   them is turned away, to compile on its own */
+#define MAXCLIENTS 64
+
+/* KEEPCONTEXTS = compilations kept whole, with
+   their syntax trees and symbol tables, to write
+   code files again from */
+#define KEEPCONTEXTS 64
+
+/* the outputs of a source that are checked: its
+   code file, syntax tree file and index file */
+#define OUTPUTS 3
+static const char* const outputExtension[OUTPUTS] = {".tm", ".ast", ".xrf"};
+
+/* a FileStamp tells if a file has changed */
+typedef struct {
+    bool exists;
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+} FileStamp;
+
+/* a CacheEntry is the last compilation of a source */
+typedef struct {
+    char* path; /* absolute path of the source */
+    char* cwd;  /* the directory it was compiled from */
+    char* name; /* the name it was given there */
+    CompileOptions options;
+    FileStamp source;
+    bool written[OUTPUTS]; /* the outputs it wrote */
+    FileStamp outputs[OUTPUTS];
+    char* listing;
+    size_t listingSize;
+    char* messages;
+    size_t messagesSize;
+    bool ok;
+    bool errors;
+    TinyCompiler* kept; /* its context, or NULL */
+    AstIndex tree;
+    int watch; /* the inotify watch of its directory */
+} CacheEntry;
+
+/* a Keeper is a context kept for an entry */
+typedef struct {
+    CacheEntry* entry;
+    TinyCompiler* kept;
+} Keeper;
+
+typedef struct {
+    /* requests, their batches and compilations on
+       change run on threads of their own, each taking
+       its names from its own directory: lock guards
+       the cache, the counts and threads */
+    pthread_mutex_t lock;
+    /* threads serving a client or compiling on
+       change; ended is signalled as each is done */
+    int threads;
+    pthread_cond_t ended;
+    /* the entries, by linear probing on the hash of
+       their paths; the size is a power of two */
+    CacheEntry** table;
+    size_t mask;
+    size_t count;
+    /* the kept contexts, the oldest let go first */
+    Keeper keepers[KEEPCONTEXTS];
+    int nextKeeper;
+    int inotify;
+    unsigned long compiled;
+    unsigned long replayed;
+    unsigned long regenerated;
+    unsigned long precompiled;
+} Server;
+
+/* set by SIGINT and SIGTERM */
+static volatile sig_atomic_t stopping = 0;
+
+static void stop(int sig)
+{
+    (void)sig;
+    stopping = 1;
+}
+
+/* privateDirectory tells if dir is a directory of
+   the user, which no one else may enter */
+static bool privateDirectory(const char* dir)
+{
+    struct stat st;
+    return (lstat(dir, &st) == 0) && S_ISDIR(st.st_mode) &&
+           (st.st_uid == getuid()) && ((st.st_mode & 077) == 0);
+}
+
+/* socketPath writes the path of the socket to path,
+   of size bytes: TINY_SOCKET, or SOCKETNAME in the
+   runtime directory of the user or else in the
+   directory SOCKETDIR/tiny-<uid>, made by the server
+   if make. Returns false if it does not fit, or if
+   the directory is not the user's alone, telling
+   why if make */
+static bool socketPath(char* path, size_t size, bool make)
+{
+    const char* name = getenv("TINY_SOCKET");
+    const char* runtime = getenv("XDG_RUNTIME_DIR");
+    size_t room = size - strlen(SOCKETNAME) - 1;
+    int n;
+    if (name != NULL) {
+        n = snprintf(path, size, "%s", name);
+        room = size;
+    }
+    else if ((runtime != NULL) && (runtime[0] == '/')) {
+        n = snprintf(path, size, "%s", runtime);
+    }
+    else {
+        n = snprintf(path, size, "%s/tiny-%ld", SOCKETDIR, (long)getuid());
+    }
+    if ((n <= 0) || ((size_t)n >= room)) {
+        if (make) {
+            fprintf(stderr, "tiny: the socket path is too long\n");
+        }
+        return false;
+    }
+    if (name != NULL) {
+        return true;
+    }
+    if (make && (mkdir(path, 0700) != 0) && (errno != EEXIST)) {
+        fprintf(stderr, "tiny: cannot make %s\n", path);
+        return false;
+    }
+    if (!privateDirectory(path)) {
+        if (make) {
+            fprintf(stderr, "tiny: %s is not a directory of yours alone\n",
+                    path);
+        }
+        return false;
+    }
+    sprintf(path + n, "/%s", SOCKETNAME);
+    return true;
+}
+
+/* peerIsUser tells if the process at the other end
+   of the socket fd runs as the user */
+static bool peerIsUser(int fd)
+{
+    struct ucred cred;
+    socklen_t size = sizeof cred;
+    return (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &size) == 0) &&
+           (size == sizeof cred) && (cred.uid == getuid());
+}
+
+/* currentDirectory returns the current directory in
+   memory of its own, or NULL */
+static char* currentDirectory(void)
+{
+    size_t size = 256;
+    for (;;) {
+        char* dir = malloc(size);
+        if ((dir == NULL) || (getcwd(dir, size) != NULL)) {
+            return dir;
+        }
+        free(dir);
+        if (errno != ERANGE) {
+            return NULL;
+        }
+        size *= 2;
+    }
+}
+
+/* readAll reads size bytes from fd into data.
+   Returns false if they cannot all be read */
+static bool readAll(int fd, void* data, size_t size)
+{
+    char* p = data;
+    while (size > 0) {
+        ssize_t n = read(fd, p, size);
+        if ((n < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+/* writeAll writes the size bytes at data to the
+   socket fd. Returns false if it is closed */
+static bool writeAll(int fd, const void* data, size_t size)
+{
+    const char* p = data;
+    while (size > 0) {
+        ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+        if ((n < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+/****************************************/
+/* the cache                            */
+/****************************************/
+
+/* stampOf sets s to the stamp of the file path */
+static void stampOf(const char* path, FileStamp* s)
+{
+    struct stat st;
+    *s = (FileStamp){false, 0, 0, 0, {0, 0}};
+    if (stat(path, &st) == 0) {
+        *s = (FileStamp){true, st.st_dev, st.st_ino, st.st_size, st.st_mtim};
+    }
+}
+
+/* sameStamp tells if a and b stamp the same file
+   unchanged */
+static bool sameStamp(const FileStamp* a, const FileStamp* b)
+{
+    return (a->exists == b->exists) && (a->dev == b->dev) &&
+           (a->ino == b->ino) && (a->size == b->size) &&
+           (a->mtime.tv_sec == b->mtime.tv_sec) &&
+           (a->mtime.tv_nsec == b->mtime.tv_nsec);
+}
+
+/* sameOptions tells if a and b compile alike */
+static bool sameOptions(const CompileOptions* a, const CompileOptions* b)
+{
+    return (a->lexThreads == b->lexThreads) &&
+           (a->analyzeThreads == b->analyzeThreads) &&
+           (a->pipelineParse == b->pipelineParse) &&
+           (a->stackParse == b->stackParse) && (a->emitAst == b->emitAst) &&
+           (a->fromAst == b->fromAst) && (a->stream == b->stream) &&
+           (a->compact == b->compact) && (a->emitXref == b->emitXref);
+}
+
+/* pathHash is the FNV-1a hash of path */
+static size_t pathHash(const char* path)
+{
+    uint64_t h = 14695981039346656037u;
+    for (const unsigned char* p = (const unsigned char*)path; *p; p++) {
+        h = (h ^ *p) * 1099511628211u;
+    }
+    return (size_t)h;
+}
+
+/* findSlot returns the slot of the table holding
+   the entry of path, or the empty slot where it
+   would go */
+static CacheEntry** findSlot(Server* sv, const char* path)
+{
+    size_t i = pathHash(path) & sv->mask;
+    while ((sv->table[i] != NULL) && (strcmp(sv->table[i]->path, path) != 0)) {
+        i = (i + 1) & sv->mask;
+    }
+    return &sv->table[i];
+}
+
+/* grow doubles the table. Returns false if memory
+   runs out */
+static bool grow(Server* sv)
+{
+    size_t size = 2 * (sv->mask + 1);
+    CacheEntry** old = sv->table;
+    size_t oldSize = sv->mask + 1;
+    sv->table = calloc(size, sizeof(CacheEntry*));
+    if (sv->table == NULL) {
+        sv->table = old;
+        return false;
+    }
+    sv->mask = size - 1;
+    for (size_t i = 0; i < oldSize; i++) {
+        if (old[i] != NULL) {
+            *findSlot(sv, old[i]->path) = old[i];
+        }
+    }
+    free(old);
+    return true;
+}
+
+/* keep makes ctx the context kept for e, letting
+   go of the oldest kept context */
+static void keep(Server* sv, CacheEntry* e, TinyCompiler* ctx, AstIndex tree)
+{
+    Keeper* k = &sv->keepers[sv->nextKeeper];
+    if ((k->entry != NULL) && (k->entry->kept == k->kept)) {
+        tinyFree(k->kept);
+        k->entry->kept = NULL;
+    }
+    *k = (Keeper){e, ctx};
+    sv->nextKeeper = (sv->nextKeeper + 1) % KEEPCONTEXTS;
+    e->kept = ctx;
+    e->tree = tree;
+}
+
+/* forget drops what e holds of its compilation */
+static void forget(CacheEntry* e)
+{
+    free(e->cwd);
+    free(e->name);
+    free(e->listing);
+    free(e->messages);
+    e->cwd = e->name = e->listing = e->messages = NULL;
+    if (e->kept != NULL) {
+        tinyFree(e->kept);
+        e->kept = NULL;
+    }
+    e->source.exists = false;
+}
+
+/* addEntry returns the entry of path, made and
+   watched if it is new, or NULL if memory runs out */
+static CacheEntry* addEntry(Server* sv, const char* path)
+{
+    CacheEntry** slot = findSlot(sv, path);
+    if (*slot != NULL) {
+        return *slot;
+    }
+    if ((sv->count + 1) * 4 > (sv->mask + 1) * 3) {
+        if (!grow(sv)) {
+            return NULL;
+        }
+        slot = findSlot(sv, path);
+    }
+    CacheEntry* e = calloc(1, sizeof(CacheEntry));
+    char* dir = strdup(path);
+    if ((e == NULL) || (dir == NULL) ||
+        ((e->path = strdup(path)) == NULL)) {
+        free(e);
+        free(dir);
+        return NULL;
+    }
+    /* path is absolute: its directory ends at the
+       last '/' */
+    char* slash = strrchr(dir, '/');
+    slash[(slash == dir) ? 1 : 0] = '\0';
+    e->watch =
+        inotify_add_watch(sv->inotify, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+    free(dir);
+    *slot = e;
+    sv->count++;
+    return e;
+}
+
+/* outputsFresh tells if the outputs e wrote are
+   unchanged. A code file changed alone is written
+   again from the context kept, if there is one */
+static bool outputsFresh(Server* sv, CacheEntry* e)
+{
+    FileStamp now[OUTPUTS];
+    bool codeStale = false;
+    for (int k = 0; k < OUTPUTS; k++) {
+        if (!e->written[k]) {
+            continue;
+        }
+        char* name = outputName(e->name, outputExtension[k]);
+        char* path = (name != NULL) ? pathFrom(e->cwd, name) : NULL;
+        free(name);
+        if (path == NULL) {
+            return false;
+        }
+        stampOf(path, &now[k]);
+        free(path);
+        if (!sameStamp(&now[k], &e->outputs[k])) {
+            if ((k > 0) || (e->kept == NULL)) {
+                return false;
+            }
+            codeStale = true;
+        }
+    }
+    if (codeStale) {
+        char* name = outputName(e->name, outputExtension[0]);
+        char* path = (name != NULL) ? pathFrom(e->cwd, name) : NULL;
+        bool ok = (path != NULL) &&
+                  regenerateCode(e->kept, e->tree, e->cwd, e->name);
+        if (ok) {
+            stampOf(path, &e->outputs[0]);
+            sv->regenerated++;
+        }
+        free(path);
+        free(name);
+        return ok;
+    }
+    return true;
+}
+
+/* replay writes the compilation of e to listing and
+   messages if it is the compilation of pgm with o
+   now. Returns false if it is not */
+static bool replay(Server* sv, CacheEntry* e, const char* pgm,
+                   const CompileOptions* o, const FileStamp* source,
+                   FILE* listing, FILE* messages)
+{
+    if (!e->source.exists || !sameStamp(&e->source, source) ||
+        (strcmp(e->cwd, o->directory) != 0) || (strcmp(e->name, pgm) != 0) ||
+        !sameOptions(&e->options, o) || !outputsFresh(sv, e)) {
+        return false;
+    }
+    fwrite(e->listing, 1, e->listingSize, listing);
+    fwrite(e->messages, 1, e->messagesSize, messages);
+    sv->replayed++;
+    return true;
+}
+
+/* store makes the compilation of pgm with o, from
+   the source stamped source, the entry of path */
+static void store(Server* sv, const char* path, const char* pgm,
+                  const CompileOptions* o, const FileStamp* source,
+                  FileResult* r, bool ok, char* listing, size_t listingSize,
+                  char* messages, size_t messagesSize)
+{
+    pthread_mutex_lock(&sv->lock);
+    CacheEntry* e = addEntry(sv, path);
+    if (e != NULL) {
+        forget(e);
+        e->cwd = strdup(o->directory);
+        e->name = strdup(pgm);
+    }
+    /* a syntax tree file is written before the
+       type errors are found, so it cannot be told
+       if one was */
+    if ((e == NULL) || (e->cwd == NULL) || (e->name == NULL) ||
+        (r->errors && o->emitAst)) {
+        free(listing);
+        free(messages);
+        if (r->kept != NULL) {
+            tinyFree(r->kept);
+        }
+        pthread_mutex_unlock(&sv->lock);
+        return;
+    }
+    e->options = *o;
+    /* the cache and the directory go with the
+       request: a source compiled on change does
+       without the cache, and is given e->cwd */
+    e->options.cache = NULL;
+    e->options.directory = NULL;
+    e->source = *source;
+    e->listing = listing;
+    e->listingSize = listingSize;
+    e->messages = messages;
+    e->messagesSize = messagesSize;
+    e->ok = ok;
+    e->errors = r->errors;
+    e->written[0] = ok && !r->errors;
+    e->written[1] = ok && !r->errors && o->emitAst;
+    e->written[2] = ok && !r->errors && o->emitXref;
+    for (int k = 0; k < OUTPUTS; k++) {
+        char* name = e->written[k] ? outputName(pgm, outputExtension[k])
+                                   : NULL;
+        char* output = (name != NULL) ? pathFrom(e->cwd, name) : NULL;
+        if (output != NULL) {
+            stampOf(output, &e->outputs[k]);
+        }
+        else if (e->written[k]) {
+            e->source.exists = false;
+        }
+        free(output);
+        free(name);
+    }
+    if (r->kept != NULL) {
+        keep(sv, e, r->kept, r->tree);
+    }
+    sv->compiled++;
+    pthread_mutex_unlock(&sv->lock);
+}
+
+/* compileAndStore compiles pgm with o, writing its
+   listing and messages to listing and messages if
+   they are not NULL, and keeps the compilation.
+   Returns what compileFile does */
+static bool compileAndStore(Server* sv, const char* path, const char* pgm,
+                            const CompileOptions* o, FILE* listing,
+                            FILE* messages, bool* errors)
+{
+    FileStamp source;
+    stampOf(path, &source);
+    char* listingText = NULL;
+    size_t listingSize = 0;
+    char* messagesText = NULL;
+    size_t messagesSize = 0;
+    FILE* l = open_memstream(&listingText, &listingSize);
+    FILE* m = open_memstream(&messagesText, &messagesSize);
+    FileResult r = {true, false, NULL, AST_NULL};
+    bool ok = false;
+    if ((l == NULL) || (m == NULL)) {
+        if (messages != NULL) {
+            fprintf(messages, "Out of memory\n");
+        }
+    }
+    else {
+        ok = compileFile(pgm, o, l, m, &r);
+    }
+    if (l != NULL) {
+        fclose(l);
+    }
+    if (m != NULL) {
+        fclose(m);
+    }
+    *errors = r.errors;
+    if ((l == NULL) || (m == NULL)) {
+        free(listingText);
+        free(messagesText);
+        return false;
+    }
+    if (listing != NULL) {
+        fwrite(listingText, 1, listingSize, listing);
+    }
+    if (messages != NULL) {
+        fwrite(messagesText, 1, messagesSize, messages);
+    }
+    if (source.exists) {
+        store(sv, path, pgm, o, &source, &r, ok, listingText, listingSize,
+              messagesText, messagesSize);
+    }
+    else {
+        free(listingText);
+        free(messagesText);
+    }
+    return ok;
+}
+
+/* cachedCompile is the FileProc of the server: the
+   compilation of file is replayed if nothing it
+   depends on has changed, and made and kept if
+   something has */
+static bool cachedCompile(const char* file, const CompileOptions* o,
+                          FILE* listing, FILE* messages, bool* errors,
+                          void* arg)
+{
+    Server* sv = arg;
+    char* pgm = sourceName(file);
+    char* path = (pgm != NULL) ? pathFrom(o->directory, pgm) : NULL;
+    if (path == NULL) {
+        fprintf(messages, "Out of memory\n");
+        free(pgm);
+        return false;
+    }
+    FileStamp source;
+    stampOf(path, &source);
+    bool ok = false;
+    pthread_mutex_lock(&sv->lock);
+    CacheEntry** slot = findSlot(sv, path);
+    bool replayed = (*slot != NULL) && source.exists &&
+                    replay(sv, *slot, pgm, o, &source, listing, messages);
+    if (replayed) {
+        ok = (*slot)->ok;
+        *errors = (*slot)->errors;
+    }
+    pthread_mutex_unlock(&sv->lock);
+    if (!replayed) {
+        ok = compileAndStore(sv, path, pgm, o, listing, messages, errors);
+    }
+    free(path);
+    free(pgm);
+    return ok;
+}
+
+/* precompile compiles the source path again, as it
+   was compiled last, if it has changed */
+static void precompile(Server* sv, const char* path)
+{
+    FileStamp source;
+    stampOf(path, &source);
+    pthread_mutex_lock(&sv->lock);
+    CacheEntry* e = *findSlot(sv, path);
+    bool changed = (e != NULL) && source.exists && e->source.exists &&
+                   !sameStamp(&source, &e->source);
+    /* the entry is made over by the compilation */
+    char* cwd = changed ? strdup(e->cwd) : NULL;
+    char* name = changed ? strdup(e->name) : NULL;
+    CompileOptions o = changed ? e->options : (CompileOptions){0};
+    pthread_mutex_unlock(&sv->lock);
+    if ((cwd != NULL) && (name != NULL)) {
+        bool errors;
+        o.directory = cwd;
+        compileAndStore(sv, path, name, &o, NULL, NULL, &errors);
+        pthread_mutex_lock(&sv->lock);
+        sv->precompiled++;
+        pthread_mutex_unlock(&sv->lock);
+    }
+    free(cwd);
+    free(name);
+}
+
+/* Changes are the sources to compile again after a
+   batch of inotify events */
+typedef struct {
+    Server* sv;
+    char** paths;
+    size_t count;
+    size_t capacity;
+} Changes;
+
+/* addChange adds a copy of path to c; it is left
+   out if memory runs out */
+static void addChange(Changes* c, const char* path)
+{
+    if (c->count == c->capacity) {
+        size_t cap = (c->capacity == 0) ? 16 : 2 * c->capacity;
+        char** p = realloc(c->paths, cap * sizeof(char*));
+        if (p == NULL) {
+            return;
+        }
+        c->paths = p;
+        c->capacity = cap;
+    }
+    if ((c->paths[c->count] = strdup(path)) != NULL) {
+        c->count++;
+    }
+}
+
+/* compileChanges compiles again the sources of c
+   that have changed, and frees c */
+static void compileChanges(Changes* c)
+{
+    for (size_t i = 0; i < c->count; i++) {
+        precompile(c->sv, c->paths[i]);
+        free(c->paths[i]);
+    }
+    free(c->paths);
+    free(c);
+}
+
+/* threadDone counts out a thread of sv at its end */
+static void threadDone(Server* sv)
+{
+    pthread_mutex_lock(&sv->lock);
+    sv->threads--;
+    pthread_cond_signal(&sv->ended);
+    pthread_mutex_unlock(&sv->lock);
+}
+
+/* changeThread runs compileChanges on the Changes
+   at arg, on a thread of its own */
+static void* changeThread(void* arg)
+{
+    Changes* c = arg;
+    Server* sv = c->sv;
+    compileChanges(c);
+    threadDone(sv);
+    return NULL;
+}
+
+/* startThread runs proc on arg on a detached thread
+   of sv. Returns false if there is no room for one
+   more, or it cannot be started */
+static bool startThread(Server* sv, void* (*proc)(void*), void* arg)
+{
+    pthread_mutex_lock(&sv->lock);
+    bool room = sv->threads < MAXCLIENTS;
+    sv->threads += room ? 1 : 0;
+    pthread_mutex_unlock(&sv->lock);
+    pthread_t thread;
+    pthread_attr_t attr;
+    bool started = false;
+    if (room && (pthread_attr_init(&attr) == 0)) {
+        /* SIGINT and SIGTERM are left to the poll
+           loop: the thread starts with them blocked */
+        sigset_t signals, mask;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, &mask);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        started = pthread_create(&thread, &attr, proc, arg) == 0;
+        pthread_attr_destroy(&attr);
+        pthread_sigmask(SIG_SETMASK, &mask, NULL);
+    }
+    if (room && !started) {
+        threadDone(sv);
+    }
+    return started;
+}
+
+/* watchEvents compiles again, on a thread of its
+   own, the sources the events waiting on the
+   inotify descriptor tell of */
+static void watchEvents(Server* sv)
+{
+    union {
+        struct inotify_event event;
+        char bytes[16384];
+    } buf;
+    ssize_t n;
+    Changes* c = calloc(1, sizeof(Changes));
+    while ((n = read(sv->inotify, buf.bytes, sizeof buf.bytes)) > 0) {
+        for (char* p = buf.bytes; p < buf.bytes + n;) {
+            struct inotify_event* ev = (struct inotify_event*)p;
+            p += sizeof(struct inotify_event) + ev->len;
+            if ((ev->len == 0) || (c == NULL)) {
+                continue;
+            }
+            pthread_mutex_lock(&sv->lock);
+            for (size_t i = 0; i <= sv->mask; i++) {
+                CacheEntry* e = sv->table[i];
+                if ((e != NULL) && (e->watch == ev->wd) &&
+                    (strcmp(strrchr(e->path, '/') + 1, ev->name) == 0)) {
+                    addChange(c, e->path);
+                }
+            }
+            pthread_mutex_unlock(&sv->lock);
+        }
+    }
+    if (c == NULL) {
+        return;
+    }
+    c->sv = sv;
+    /* with no room for a thread they are compiled
+       here, holding up new clients */
+    if ((c->count == 0) || !startThread(sv, changeThread, c)) {
+        compileChanges(c);
+    }
+}
+
+/****************************************/
+/* the server and the client            */
+/****************************************/
+
+/* readRequest reads the strings of a request from
+   fd: its directory, then its command line. Returns
+   their number, or 0 if the request is bad */
+static int readRequest(int fd, char*** strings)
+{
+    uint32_t count;
+    if (!readAll(fd, &count, sizeof count) || (count < 2) ||
+        (count > MAXARGS)) {
+        return 0;
+    }
+    char** s = calloc(count + 1, sizeof(char*));
+    bool ok = s != NULL;
+    for (uint32_t i = 0; ok && (i < count); i++) {
+        uint32_t size;
+        ok = readAll(fd, &size, sizeof size) && (size <= MAXARGBYTES) &&
+             ((s[i] = malloc(size + 1)) != NULL) && readAll(fd, s[i], size);
+        if (ok) {
+            s[i][size] = '\0';
+        }
+    }
+    if (!ok) {
+        for (uint32_t i = 0; (s != NULL) && (i < count); i++) {
+            free(s[i]);
+        }
+        free(s);
+        return 0;
+    }
+    *strings = s;
+    return (int)count;
+}
+
+/* serveClient runs the request of the client on fd
+   and sends back its exit status, listing and
+   messages */
+static void serveClient(Server* sv, int fd)
+{
+    struct timeval timeout = {TIMEOUT, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof timeout);
+    char** strings;
+    int count = readRequest(fd, &strings);
+    if (count == 0) {
+        return;
+    }
+    char* out = NULL;
+    size_t outSize = 0;
+    char* msgs = NULL;
+    size_t msgsSize = 0;
+    FILE* o = open_memstream(&out, &outSize);
+    FILE* m = open_memstream(&msgs, &msgsSize);
+    int32_t status = EXIT_FAILURE;
+    if ((o != NULL) && (m != NULL)) {
+        CommandLine cl = {0};
+        struct stat st;
+        /* names are taken from the directory of the
+           client, which the server never enters */
+        if ((strings[0][0] != '/') || (stat(strings[0], &st) != 0) ||
+            !S_ISDIR(st.st_mode)) {
+            fprintf(m, "tiny: cannot enter %s\n", strings[0]);
+        }
+        else if (parseCommandLine(&cl, count - 1, strings + 1, strings[0],
+                                  m)) {
+            /* the sources may be saved as they are compiled */
+            cl.options.readSources = true;
+            status = cl.lsp ? EXIT_FAILURE
+                            : runCommandLine(&cl, o, m, cachedCompile, sv);
+        }
+        freeCommandLine(&cl);
+    }
+    if (o != NULL) {
+        fclose(o);
+    }
+    if (m != NULL) {
+        fclose(m);
+    }
+    uint64_t sizes[2] = {outSize, msgsSize};
+    if (writeAll(fd, &status, sizeof status) &&
+        writeAll(fd, &sizes[0], sizeof sizes[0]) &&
+        writeAll(fd, out, outSize) &&
+        writeAll(fd, &sizes[1], sizeof sizes[1])) {
+        writeAll(fd, msgs, msgsSize);
+    }
+    free(out);
+    free(msgs);
+    for (int i = 0; i < count; i++) {
+        free(strings[i]);
+    }
+    free(strings);
+}
+
+/* a Client is a connection being served */
+typedef struct {
+    Server* sv;
+    int fd;
+} Client;
+
+/* serveThread serves the Client at arg on a thread
+   of its own, so that a client slow to send holds
+   up no other */
+static void* serveThread(void* arg)
+{
+    Client* c = arg;
+    Server* sv = c->sv;
+    serveClient(sv, c->fd);
+    close(c->fd);
+    free(c);
+    threadDone(sv);
+    return NULL;
+}
+
+/* acceptClient serves the next client of listener
+   on a thread of its own. A client of another user
+   is turned away, and so is one the server has no
+   room for, which then compiles on its own */
+static void acceptClient(Server* sv, int listener)
+{
+    int fd = accept(listener, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+    Client* c = peerIsUser(fd) ? malloc(sizeof(Client)) : NULL;
+    if (c != NULL) {
+        *c = (Client){sv, fd};
+    }
+    if ((c == NULL) || !startThread(sv, serveThread, c)) {
+        free(c);
+        close(fd);
+    }
+}
+
+/* listenOn binds a socket listening at path, taking
+   over the socket of a server no longer running.
+   Returns it, or -1 */
+static int listenOn(const char* path)
+{
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if ((bind(fd, (struct sockaddr*)&addr, sizeof addr) != 0) &&
+        (errno == EADDRINUSE)) {
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        bool live = (probe >= 0) &&
+                    (connect(probe, (struct sockaddr*)&addr, sizeof addr) == 0);
+        if (probe >= 0) {
+            close(probe);
+        }
+        if (live) {
+            fprintf(stderr, "tiny: a server is running on %s\n", path);
+            close(fd);
+            return -1;
+        }
+        unlink(path);
+        if (bind(fd, (struct sockaddr*)&addr, sizeof addr) != 0) {
+            close(fd);
+            return -1;
+        }
+    }
+    if (listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Function serverRun serves the command lines of
+ * tiny --client until it is sent SIGINT or SIGTERM.
+ * Each client of the same user is served on a
+ * thread of its own, their command lines running at
+ * once, with names taken from their directories. The listing and code of each
+ * source are kept, and replayed while the source,
+ * the options and the outputs are unchanged; the
+ * directories of the sources are watched, and a
+ * source is compiled again when it is written.
+ * Returns false if it cannot listen on the socket
+ */
+bool serverRun(void)
+{
+    char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+    if (!socketPath(path, sizeof path, true)) {
+        return false;
+    }
+    int listener = listenOn(path);
+    if (listener < 0) {
+        fprintf(stderr, "tiny: cannot listen on %s\n", path);
+        return false;
+    }
+    Server sv = {0};
+    pthread_mutex_init(&sv.lock, NULL);
+    pthread_cond_init(&sv.ended, NULL);
+    sv.mask = 255;
+    sv.table = calloc(sv.mask + 1, sizeof(CacheEntry*));
+    sv.inotify = inotify_init1(IN_NONBLOCK);
+    struct sigaction sa = {0};
+    sa.sa_handler = stop;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sa.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &sa, NULL);
+    bool ok = sv.table != NULL;
+    if (ok) {
+        fprintf(stderr, "tiny: serving on %s\n", path);
+    }
+    while (ok && !stopping) {
+        struct pollfd fds[2] = {{listener, POLLIN, 0},
+                                {sv.inotify, POLLIN, 0}};
+        if (poll(fds, (sv.inotify >= 0) ? 2 : 1, -1) < 0) {
+            ok = errno == EINTR;
+            continue;
+        }
+        if ((sv.inotify >= 0) && (fds[1].revents & POLLIN)) {
+            watchEvents(&sv);
+        }
+        if (fds[0].revents & POLLIN) {
+            acceptClient(&sv, listener);
+        }
+    }
+    close(listener);
+    unlink(path);
+    /* the clients still served are done within
+       TIMEOUT of their last byte, and compilations
+       on change when they end */
+    pthread_mutex_lock(&sv.lock);
+    while (sv.threads > 0) {
+        pthread_cond_wait(&sv.ended, &sv.lock);
+    }
+    pthread_mutex_unlock(&sv.lock);
+    fprintf(stderr,
+            "tiny: %lu compiled, %lu replayed, %lu code files written "
+            "again, %lu compiled on change\n",
+            sv.compiled, sv.replayed, sv.regenerated, sv.precompiled);
+    for (size_t i = 0; (sv.table != NULL) && (i <= sv.mask); i++) {
+        if (sv.table[i] != NULL) {
+            forget(sv.table[i]);
+            free(sv.table[i]->path);
+            free(sv.table[i]);
+        }
+    }
+    free(sv.table);
+    pthread_cond_destroy(&sv.ended);
+    pthread_mutex_destroy(&sv.lock);
+    if (sv.inotify >= 0) {
+        close(sv.inotify);
+    }
+    return ok;
+}
+
+/* copyReply copies a part of the reply on fd to out:
+   its size, then as many bytes. Returns false if
+   the reply breaks off */
+static bool copyReply(int fd, FILE* out)
+{
+    uint64_t size;
+    if (!readAll(fd, &size, sizeof size)) {
+        return false;
+    }
+    char buf[BUFSIZ];
+    while (size > 0) {
+        size_t n = (size < sizeof buf) ? (size_t)size : sizeof buf;
+        if (!readAll(fd, buf, n)) {
+            return false;
+        }
+        fwrite(buf, 1, n, out);
+        size -= n;
+    }
+    return true;
+}
+
+/* sendString sends the length and bytes of s */
+static bool sendString(int fd, const char* s)
+{
+    uint32_t size = (uint32_t)strlen(s);
+    return writeAll(fd, &size, sizeof size) && writeAll(fd, s, size);
+}
+
+/* Function clientRun has the server run the command
+ * line argv of argc arguments, argv[0] naming the
+ * program, from the current directory, and writes
+ * its listing to stdout and its messages to stderr.
+ * Returns the exit status of the command line, or
+ * -1 if there is no server of the user to run it,
+ * or it turned the command line away
+ */
+int clientRun(int argc, char* argv[])
+{
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    char* cwd = currentDirectory();
+    if ((cwd == NULL) ||
+        !socketPath(addr.sun_path, sizeof addr.sun_path, false)) {
+        free(cwd);
+        return -1;
+    }
+    for (int i = 1; i < argc; i++) {
+        /* the language server talks over stdin and
+           stdout: it is never served */
+        if (strcmp(argv[i], "--lsp") == 0) {
+            free(cwd);
+            return -1;
+        }
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if ((fd < 0) || (connect(fd, (struct sockaddr*)&addr, sizeof addr) != 0)) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        free(cwd);
+        return -1;
+    }
+    if (!peerIsUser(fd)) {
+        fprintf(stderr, "tiny: the server on %s is not yours\n",
+                addr.sun_path);
+        close(fd);
+        free(cwd);
+        return -1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    uint32_t count = (uint32_t)argc + 1;
+    bool sent = writeAll(fd, &count, sizeof count) && sendString(fd, cwd);
+    for (int i = 0; sent && (i < argc); i++) {
+        sent = sendString(fd, argv[i]);
+    }
+    free(cwd);
+    int32_t status;
+    if (!sent || !readAll(fd, &status, sizeof status)) {
+        /* turned away, or gone before it ran the
+           command line: it is run here */
+        close(fd);
+        return -1;
+    }
+    bool replied = copyReply(fd, stdout);
+    fflush(stdout);
+    replied = replied && copyReply(fd, stderr);
+    close(fd);
+    if (!replied) {
+        fprintf(stderr, "tiny: the server broke off\n");
+        return EXIT_FAILURE;
+    }
+    return status;
+}
@@ -0,0 +1,440 @@
+/****************************************************/
+/* File: slots.c                                    */
+/* Data memory compaction for the TINY compiler:    */
+/* a liveness analysis over the basic blocks of the */
+/* program, an interference graph of its variables  */
+/* and a greedy coloring of the graph into memory   */
+/* locations                                        */
+/****************************************************/
+
+#include <stdint.h>
+
+#include "include/slots.h"
+#include "include/compiler.h"
+
+/* A Block is a basic block of the flow graph: its
+ * events are events[start] up to the start of the
+ * block after it, and it goes on to at most two
+ * blocks, -1 marking none
+ */
+typedef struct SlotBlock {
+    size_t start;
+    int succ[2];
+} Block;
+
+/* an event is a variable, by its location before
+   compaction, used (2 * var) or stored (2 * var + 1)
+   in the order the code does it */
+
+/* Words is the number of words of a set of vars */
+#define WORDS(n) (((size_t)(n) + 63) / 64)
+
+/* newBlock starts a block after the last one and
+   returns it, or -1 if memory runs out */
+static int newBlock(void)
+{
+    SlotState* st = &tiny->slots;
+    if (st->blockCount == st->blockCapacity) {
+        int cap = (st->blockCapacity == 0) ? 256 : 2 * st->blockCapacity;
+        Block* b = realloc(st->blocks, (size_t)cap * sizeof(*b));
+        if (b == NULL) {
+            st->failed = true;
+            return -1;
+        }
+        st->blocks = b;
+        st->blockCapacity = cap;
+    }
+    st->blocks[st->blockCount] = (Block){st->eventCount, {-1, -1}};
+    return st->blockCount++;
+}
+
+/* addEdge makes block from go on to block to */
+static void addEdge(int from, int to)
+{
+    if ((from < 0) || (to < 0)) {
+        return;
+    }
+    Block* b = &tiny->slots.blocks[from];
+    b->succ[(b->succ[0] < 0) ? 0 : 1] = to;
+}
+
+/* follow starts a block the last one goes on to
+   and returns it */
+static int follow(void)
+{
+    int from = tiny->slots.blockCount - 1;
+    int b = newBlock();
+    addEdge(from, b);
+    return b;
+}
+
+/* addEvent adds the use or store of name to the
+   last block */
+static void addEvent(int name, bool store)
+{
+    SlotState* st = &tiny->slots;
+    int v = st_lookup(name);
+    if (v < 0) {
+        st->failed = true;
+        return;
+    }
+    if (v >= st->varCapacity) {
+        int cap = (st->varCapacity == 0) ? 256 : 2 * st->varCapacity;
+        while (cap <= v) {
+            cap *= 2;
+        }
+        int* n = realloc(st->names, (size_t)cap * sizeof(*n));
+        if (n == NULL) {
+            st->failed = true;
+            return;
+        }
+        st->names = n;
+        st->varCapacity = cap;
+    }
+    if (v >= st->varCount) {
+        st->varCount = v + 1;
+    }
+    st->names[v] = name;
+    if (st->eventCount == st->eventCapacity) {
+        size_t cap = (st->eventCapacity == 0) ? 1024 : 2 * st->eventCapacity;
+        int* e = realloc(st->events, cap * sizeof(*e));
+        if (e == NULL) {
+            st->failed = true;
+            return;
+        }
+        st->events = e;
+        st->eventCapacity = cap;
+    }
+    st->events[st->eventCount++] = 2 * v + (store ? 1 : 0);
+}
+
+/* slotStart starts the flow graph with the entry
+   block */
+static void slotStart(void)
+{
+    SlotState* st = &tiny->slots;
+    st->eventCount = 0;
+    st->blockCount = 0;
+    st->varCount = 0;
+    st->failed = false;
+    newBlock();
+}
+
+/* slotEnter adds the uses of identifiers and the
+ * stores of read, and starts the loop heads: the
+ * blocks repeat and while jump back to
+ */
+static bool slotEnter(WalkFrame* frame, size_t depth)
+{
+    TreeNode* t = frame->node;
+    (void)depth;
+    if (t->nodekind == ExpK) {
+        if (t->kind.exp == IdK) {
+            addEvent(t->attr.name, false);
+        }
+        return true;
+    }
+    switch (t->kind.stmt) {
+    case RepeatK:
+    case WhileK:
+        frame->saved[0] = follow();
+        break;
+    case ReadK:
+        addEvent(t->attr.name, true);
+        break;
+    case SwitchK:
+    case CaseK:
+        /* not made by the parser */
+        tiny->slots.failed = true;
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+/* slotBetween splits the blocks of if, repeat and
+ * while around their children, frame->child - 1
+ * being the one just walked, as cgen lays out
+ * their jumps
+ */
+static void slotBetween(WalkFrame* frame)
+{
+    TreeNode* t = frame->node;
+    int child = frame->child - 1;
+    if (t->nodekind != StmtK) {
+        return;
+    }
+    int last = tiny->slots.blockCount - 1;
+    switch (t->kind.stmt) {
+    case IfK:
+        if (child == 0) {
+            /* after the test: on to the then part */
+            frame->saved[0] = last;
+            follow();
+        }
+        else if (child == 1) {
+            /* after the then part: the test goes on to
+               the else part too */
+            frame->saved[1] = last;
+            addEdge(frame->saved[0], newBlock());
+        }
+        else {
+            /* both parts go on to the end */
+            int end = newBlock();
+            addEdge(frame->saved[1], end);
+            addEdge(last, end);
+        }
+        break;
+    case RepeatK:
+        if (child == 1) {
+            /* the test goes back to the body, or on */
+            addEdge(last, frame->saved[0]);
+            follow();
+        }
+        break;
+    case WhileK:
+        if (child == 0) {
+            /* the test goes on to the body */
+            follow();
+        }
+        else if (child == 1) {
+            /* the body goes back to the test, and the
+               test goes on past the loop */
+            addEdge(last, frame->saved[0]);
+            addEdge(frame->saved[0], newBlock());
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/* slotLeave adds the stores of assignments, after
+   the uses of their expressions */
+static void slotLeave(WalkFrame* frame)
+{
+    TreeNode* t = frame->node;
+    if ((t->nodekind == StmtK) && (t->kind.stmt == AssignK)) {
+        addEvent(t->attr.name, true);
+    }
+}
+
+/* blockEnd returns where the events of block b
+   end */
+static size_t blockEnd(int b)
+{
+    SlotState* st = &tiny->slots;
+    return (b + 1 < st->blockCount) ? st->blocks[b + 1].start : st->eventCount;
+}
+
+/* blockIn sets in to the variables live at the start
+   of block b, given out, those live at its end */
+static void blockIn(int b, const uint64_t* out, uint64_t* in, size_t words)
+{
+    SlotState* st = &tiny->slots;
+    size_t end = blockEnd(b);
+    memcpy(in, out, words * sizeof(*in));
+    for (size_t i = end; i > st->blocks[b].start; i--) {
+        int v = st->events[i - 1] / 2;
+        uint64_t bit = (uint64_t)1 << (v % 64);
+        if (st->events[i - 1] % 2) {
+            in[v / 64] &= ~bit;
+        }
+        else {
+            in[v / 64] |= bit;
+        }
+    }
+}
+
+/* blockOut sets out to the variables live at the end
+   of block b: those live at the start of the blocks
+   it goes on to */
+static void blockOut(int b, const uint64_t* live, uint64_t* out, size_t words)
+{
+    memset(out, 0, words * sizeof(*out));
+    for (int s = 0; s < 2; s++) {
+        int to = tiny->slots.blocks[b].succ[s];
+        if (to >= 0) {
+            for (size_t w = 0; w < words; w++) {
+                out[w] |= live[(size_t)to * words + w];
+            }
+        }
+    }
+}
+
+/* liveness returns the variables live at the start
+ * of each block, words per block, iterating from
+ * the last block back to the first until nothing
+ * changes: the back edges of loops take a pass or
+ * two more. Returns NULL if memory runs out
+ */
+static uint64_t* liveness(size_t words)
+{
+    uint64_t* live =
+        calloc((size_t)tiny->slots.blockCount * words, sizeof(*live));
+    uint64_t* out = malloc(2 * words * sizeof(*out));
+    if ((live == NULL) || (out == NULL)) {
+        free(live);
+        free(out);
+        return NULL;
+    }
+    uint64_t* in = out + words;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (int b = tiny->slots.blockCount - 1; b >= 0; b--) {
+            blockOut(b, live, out, words);
+            blockIn(b, out, in, words);
+            uint64_t* old = &live[(size_t)b * words];
+            if (memcmp(old, in, words * sizeof(*in)) != 0) {
+                memcpy(old, in, words * sizeof(*in));
+                changed = true;
+            }
+        }
+    }
+    free(out);
+    return live;
+}
+
+/* interfere returns the interference graph of the
+ * variables as a bit matrix, words per row: each
+ * variable stored meets every other variable live
+ * after the store. Locations start out zero, so
+ * variables only read before any store may share
+ * one. Returns NULL if memory runs out
+ */
+static uint64_t* interfere(const uint64_t* live, size_t words)
+{
+    SlotState* st = &tiny->slots;
+    uint64_t* graph = calloc((size_t)st->varCount * words, sizeof(*graph));
+    uint64_t* now = malloc(words * sizeof(*now));
+    if ((graph == NULL) || (now == NULL)) {
+        free(graph);
+        free(now);
+        return NULL;
+    }
+    for (int b = 0; b < st->blockCount; b++) {
+        size_t end = blockEnd(b);
+        blockOut(b, live, now, words);
+        for (size_t i = end; i > st->blocks[b].start; i--) {
+            int v = st->events[i - 1] / 2;
+            uint64_t bit = (uint64_t)1 << (v % 64);
+            if ((st->events[i - 1] % 2) == 0) {
+                now[v / 64] |= bit;
+                continue;
+            }
+            now[v / 64] &= ~bit;
+            uint64_t* row = &graph[(size_t)v * words];
+            for (size_t w = 0; w < words; w++) {
+                for (uint64_t m = now[w]; m != 0; m &= m - 1) {
+                    int u = (int)(w * 64) + __builtin_ctzll(m);
+                    row[w] |= (uint64_t)1 << (u % 64);
+                    graph[(size_t)u * words + v / 64] |= bit;
+                }
+            }
+        }
+    }
+    free(now);
+    return graph;
+}
+
+/* color gives each variable, in order of location,
+ * the lowest slot none of the variables before it
+ * that it meets in graph holds, into slot, and
+ * returns the number of slots used
+ */
+static int color(const uint64_t* graph, size_t words, int* slot)
+{
+    int* taken = malloc((size_t)tiny->slots.varCount * sizeof(*taken));
+    if (taken == NULL) {
+        return -1;
+    }
+    int slots = 0;
+    for (int v = 0; v < tiny->slots.varCount; v++) {
+        const uint64_t* row = &graph[(size_t)v * words];
+        taken[v] = -1;
+        for (size_t w = 0; w <= (size_t)v / 64; w++) {
+            uint64_t m = row[w];
+            if (w == (size_t)v / 64) {
+                m &= ((uint64_t)1 << (v % 64)) - 1;
+            }
+            for (; m != 0; m &= m - 1) {
+                taken[slot[(int)(w * 64) + __builtin_ctzll(m)]] = v;
+            }
+        }
+        int s = 0;
+        while (taken[s] == v) {
+            s++;
+        }
+        slot[v] = s;
+        if (s + 1 > slots) {
+            slots = s + 1;
+        }
+    }
+    free(taken);
+    return slots;
+}
+
+/* compact moves the variables to their slots and
+   returns the number of slots, or -1 if they stay */
+static int compact(void)
+{
+    SlotState* st = &tiny->slots;
+    if (st->failed || (st->varCount == 0) || (st->varCount > SLOTMAXVARS)) {
+        return -1;
+    }
+    size_t words = WORDS(st->varCount);
+    uint64_t* live = liveness(words);
+    if (live == NULL) {
+        return -1;
+    }
+    uint64_t* graph = interfere(live, words);
+    free(live);
+    int* slot = malloc((size_t)st->varCount * sizeof(*slot));
+    int slots = -1;
+    if ((graph != NULL) && (slot != NULL)) {
+        slots = color(graph, words, slot);
+    }
+    if (slots >= 0) {
+        for (int v = 0; v < st->varCount; v++) {
+            st_relocate(st->names[v], slot[v]);
+        }
+    }
+    free(graph);
+    free(slot);
+    return slots;
+}
+
+/* slotFinish compacts the slots, lists how many it
+   saved and frees the flow graph */
+static void slotFinish(void)
+{
+    SlotState* st = &tiny->slots;
+    int slots = compact();
+    if (slots >= 0) {
+        fprintf(tiny->listing, "\nData slots: %d variables in %d locations, "
+                         "%d saved\n",
+                st->varCount, slots, st->varCount - slots);
+    }
+    else {
+        fprintf(tiny->listing, "\nData slots: %d variables, not compacted\n",
+                st->varCount);
+    }
+    free(st->events);
+    free(st->blocks);
+    free(st->names);
+    st->events = NULL;
+    st->blocks = NULL;
+    st->names = NULL;
+    st->eventCapacity = 0;
+    st->blockCapacity = 0;
+    st->varCapacity = 0;
+}
+
+const Pass slotPass = {.name = "slots",
+                       .start = slotStart,
+                       .enter = slotEnter,
+                       .between = slotBetween,
+                       .leave = slotLeave,
+                       .finish = slotFinish,
+                       .alone = true};
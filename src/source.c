@@ -0,0 +1,105 @@
+/****************************************************/
+/* File: source.c                                   */
+/* Whole-file source buffer implementation          */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "include/source.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* READCHUNK = initial heap buffer size used when
+   the input cannot be mapped */
+#define READCHUNK 65536
+
+/* readAll reads the whole stream into a heap
+   buffer, growing it geometrically */
+static bool readAll(SourceBuffer* buf, FILE* file)
+{
+    size_t cap = READCHUNK;
+    size_t len = 0;
+    char* data = malloc(cap + 1);
+    if (data == NULL) {
+        return false;
+    }
+    for (;;) {
+        size_t n = fread(data + len, 1, cap - len, file);
+        len += n;
+        if (len < cap) {
+            break;
+        }
+        char* grown = realloc(data, 2 * cap + 1);
+        if (grown == NULL) {
+            free(data);
+            return false;
+        }
+        data = grown;
+        cap *= 2;
+    }
+    if (ferror(file)) {
+        free(data);
+        return false;
+    }
+    data[len] = '\0';
+    buf->data = data;
+    buf->size = len;
+    buf->mapped = false;
+    return true;
+}
+
+/* Function sourceLoad fills buf with the contents
+ * of file. Regular files are memory mapped; pipes,
+ * terminals and files whose size is an exact
+ * multiple of the page size are read into a heap
+ * buffer instead. Returns false on failure
+ */
+bool sourceLoad(SourceBuffer* buf, FILE* file)
+{
+    struct stat st;
+    int fd = fileno(file);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if ((fd >= 0) && (fstat(fd, &st) == 0) && S_ISREG(st.st_mode) &&
+        (st.st_size > 0) && (pageSize > 0) &&
+        (st.st_size % pageSize != 0)) {
+        /* the tail of the last page reads as zeros,
+           which gives the sentinel for free */
+        void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            posix_madvise(p, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+            buf->data = p;
+            buf->size = (size_t)st.st_size;
+            buf->mapped = true;
+            return true;
+        }
+    }
+    return readAll(buf, file);
+}
+
+/* Function sourceRead fills buf with the contents
+ * of file read into a heap buffer, never mapped, so
+ * that a file changed while it is used cannot reach
+ * the buffer. Returns false on failure
+ */
+bool sourceRead(SourceBuffer* buf, FILE* file) { return readAll(buf, file); }
+
+/* Procedure sourceRelease unmaps or frees the
+ * memory held by buf
+ */
+void sourceRelease(SourceBuffer* buf)
+{
+    if (buf->data == NULL) {
+        return;
+    }
+    if (buf->mapped) {
+        munmap((void*)buf->data, buf->size);
+    }
+    else {
+        free((void*)buf->data);
+    }
+    buf->data = NULL;
+    buf->size = 0;
+}
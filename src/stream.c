@@ -0,0 +1,171 @@
+/****************************************************/
+/* File: stream.c                                   */
+/* One pass compilation for the TINY compiler       */
+/* Each top level statement goes through the parser,*/
+/* the analyzer and the code generator in turn and  */
+/* its nodes are dropped before the next is parsed  */
+/****************************************************/
+
+#include "include/stream.h"
+#include "include/analyze.h"
+#include "include/cgen.h"
+#include "include/compiler.h"
+#include "include/parse.h"
+
+/* scannerToken is the TokenSource of the parse: the
+   scanner, one token at a time */
+static void scannerToken(Token* tok)
+{
+    if (!tiny->streamScanFailed && nextToken(tok)) {
+        return;
+    }
+    if (!tiny->streamScanFailed) {
+        fprintf(tiny->listing, "Out of memory error at line %d\n",
+                tiny->lineno);
+        tiny->error = true;
+        tiny->streamScanFailed = true;
+    }
+    *tok = (Token){ENDFILE, tiny->lineno, 0, 0, 0};
+}
+
+/* spoolTo runs proc on stmt with the listing sent
+   to spool */
+static void spoolTo(FILE* spool, AstIndex stmt, void (*proc)(AstIndex))
+{
+    FILE* out = tiny->listing;
+    tiny->listing = spool;
+    proc(stmt);
+    tiny->listing = out;
+}
+
+/* listTree lists the syntax tree of stmt */
+static void listTree(AstIndex stmt) { astForEachStatement(stmt, printTree); }
+
+/* unspool copies spool to the listing and closes it */
+static void unspool(FILE* spool)
+{
+    char buf[BUFSIZ];
+    size_t n;
+    rewind(spool);
+    while ((n = fread(buf, 1, sizeof buf, spool)) > 0) {
+        fwrite(buf, 1, n, tiny->listing);
+    }
+    fclose(spool);
+}
+
+/* Function streamCompile compiles the source the
+ * scanner was initialized with into the code file
+ * codefile, a top level statement at a time, so
+ * that only one statement's tree is ever held. The
+ * listing and the code file come out as they do
+ * from parse, buildSymtab, typeCheck and codeGen
+ * run one after the other: listings held back until
+ * the program has been parsed wait in temporary
+ * files, and the code file is written under another
+ * name and only renamed to codefile if there are no
+ * errors. A relative codefile is taken from the
+ * directory of the context. Returns false if
+ * codefile cannot be written
+ */
+bool streamCompile(const char* codefile)
+{
+    char* codepath = pathFrom(tiny->directory, codefile);
+    char* partfile =
+        (codepath != NULL) ? calloc(strlen(codepath) + 6, sizeof(char)) : NULL;
+    if (partfile == NULL) {
+        fprintf(tiny->listing, "Out of memory\n");
+        free(codepath);
+        return false;
+    }
+    strcpy(partfile, codepath);
+    strcat(partfile, ".part");
+    tiny->code = fopen(partfile, "w");
+    /* the tree listing and the type errors come after
+       the whole parse */
+    FILE* trees = tmpfile();
+    FILE* types = tmpfile();
+    if ((tiny->code == NULL) || (trees == NULL) || (types == NULL)) {
+        fprintf(tiny->listing, "Unable to open %s\n", codefile);
+        if (tiny->code != NULL) {
+            fclose(tiny->code);
+            tiny->code = NULL;
+            remove(partfile);
+        }
+        if (trees != NULL) {
+            fclose(trees);
+        }
+        if (types != NULL) {
+            fclose(types);
+        }
+        free(partfile);
+        free(codepath);
+        return false;
+    }
+    codeGenBegin(codefile);
+
+    tiny->streamScanFailed = false;
+    parseBegin(scannerToken, NULL);
+    bool first = true;
+    bool typeFailed = false;
+    AstIndex stmt;
+    /* Error stays set by syntax errors only: once one
+       is found nothing of the program is used */
+    while (parseStatement(first, &stmt)) {
+        first = false;
+        if (!tiny->error && (stmt != AST_NULL)) {
+            if (tiny->traceParse) {
+                spoolTo(trees, stmt, listTree);
+            }
+            addSymbols(stmt);
+            spoolTo(types, stmt, typeCheck);
+            if (tiny->error) {
+                typeFailed = true;
+                tiny->error = false;
+            }
+            if (!typeFailed) {
+                codeGenStatement(stmt);
+            }
+        }
+        astTruncate(0);
+    }
+    parseEnd();
+
+    if (tiny->error) {
+        fclose(trees);
+        fclose(types);
+    }
+    else {
+        if (tiny->traceParse) {
+            fprintf(tiny->listing, "\nSyntax tree:\n");
+        }
+        unspool(trees);
+        if (tiny->traceAnalyze) {
+            fprintf(tiny->listing, "\nBuilding Symbol Table...\n");
+            fprintf(tiny->listing, "\nSymbol table:\n\n");
+            printSymTab(tiny->listing);
+            fprintf(tiny->listing, "\nChecking Types...\n");
+        }
+        unspool(types);
+        if (tiny->traceAnalyze) {
+            fprintf(tiny->listing, "\nType Checking Finished\n");
+        }
+    }
+    tiny->error = tiny->error || typeFailed;
+
+    codeGenEnd();
+    fclose(tiny->code);
+    tiny->code = NULL;
+    if (tiny->error) {
+        remove(partfile);
+    }
+    else if (rename(partfile, codepath) != 0) {
+        fprintf(tiny->listing, "Unable to open %s\n", codefile);
+        remove(partfile);
+        free(partfile);
+        free(codepath);
+        return false;
+    }
+    free(partfile);
+    free(codepath);
+    return true;
+}
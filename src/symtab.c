@@ -2,103 +2,299 @@
 /* File: symtab.c                                   */
 /* Symbol table implementation for the TINY compiler*/
 /* (allows only one symbol table)                   */
-/* Symbol table is implemented as a chained         */
-/* hash table                                       */
+/* Symbol table is implemented as shards of Robin   */
+/* Hood hash tables over growable entry arrays      */
 /* Compiler Construction: Principles and Practice   */
 /* Kenneth C. Louden                                */
 /****************************************************/
 
 #include "include/symtab.h"
+#include "include/arena.h"
+#include "include/compiler.h"
+#include "include/globals.h"
 
-/* SIZE is the size of the hash table */
-#define SIZE 211
+/* LISTBUCKETS is the size of the chained table this
+   one replaced: the listing keeps its order */
+#define LISTBUCKETS 211
 
-/* SHIFT is the power of two used as multiplier
-   in hash function  */
-#define SHIFT 4
+/* FIRSTCHUNK and LASTCHUNK bound the number of line
+   numbers a chunk holds: each chunk of a list holds
+   twice as many as the one before it, up to
+   LASTCHUNK */
+#define FIRSTCHUNK 4
+#define LASTCHUNK 1024
 
-/* the hash function */
-static int hash(const char* key)
+/* SHARDBITS = log2 of SYMSHARDS */
+#define SHARDBITS 4
+
+/* the line numbers of the source code in which a
+ * variable is referenced, as a list of chunks
+ */
+typedef struct LineChunk {
+    struct LineChunk* next;
+    int count;    /* line numbers held */
+    int capacity; /* line numbers it can hold */
+    int lines[];
+} LineChunk;
+
+/* The entry of each variable, including name,
+ * assigned memory location, and the line numbers
+ * in which it appears in the source code. Entries
+ * are kept in the order they were inserted
+ */
+typedef struct SymEntry {
+    int name;        /* interned symbol id */
+    int memloc;      /* memory location for variable */
+    int order;       /* location first handed out */
+    LineChunk* head; /* first chunk of line numbers */
+    LineChunk* tail; /* chunk the next line number goes to */
+} SymEntry;
+
+/* A slot of the probing table holds the hash of the
+ * name of an entry, so that probes compare hashes
+ * without touching the entries, and the entry + 1,
+ * 0 marking a free slot
+ */
+typedef struct SymSlot {
+    unsigned hash;
+    int entry;
+} SymSlot;
+
+/* shardOf returns the shard of the names with hash
+   h: the one numbered by its top SHARDBITS bits */
+static SymShard* shardOf(unsigned h)
 {
-    int temp = 0;
-    int i = 0;
-    while (key[i] != '\0') {
-        temp = ((temp << SHIFT) + key[i]) % SIZE;
-        i++;
-    }
-    return temp;
+    return &tiny->shards[(h >> (32 - SHARDBITS)) & (SYMSHARDS - 1)];
 }
 
-/* the list of line numbers of the source
- * code in which a variable is referenced
+/* distance returns how far the slot at i of shard
+   sh is from the home slot of the hash it holds */
+static size_t distance(const SymShard* sh, unsigned hash, size_t i)
+{
+    return (i - (hash & sh->slotMask)) & sh->slotMask;
+}
+
+/* place puts slot s in the table of sh, taking the
+ * place of any slot nearer its home on the way: so
+ * every probe sequence is ordered by distance from
+ * home
  */
-typedef struct LineListRec {
-    int lineno;
-    struct LineListRec* next;
-} * LineList;
-
-/* The record in the bucket lists for
- * each variable, including name,
- * assigned memory location, and
- * the list of line numbers in which
- * it appears in the source code
+static void place(SymShard* sh, SymSlot s)
+{
+    size_t i = s.hash & sh->slotMask;
+    size_t d = 0;
+    while (sh->slots[i].entry != 0) {
+        size_t e = distance(sh, sh->slots[i].hash, i);
+        if (e < d) {
+            SymSlot t = sh->slots[i];
+            sh->slots[i] = s;
+            s = t;
+            d = e;
+        }
+        i = (i + 1) & sh->slotMask;
+        d++;
+    }
+    sh->slots[i] = s;
+}
+
+/* find returns the entry of name, whose hash is h,
+ * in sh, or -1. A probe stops at a free slot, or at
+ * a slot nearer its home than name would be
  */
-typedef struct BucketListRec {
-    char* name;
-    LineList lines;
-    int memloc; /* memory location for variable */
-    struct BucketListRec* next;
-} * BucketList;
+static int find(const SymShard* sh, int name, unsigned h)
+{
+    if (sh->slots == NULL) {
+        return -1;
+    }
+    size_t i = h & sh->slotMask;
+    for (size_t d = 0; sh->slots[i].entry != 0; d++) {
+        if (distance(sh, sh->slots[i].hash, i) < d) {
+            break;
+        }
+        int k = sh->slots[i].entry - 1;
+        if ((sh->slots[i].hash == h) && (sh->entries[k].name == name)) {
+            return k;
+        }
+        i = (i + 1) & sh->slotMask;
+    }
+    return -1;
+}
+
+/* growSlots rebuilds the probing table of sh at
+   twice its size, keeping the load factor below
+   3/4 */
+static bool growSlots(SymShard* sh)
+{
+    size_t size = (sh->slotMask == 0) ? 64 : 2 * (sh->slotMask + 1);
+    SymSlot* s = calloc(size, sizeof(*s));
+    if (s == NULL) {
+        return false;
+    }
+    free(sh->slots);
+    sh->slots = s;
+    sh->slotMask = size - 1;
+    for (int k = 0; k < sh->count; k++) {
+        place(sh, (SymSlot){symbolHash(sh->entries[k].name), k + 1});
+    }
+    return true;
+}
 
-/* the hash table */
-static BucketList hashTable[SIZE];
+/* newChunk returns an empty chunk of sh for size
+   line numbers, or NULL if memory runs out */
+static LineChunk* newChunk(SymShard* sh, int size)
+{
+    LineChunk* c = arenaAlloc(&sh->lineArena,
+                              sizeof(LineChunk) + (size_t)size * sizeof(int));
+    if (c != NULL) {
+        c->next = NULL;
+        c->count = 0;
+        c->capacity = size;
+    }
+    return c;
+}
+
+/* addLine appends lineno to the line numbers of e,
+   an entry of sh. Returns false if memory runs out */
+static bool addLine(SymShard* sh, SymEntry* e, int lineno)
+{
+    LineChunk* t = e->tail;
+    if (t->count == t->capacity) {
+        int cap = (t->capacity < LASTCHUNK) ? 2 * t->capacity : LASTCHUNK;
+        if ((t->next = newChunk(sh, cap)) == NULL) {
+            return false;
+        }
+        t = e->tail = t->next;
+    }
+    t->lines[t->count++] = lineno;
+    return true;
+}
+
+/* outOfMemory reports that the table cannot grow */
+static void outOfMemory(int line)
+{
+    fprintf(tiny->listing, "Out of memory error at line %d\n", line);
+    tiny->error = true;
+}
 
 /* Procedure st_insert inserts line numbers and
  * memory locations into the symbol table
  * loc = memory location is inserted only the
  * first time, otherwise ignored
+ * Inserts of names of different shards may run
+ * concurrently
  */
-void st_insert(char* name, int lineno, int loc)
+void st_insert(int name, int lineno, int loc)
 {
-    int h = hash(name);
-    BucketList l = hashTable[h];
-    while ((l != NULL) && (strcmp(name, l->name) != 0))
-        l = l->next;
-    if (l == NULL) /* variable not yet in table */
-    {
-        l = (BucketList)malloc(sizeof(struct BucketListRec));
-        l->name = name;
-        l->lines = (LineList)malloc(sizeof(struct LineListRec));
-        l->lines->lineno = lineno;
-        l->memloc = loc;
-        l->lines->next = NULL;
-        l->next = hashTable[h];
-        hashTable[h] = l;
-    }
-    else /* found in table, so just add line number */
+    unsigned h = symbolHash(name);
+    SymShard* sh = shardOf(h);
+    int k = find(sh, name, h);
+    if (k < 0) /* variable not yet in table */
     {
-        LineList t = l->lines;
-        while (t->next != NULL)
-            t = t->next;
-        t->next = (LineList)malloc(sizeof(struct LineListRec));
-        t->next->lineno = lineno;
-        t->next->next = NULL;
+        if ((((size_t)sh->count + 1) * 4 > (sh->slotMask + 1) * 3) &&
+            !growSlots(sh)) {
+            outOfMemory(lineno);
+            return;
+        }
+        if (sh->count == sh->capacity) {
+            int cap = (sh->capacity == 0) ? 64 : 2 * sh->capacity;
+            SymEntry* e = realloc(sh->entries, (size_t)cap * sizeof(*e));
+            if (e == NULL) {
+                outOfMemory(lineno);
+                return;
+            }
+            sh->entries = e;
+            sh->capacity = cap;
+        }
+        LineChunk* c = newChunk(sh, FIRSTCHUNK);
+        if (c == NULL) {
+            outOfMemory(lineno);
+            return;
+        }
+        k = sh->count++;
+        sh->entries[k] = (SymEntry){name, loc, loc, c, c};
+        place(sh, (SymSlot){h, k + 1});
+    }
+    if (!addLine(sh, &sh->entries[k], lineno)) {
+        outOfMemory(lineno);
     }
 } /* st_insert */
 
 /* Function st_lookup returns the memory
  * location of a variable or -1 if not found
  */
-int st_lookup(char* name)
+int st_lookup(int name)
 {
-    int h = hash(name);
-    BucketList l = hashTable[h];
-    while ((l != NULL) && (strcmp(name, l->name) != 0))
-        l = l->next;
-    if (l == NULL)
-        return -1;
-    else
-        return l->memloc;
+    unsigned h = symbolHash(name);
+    const SymShard* sh = shardOf(h);
+    int k = find(sh, name, h);
+    return (k < 0) ? -1 : sh->entries[k].memloc;
+}
+
+/* Procedure st_relocate moves the variable name
+ * to memory location loc. The listing keeps the
+ * order of the locations first handed out
+ */
+void st_relocate(int name, int loc)
+{
+    unsigned h = symbolHash(name);
+    SymShard* sh = shardOf(h);
+    int k = find(sh, name, h);
+    if (k >= 0) {
+        sh->entries[k].memloc = loc;
+    }
+}
+
+/* Function st_shard returns the shard of the symbol
+ * table name goes to
+ */
+int st_shard(int name)
+{
+    return (int)(shardOf(symbolHash(name)) - tiny->shards);
+}
+
+/* Procedure st_free empties the symbol table and
+ * releases its memory
+ */
+void st_free(void)
+{
+    for (int s = 0; s < SYMSHARDS; s++) {
+        SymShard* sh = &tiny->shards[s];
+        free(sh->entries);
+        free(sh->slots);
+        arenaRelease(&sh->lineArena);
+        *sh = (SymShard){0};
+    }
+}
+
+/* listOrder compares entries by their place in the
+   listing: by bucket of the chained table, and
+   latest inserted first within a bucket, which is
+   the one first handed the highest location, as
+   locations are handed out in order of first
+   insertion */
+static int listOrder(const void* a, const void* b)
+{
+    const SymEntry* x = *(const SymEntry* const*)a;
+    const SymEntry* y = *(const SymEntry* const*)b;
+    unsigned bx = symbolHash(x->name) % LISTBUCKETS;
+    unsigned by = symbolHash(y->name) % LISTBUCKETS;
+    if (bx != by) {
+        return (bx < by) ? -1 : 1;
+    }
+    return (x->order < y->order) - (x->order > y->order);
+}
+
+/* printEntry lists entry e */
+static void printEntry(FILE* listing, const SymEntry* e)
+{
+    fprintf(listing, "%-14s ", symbolName(e->name));
+    fprintf(listing, "%-8d  ", e->memloc);
+    for (const LineChunk* c = e->head; c != NULL; c = c->next) {
+        for (int i = 0; i < c->count; i++) {
+            fprintf(listing, "%4d ", c->lines[i]);
+        }
+    }
+    fprintf(listing, "\n");
 }
 
 /* Procedure printSymTab prints a formatted
@@ -109,20 +305,29 @@ void printSymTab(FILE* listing)
 {
     fprintf(listing, "Variable Name  Location   Line Numbers\n");
     fprintf(listing, "-------------  --------   ------------\n");
-    for (int i = 0; i < SIZE; ++i) {
-        if (hashTable[i] != NULL) {
-            BucketList l = hashTable[i];
-            while (l != NULL) {
-                LineList t = l->lines;
-                fprintf(listing, "%-14s ", l->name);
-                fprintf(listing, "%-8d  ", l->memloc);
-                while (t != NULL) {
-                    fprintf(listing, "%4d ", t->lineno);
-                    t = t->next;
-                }
-                fprintf(listing, "\n");
-                l = l->next;
+    size_t count = 0;
+    for (int s = 0; s < SYMSHARDS; s++) {
+        count += (size_t)tiny->shards[s].count;
+    }
+    const SymEntry** order = malloc((count + 1) * sizeof(*order));
+    if (order == NULL) {
+        /* without room to sort, shard by shard */
+        for (int s = 0; s < SYMSHARDS; s++) {
+            for (int k = 0; k < tiny->shards[s].count; k++) {
+                printEntry(listing, &tiny->shards[s].entries[k]);
             }
         }
+        return;
+    }
+    size_t n = 0;
+    for (int s = 0; s < SYMSHARDS; s++) {
+        for (int k = 0; k < tiny->shards[s].count; k++) {
+            order[n++] = &tiny->shards[s].entries[k];
+        }
+    }
+    qsort(order, count, sizeof(*order), listOrder);
+    for (size_t i = 0; i < count; i++) {
+        printEntry(listing, order[i]);
     }
-} /* printSymTab */
\ No newline at end of file
+    free(order);
+} /* printSymTab */
@@ -0,0 +1,158 @@
+/****************************************************/
+/* File: threadpool.c                               */
+/* Fixed-size worker thread pool implementation     */
+/* for the TINY compiler: one task queue guarded by */
+/* a mutex, drained by the workers                  */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "include/threadpool.h"
+#include "include/compiler.h"
+
+typedef struct {
+    TaskProc proc;
+    void* arg;
+} Task;
+
+struct ThreadPool {
+    pthread_mutex_t lock;
+    pthread_cond_t work; /* signalled when a task is queued */
+    pthread_cond_t idle; /* signalled when the last task ends */
+    Task* queue;         /* circular buffer of pending tasks */
+    size_t head;
+    size_t count;
+    size_t capacity;
+    int running; /* tasks taken but not yet finished */
+    bool stop;
+    int threads;
+    pthread_t* workers;
+    TinyCompiler* context; /* the context the tasks run in */
+};
+
+/* worker takes tasks off the queue until the
+   pool is stopped and the queue is empty */
+static void* worker(void* arg)
+{
+    ThreadPool* pool = arg;
+    tinyUse(pool->context);
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while ((pool->count == 0) && !pool->stop) {
+            pthread_cond_wait(&pool->work, &pool->lock);
+        }
+        if (pool->count == 0) {
+            break;
+        }
+        Task task = pool->queue[pool->head];
+        pool->head = (pool->head + 1) % pool->capacity;
+        pool->count--;
+        pool->running++;
+        pthread_mutex_unlock(&pool->lock);
+        task.proc(task.arg);
+        pthread_mutex_lock(&pool->lock);
+        pool->running--;
+        if ((pool->count == 0) && (pool->running == 0)) {
+            pthread_cond_broadcast(&pool->idle);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/* Function newThreadPool starts a pool of threads
+ * workers, running their tasks in the context of
+ * the calling thread. Returns NULL if they cannot
+ * be started
+ */
+ThreadPool* newThreadPool(int threads)
+{
+    ThreadPool* pool = calloc(1, sizeof(ThreadPool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->context = tiny;
+    pool->workers = calloc((size_t)threads, sizeof(pthread_t));
+    if (pool->workers == NULL) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&pool->workers[i], NULL, worker, pool) != 0) {
+            break;
+        }
+        pool->threads++;
+    }
+    if (pool->threads == 0) {
+        freeThreadPool(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/* Function poolSubmit queues proc(arg) to run on one
+ * of the workers. Returns false if memory runs out
+ */
+bool poolSubmit(ThreadPool* pool, TaskProc proc, void* arg)
+{
+    pthread_mutex_lock(&pool->lock);
+    if (pool->count == pool->capacity) {
+        size_t cap = (pool->capacity == 0) ? 16 : 2 * pool->capacity;
+        Task* q = malloc(cap * sizeof(Task));
+        if (q == NULL) {
+            pthread_mutex_unlock(&pool->lock);
+            return false;
+        }
+        for (size_t i = 0; i < pool->count; i++) {
+            q[i] = pool->queue[(pool->head + i) % pool->capacity];
+        }
+        free(pool->queue);
+        pool->queue = q;
+        pool->head = 0;
+        pool->capacity = cap;
+    }
+    pool->queue[(pool->head + pool->count) % pool->capacity] =
+        (Task){proc, arg};
+    pool->count++;
+    pthread_cond_signal(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+    return true;
+}
+
+/* Procedure poolWait blocks until every task
+ * submitted so far has finished
+ */
+void poolWait(ThreadPool* pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    while ((pool->count > 0) || (pool->running > 0)) {
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* Procedure freeThreadPool waits for the queued
+ * tasks, stops the workers and frees the pool
+ */
+void freeThreadPool(ThreadPool* pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->threads; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work);
+    pthread_cond_destroy(&pool->idle);
+    free(pool->queue);
+    free(pool->workers);
+    free(pool);
+}
@@ -7,6 +7,9 @@
 /****************************************************/
 
 #include "include/util.h"
+#include "include/arena.h"
+#include "include/compiler.h"
+#include "include/walk.h"
 
 /* Procedure printToken prints a token
  * and its lexeme to the listing file
@@ -24,55 +27,55 @@ void printToken(TokenType token, const char* tokenString)
     case READ:
     case WRITE:
     case WHILE:
-        fprintf(listing, "reserved word: %s\n", tokenString);
+        fprintf(tiny->listing, "reserved word: %s\n", tokenString);
         break;
     case ASSIGN:
-        fprintf(listing, ":=\n");
+        fprintf(tiny->listing, ":=\n");
         break;
     case LT:
-        fprintf(listing, "<\n");
+        fprintf(tiny->listing, "<\n");
         break;
     case EQ:
-        fprintf(listing, "=\n");
+        fprintf(tiny->listing, "=\n");
         break;
     case LPAREN:
-        fprintf(listing, "(\n");
+        fprintf(tiny->listing, "(\n");
         break;
     case RPAREN:
-        fprintf(listing, ")\n");
+        fprintf(tiny->listing, ")\n");
         break;
     case SEMI:
-        fprintf(listing, ";\n");
+        fprintf(tiny->listing, ";\n");
         break;
     case PLUS:
-        fprintf(listing, "+\n");
+        fprintf(tiny->listing, "+\n");
         break;
     case MINUS:
-        fprintf(listing, "-\n");
+        fprintf(tiny->listing, "-\n");
         break;
     case TIMES:
-        fprintf(listing, "*\n");
+        fprintf(tiny->listing, "*\n");
         break;
     case DDOT:
-        fprintf(listing, ":\n");
+        fprintf(tiny->listing, ":\n");
         break;
     case OVER:
-        fprintf(listing, "/\n");
+        fprintf(tiny->listing, "/\n");
         break;
     case ENDFILE:
-        fprintf(listing, "EOF\n");
+        fprintf(tiny->listing, "EOF\n");
         break;
     case NUM:
-        fprintf(listing, "NUM, val= %s\n", tokenString);
+        fprintf(tiny->listing, "NUM, val= %s\n", tokenString);
         break;
     case ID:
-        fprintf(listing, "ID, name= %s\n", tokenString);
+        fprintf(tiny->listing, "ID, name= %s\n", tokenString);
         break;
     case ERROR:
-        fprintf(listing, "ERROR: %s\n", tokenString);
+        fprintf(tiny->listing, "ERROR: %s\n", tokenString);
         break;
     default: /* should never happen */
-        fprintf(listing, "Unknown token: %d\n", token);
+        fprintf(tiny->listing, "Unknown token: %d\n", token);
     }
 }
 
@@ -81,9 +84,11 @@ void printToken(TokenType token, const char* tokenString)
  */
 TreeNode* newStmtNode(StmtKind kind)
 {
-    TreeNode* node = (TreeNode*)malloc(sizeof(TreeNode));
+    TreeNode* node = (TreeNode*)arenaAlloc(&tiny->util.treeArena,
+                                           sizeof(TreeNode));
     if (node == NULL) {
-        fprintf(listing, "Out of memory error at line %d\n", lineno);
+        fprintf(tiny->listing, "Out of memory error at line %d\n",
+                tiny->lineno);
         return NULL;
     }
     for (int i = 0; i < MAXCHILDREN; i++) {
@@ -92,7 +97,7 @@ TreeNode* newStmtNode(StmtKind kind)
     node->sibling = NULL;
     node->nodekind = StmtK;
     node->kind.stmt = kind;
-    node->lineno = lineno;
+    node->lineno = tiny->lineno;
     return node;
 }
 
@@ -101,9 +106,11 @@ TreeNode* newStmtNode(StmtKind kind)
  */
 TreeNode* newExpNode(ExpKind kind)
 {
-    TreeNode* node = (TreeNode*)malloc(sizeof(TreeNode));
+    TreeNode* node = (TreeNode*)arenaAlloc(&tiny->util.treeArena,
+                                           sizeof(TreeNode));
     if (node == NULL) {
-        fprintf(listing, "Out of memory error at line %d\n", lineno);
+        fprintf(tiny->listing, "Out of memory error at line %d\n",
+                tiny->lineno);
         return NULL;
     }
     for (int i = 0; i < MAXCHILDREN; i++) {
@@ -112,7 +119,7 @@ TreeNode* newExpNode(ExpKind kind)
     node->sibling = NULL;
     node->nodekind = ExpK;
     node->kind.exp = kind;
-    node->lineno = lineno;
+    node->lineno = tiny->lineno;
     node->type = Void;
     return node;
 }
@@ -122,110 +129,108 @@ TreeNode* newExpNode(ExpKind kind)
  */
 char* copyString(char* s)
 {
-    int n;
     char* t;
     if (s == NULL) {
         return NULL;
     }
-    n = strlen(s) + 1;
-    t = malloc(n);
+    t = arenaCopy(&tiny->util.treeArena, s, strlen(s));
     if (t == NULL) {
-        fprintf(listing, "Out of memory error at line %d\n", lineno);
-    }
-    else {
-        strcpy(t, s);
+        fprintf(tiny->listing, "Out of memory error at line %d\n",
+                tiny->lineno);
     }
     return t;
 }
 
-/* Variable indentno is used by printTree to
- * store current number of spaces to indent
- */
-static int indentno = 0;
-
-/* macros to increase/decrease indentation */
-#define INDENT indentno += 2
-#define UNINDENT indentno -= 2
+/* printSpaces indents a node at depth depth by
+   printing spaces */
+static void printSpaces(size_t depth)
+{
+    for (size_t i = 0; i < 2 * depth; i++) {
+        fprintf(tiny->listing, " ");
+    }
+}
 
-/* printSpaces indents by printing spaces */
-static void printSpaces(void)
+/* printNode prints the node of frame, indented by
+   its depth */
+static bool printNode(WalkFrame* frame, size_t depth)
 {
-    for (int i = 0; i < indentno; i++) {
-        fprintf(listing, " ");
+    TreeNode* tree = frame->node;
+    printSpaces(depth);
+    if (tree->nodekind == StmtK) {
+        switch (tree->kind.stmt) {
+        case IfK:
+            fprintf(tiny->listing, "If\n");
+            break;
+        case RepeatK:
+            fprintf(tiny->listing, "Repeat\n");
+            break;
+        case AssignK:
+            fprintf(tiny->listing, "Assign to: %s\n",
+                    symbolName(tree->attr.name));
+            break;
+        case ReadK:
+            fprintf(tiny->listing, "Read: %s\n", symbolName(tree->attr.name));
+            break;
+        case WriteK:
+            fprintf(tiny->listing, "Write\n");
+            break;
+        case WhileK:
+            fprintf(tiny->listing, "While\n");
+            break;
+        default:
+            fprintf(tiny->listing, "Unknown ExpNode kind\n");
+            break;
+        }
+    }
+    else if (tree->nodekind == ExpK) {
+        switch (tree->kind.exp) {
+        case OpK:
+            fprintf(tiny->listing, "Op: ");
+            printToken(tree->attr.op, "\0");
+            break;
+        case ConstK:
+            fprintf(tiny->listing, "Const: %d\n", tree->attr.val);
+            break;
+        case IdK:
+            fprintf(tiny->listing, "Id: %s\n", symbolName(tree->attr.name));
+            break;
+        default:
+            fprintf(tiny->listing, "Unknown ExpNode kind\n");
+            break;
+        }
+    }
+    else {
+        fprintf(tiny->listing, "Unknown node kind\n");
     }
+    return true;
 }
 
 /* procedure printTree prints a syntax tree to the
  * listing file using indentation to indicate subtrees
  */
-void printTree(TreeNode* tree)
+void printTree(TreeNode* tree) { walkTree(tree, printNode, NULL, NULL); }
+
+/* Procedure freeSyntaxTrees releases every node made
+ * by newStmtNode and newExpNode and every string made
+ * by copyString, all at once
+ */
+void freeSyntaxTrees(void) { arenaRelease(&tiny->util.treeArena); }
+
+/* Procedure setDiagnosticProc makes proc hear of
+ * every error reported from now on; NULL stops it
+ */
+void setDiagnosticProc(DiagnosticProc proc)
 {
-    INDENT;
-    while (tree != NULL) {
-        printSpaces();
-        if (tree->nodekind == StmtK) {
-            switch (tree->kind.stmt) {
-            case IfK:
-                fprintf(listing, "If\n");
-                break;
-            case RepeatK:
-                fprintf(listing, "Repeat\n");
-                break;
-            case AssignK:
-                fprintf(listing, "Assign to: %s\n", tree->attr.name);
-                break;
-            case ReadK:
-                fprintf(listing, "Read: %s\n", tree->attr.name);
-                break;
-            case WriteK:
-                fprintf(listing, "Write\n");
-                break;
-            case WhileK:
-                fprintf(listing, "While\n");
-                break;
-            default:
-                fprintf(listing, "Unknown ExpNode kind\n");
-                break;
-            }
-        }
-        else if (tree->nodekind == ExpK) {
-            switch (tree->kind.exp) {
-            case OpK:
-                fprintf(listing, "Op: ");
-                printToken(tree->attr.op, "\0");
-                break;
-            case ConstK:
-                fprintf(listing, "Const: %d\n", tree->attr.val);
-                break;
-            case IdK:
-                fprintf(listing, "Id: %s\n", tree->attr.name);
-                break;
-            default:
-                fprintf(listing, "Unknown ExpNode kind\n");
-                break;
-            }
-        }
-        else {
-            fprintf(listing, "Unknown node kind\n");
-        }
-        for (int i = 0; i < MAXCHILDREN; i++) {
-            printTree(tree->child[i]);
-        }
-        tree = tree->sibling;
-    }
-    UNINDENT;
+    tiny->util.diagnosticProc = proc;
 }
 
-void freeTree(TreeNode* tree)
+/* Procedure diagnostic passes an error on to the
+ * DiagnosticProc, if one is set. The listing is
+ * written as before either way
+ */
+void diagnostic(int line, const char* message, const char* detail)
 {
-    TreeNode* cur = tree;
-    while (cur != NULL) {
-        for (int i = 0; i < MAXCHILDREN; i++) {
-            freeTree(cur->child[i]);
-        }
-        cur = cur->sibling;
-    }
-    if (tree != NULL) {
-        free(tree);
+    if (tiny->util.diagnosticProc != NULL) {
+        tiny->util.diagnosticProc(line, message, detail);
     }
 }
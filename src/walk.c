@@ -0,0 +1,49 @@
+/****************************************************/
+/* File: walk.c                                     */
+/* Syntax tree walker implementation                */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#include "include/walk.h"
+#include "include/compiler.h"
+
+/* Function walkPush puts a frame for node on top of
+ * walk, moving the stack to the heap when it is
+ * full. Returns false if memory runs out
+ */
+bool walkPush(TreeWalk* walk, TreeNode* node)
+{
+    if (walk->count == walk->capacity) {
+        size_t size = 2 * walk->capacity * sizeof(WalkFrame);
+        WalkFrame* frames = (walk->frames == walk->first)
+                                ? malloc(size)
+                                : realloc(walk->frames, size);
+        if (frames == NULL) {
+            fprintf(tiny->listing, "Out of memory error at line %d\n",
+                    node->lineno);
+            tiny->error = true;
+            walkRelease(walk);
+            return false;
+        }
+        if (walk->frames == walk->first) {
+            memcpy(frames, walk->first, walk->count * sizeof(WalkFrame));
+        }
+        walk->frames = frames;
+        walk->capacity *= 2;
+    }
+    walk->frames[walk->count++] = (WalkFrame){node, 0, {0, 0}};
+    return true;
+}
+
+/* Procedure walkRelease frees what walk took from
+ * the heap
+ */
+void walkRelease(TreeWalk* walk)
+{
+    if (walk->frames != walk->first) {
+        free(walk->frames);
+    }
+    walk->frames = walk->first;
+    walk->count = 0;
+    walk->capacity = WALK_FRAMES;
+}
@@ -0,0 +1,275 @@
+/****************************************************/
+/* File: xref.c                                     */
+/* Cross-reference index file implementation        */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#include "include/xref.h"
+#include "include/compiler.h"
+#include "include/intern.h"
+#include "include/symtab.h"
+#include "include/walk.h"
+
+#define XREF_MAGIC "TINYXRF"
+#define BYTE_ORDER_MARK 0x01020304u
+
+/* An Occurrence is a variable stored or used on a
+   line */
+typedef struct Occurrence {
+    int name;
+    int line;
+    int def;
+} Occurrence;
+
+/* addOccurrence adds an occurrence of name */
+static void addOccurrence(int name, int line, bool def)
+{
+    XrefState* xs = &tiny->xref;
+    if (xs->foundCount == xs->foundCapacity) {
+        size_t cap = (xs->foundCapacity == 0) ? 1024 : 2 * xs->foundCapacity;
+        Occurrence* o = realloc(xs->found, cap * sizeof(*o));
+        if (o == NULL) {
+            xs->foundFailed = true;
+            return;
+        }
+        xs->found = o;
+        xs->foundCapacity = cap;
+    }
+    xs->found[xs->foundCount++] = (Occurrence){name, line, def};
+}
+
+/* findOccurrences adds the stores of assign and
+   read and the uses of identifiers of a node */
+static bool findOccurrences(WalkFrame* frame, size_t depth)
+{
+    TreeNode* t = frame->node;
+    (void)depth;
+    if ((t->nodekind == StmtK) &&
+        ((t->kind.stmt == AssignK) || (t->kind.stmt == ReadK))) {
+        addOccurrence(t->attr.name, t->lineno, true);
+    }
+    else if ((t->nodekind == ExpK) && (t->kind.exp == IdK)) {
+        addOccurrence(t->attr.name, t->lineno, false);
+    }
+    return true;
+}
+
+/* indexStatement adds the occurrences of a
+   statement */
+static void indexStatement(TreeNode* tree)
+{
+    walkTree(tree, findOccurrences, NULL, NULL);
+}
+
+/* byName orders occurrences by the name of their
+   variable, its stores first, then by line */
+static int byName(const void* a, const void* b)
+{
+    const Occurrence* x = a;
+    const Occurrence* y = b;
+    if (x->name != y->name) {
+        return strcmp(symbolName(x->name), symbolName(y->name));
+    }
+    if (x->def != y->def) {
+        return y->def - x->def;
+    }
+    return (x->line > y->line) - (x->line < y->line);
+}
+
+/* putNumber appends n to postings in 7 bit groups,
+   returning the new end */
+static unsigned char* putNumber(unsigned char* p, uint32_t n)
+{
+    while (n >= 0x80) {
+        *p++ = (unsigned char)(n | 0x80);
+        n >>= 7;
+    }
+    *p++ = (unsigned char)n;
+    return p;
+}
+
+/* Function xrefWrite writes the index of the
+ * variables of the analyzed tree at root to file,
+ * with the memory locations of the symbol table.
+ * Returns false if writing fails
+ */
+bool xrefWrite(FILE* file, AstIndex root)
+{
+    XrefState* xs = &tiny->xref;
+    xs->foundCount = 0;
+    xs->foundFailed = false;
+    astForEachStatement(root, indexStatement);
+    qsort(xs->found, xs->foundCount, sizeof(*xs->found), byName);
+    /* a number takes at most 5 bytes */
+    XrefSymbol* symbols = malloc((xs->foundCount + 1) * sizeof(*symbols));
+    unsigned char* postings = malloc(5 * xs->foundCount + 1);
+    bool ok = !xs->foundFailed && (symbols != NULL) && (postings != NULL);
+    uint32_t count = 0;
+    unsigned char* end = postings;
+    size_t bytes = 0;
+    for (size_t i = 0; ok && (i < xs->foundCount);) {
+        XrefSymbol* s = &symbols[count++];
+        int name = xs->found[i].name;
+        *s = (XrefSymbol){(uint32_t)bytes, st_lookup(name), 0, 0,
+                          (uint32_t)(end - postings)};
+        bytes += strlen(symbolName(name)) + 1;
+        int last = 0;
+        int def = 1;
+        for (; (i < xs->foundCount) && (xs->found[i].name == name); i++) {
+            if (xs->found[i].def != def) {
+                /* the refs start over from 0 */
+                def = xs->found[i].def;
+                last = 0;
+            }
+            else if (xs->found[i].line == last) {
+                continue;
+            }
+            end = putNumber(end, (uint32_t)(xs->found[i].line - last));
+            last = xs->found[i].line;
+            if (def) {
+                s->defCount++;
+            }
+            else {
+                s->refCount++;
+            }
+        }
+    }
+    XrefFileHeader h = {XREF_MAGIC,
+                        XREF_FILE_VERSION,
+                        BYTE_ORDER_MARK,
+                        count,
+                        (uint32_t)(end - postings),
+                        (uint32_t)bytes,
+                        0};
+    ok = ok && (fwrite(&h, sizeof(h), 1, file) == 1);
+    if (ok && (count > 0)) {
+        ok = (fwrite(symbols, sizeof(*symbols), count, file) == count) &&
+             (fwrite(postings, 1, h.postingBytes, file) == h.postingBytes);
+    }
+    /* the names, in the order of the symbols */
+    for (size_t i = 0; ok && (i < xs->foundCount); i++) {
+        if ((i == 0) || (xs->found[i].name != xs->found[i - 1].name)) {
+            const char* name = symbolName(xs->found[i].name);
+            ok = fwrite(name, 1, strlen(name) + 1, file) == strlen(name) + 1;
+        }
+    }
+    free(symbols);
+    free(postings);
+    free(xs->found);
+    xs->found = NULL;
+    xs->foundCapacity = 0;
+    return ok && (fflush(file) == 0);
+}
+
+/* Function xrefOpen maps the index file file into
+ * index. Only the header and the sizes of the parts
+ * are checked, so opening takes the same time for
+ * any index; queries check what they read. Returns
+ * false if file is not an index file of this
+ * version
+ */
+bool xrefOpen(XrefIndex* index, FILE* file)
+{
+    if (!sourceLoad(&index->file, file)) {
+        return false;
+    }
+    const char* data = index->file.data;
+    XrefFileHeader* h = &index->header;
+    if (index->file.size < sizeof(*h)) {
+        xrefClose(index);
+        return false;
+    }
+    memcpy(h, data, sizeof(*h));
+    size_t symbolBytes = (size_t)h->symbolCount * sizeof(XrefSymbol);
+    if ((memcmp(h->magic, XREF_MAGIC, sizeof(h->magic)) != 0) ||
+        (h->version != XREF_FILE_VERSION) ||
+        (h->byteOrder != BYTE_ORDER_MARK) ||
+        (index->file.size !=
+         sizeof(*h) + symbolBytes + h->postingBytes + h->stringBytes) ||
+        ((h->stringBytes > 0) && (data[index->file.size - 1] != '\0'))) {
+        xrefClose(index);
+        return false;
+    }
+    index->symbols = (const XrefSymbol*)(data + sizeof(*h));
+    index->postings = (const unsigned char*)(data + sizeof(*h) + symbolBytes);
+    index->strings = data + sizeof(*h) + symbolBytes + h->postingBytes;
+    return true;
+}
+
+/* Function xrefName returns the name of sym */
+const char* xrefName(const XrefIndex* index, const XrefSymbol* sym)
+{
+    return (sym->name < index->header.stringBytes)
+               ? index->strings + sym->name
+               : "";
+}
+
+/* Function xrefFind returns the symbol of index
+ * named name, by binary search, or NULL
+ */
+const XrefSymbol* xrefFind(const XrefIndex* index, const char* name)
+{
+    size_t low = 0;
+    size_t high = index->header.symbolCount;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int c = strcmp(xrefName(index, &index->symbols[mid]), name);
+        if (c == 0) {
+            return &index->symbols[mid];
+        }
+        if (c < 0) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return NULL;
+}
+
+/* getLines decodes count lines of the postings of
+   index from *at into lines, moving *at past them.
+   Returns false if they run past the postings */
+static bool getLines(const XrefIndex* index, size_t* at, uint32_t count,
+                     int* lines)
+{
+    uint32_t line = 0;
+    for (uint32_t k = 0; k < count; k++) {
+        uint32_t n = 0;
+        for (int shift = 0;; shift += 7) {
+            if ((*at >= index->header.postingBytes) || (shift > 28)) {
+                return false;
+            }
+            unsigned char b = index->postings[(*at)++];
+            n |= (uint32_t)(b & 0x7f) << shift;
+            if (b < 0x80) {
+                break;
+            }
+        }
+        line += n;
+        lines[k] = (int)line;
+    }
+    return true;
+}
+
+/* Function xrefLines decodes the postings of sym
+ * into defs, for defCount lines, and refs, for
+ * refCount lines. Returns false if they run past
+ * the postings of index
+ */
+bool xrefLines(const XrefIndex* index, const XrefSymbol* sym, int* defs,
+               int* refs)
+{
+    size_t at = sym->postings;
+    return getLines(index, &at, sym->defCount, defs) &&
+           getLines(index, &at, sym->refCount, refs);
+}
+
+/* Procedure xrefClose unmaps the file of index */
+void xrefClose(XrefIndex* index)
+{
+    if (index->file.data != NULL) {
+        sourceRelease(&index->file);
+        index->file.data = NULL;
+    }
+}
@@ -0,0 +1,225 @@
+/****************************************************/
+/* File: mkscantab.c                                */
+/* Generates the character class table and the      */
+/* state x class transition table of the TINY       */
+/* scanner DFA as C source on standard output       */
+/****************************************************/
+
+#include "../src/include/scandfa.h"
+
+/* the reserved words of TINY */
+static const struct {
+    const char* str;
+    const char* tok;
+} reservedWords[MAXRESERVED] = {
+    {"else", "ELSE"},   {"endif", "ENDIF"},   {"endwhile", "ENDWHILE"},
+    {"if", "IF"},       {"read", "READ"},     {"repeat", "REPEAT"},
+    {"then", "THEN"},   {"until", "UNTIL"},   {"while", "WHILE"},
+    {"write", "WRITE"}};
+
+/* classify assigns a character class to byte c */
+static CharClass classify(int c)
+{
+    switch (c) {
+    case '\0':
+        return CC_END;
+    case '\n':
+        return CC_NEWLINE;
+    case ':':
+        return CC_COLON;
+    case '=':
+        return CC_EQ;
+    case '<':
+        return CC_LT;
+    case '+':
+        return CC_PLUS;
+    case '-':
+        return CC_MINUS;
+    case '*':
+        return CC_TIMES;
+    case '/':
+        return CC_OVER;
+    case '(':
+        return CC_LPAREN;
+    case ')':
+        return CC_RPAREN;
+    case ';':
+        return CC_SEMI;
+    case '{':
+        return CC_LBRACE;
+    case '}':
+        return CC_RBRACE;
+    case '_':
+        return CC_UNDERSCORE;
+    default:
+        break;
+    }
+    if ((c >= '0') && (c <= '9')) {
+        return CC_DIGIT;
+    }
+    if (((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z'))) {
+        return CC_LETTER;
+    }
+    if ((c == ' ') || (c == '\t') || (c == '\v') || (c == '\f') ||
+        (c == '\r')) {
+        return CC_SPACE;
+    }
+    return CC_OTHER;
+}
+
+/* single-character tokens, indexed by class */
+static TokenType singleToken(CharClass cls)
+{
+    switch (cls) {
+    case CC_EQ:
+        return EQ;
+    case CC_LT:
+        return LT;
+    case CC_PLUS:
+        return PLUS;
+    case CC_MINUS:
+        return MINUS;
+    case CC_TIMES:
+        return TIMES;
+    case CC_OVER:
+        return OVER;
+    case CC_LPAREN:
+        return LPAREN;
+    case CC_RPAREN:
+        return RPAREN;
+    case CC_SEMI:
+        return SEMI;
+    default:
+        return ERROR;
+    }
+}
+
+/* transition computes the table entry for a state
+   and a character class; this is the scanner DFA */
+static unsigned transition(StateType state, CharClass cls)
+{
+    switch (state) {
+    case START:
+        switch (cls) {
+        case CC_END:
+            return SCAN_ENTRY(DONE, ACT_END, ENDFILE);
+        case CC_NEWLINE:
+        case CC_SPACE:
+            return SCAN_ENTRY(START, ACT_SPACE, ENDFILE);
+        case CC_DIGIT:
+            return SCAN_ENTRY(INNUM, ACT_SHIFT, ENDFILE);
+        case CC_LETTER:
+            return SCAN_ENTRY(INID, ACT_IDENT, ENDFILE);
+        case CC_COLON:
+            return SCAN_ENTRY(INASSIGN, ACT_SHIFT, ENDFILE);
+        case CC_LBRACE:
+            return SCAN_ENTRY(INCOMMENT, ACT_COMMENT, ENDFILE);
+        default: /* '_', '}' and unknown characters are errors */
+            return SCAN_ENTRY(DONE, ACT_ACCEPT, singleToken(cls));
+        }
+    case INCOMMENT:
+        switch (cls) {
+        case CC_END:
+            return SCAN_ENTRY(DONE, ACT_END, ENDFILE);
+        case CC_NEWLINE:
+            return SCAN_ENTRY(INCOMMENT, ACT_NEWLINE, ENDFILE);
+        case CC_RBRACE:
+            return SCAN_ENTRY(START, ACT_SKIP, ENDFILE);
+        default:
+            return SCAN_ENTRY(INCOMMENT, ACT_SKIP, ENDFILE);
+        }
+    case INASSIGN:
+        switch (cls) {
+        case CC_END:
+            return SCAN_ENTRY(DONE, ACT_END, DDOT);
+        case CC_EQ:
+            return SCAN_ENTRY(DONE, ACT_ACCEPT, ASSIGN);
+        default:
+            return SCAN_ENTRY(DONE, ACT_BACKUP, DDOT);
+        }
+    case INNUM:
+        switch (cls) {
+        case CC_END:
+            return SCAN_ENTRY(DONE, ACT_END, NUM);
+        case CC_DIGIT:
+            return SCAN_ENTRY(INNUM, ACT_SHIFT, ENDFILE);
+        default:
+            return SCAN_ENTRY(DONE, ACT_BACKUP, NUM);
+        }
+    case INID:
+        switch (cls) {
+        case CC_END:
+            return SCAN_ENTRY(DONE, ACT_END, ID);
+        case CC_DIGIT:
+        case CC_LETTER:
+        case CC_UNDERSCORE:
+            return SCAN_ENTRY(INID, ACT_SHIFT, ENDFILE);
+        default:
+            return SCAN_ENTRY(DONE, ACT_BACKUP, ID);
+        }
+    default:
+        return SCAN_ENTRY(DONE, ACT_ACCEPT, ERROR);
+    }
+}
+
+/* printKeywords places each reserved word in the
+   slot given by KEYWORD_HASH; returns false if the
+   hash is not perfect */
+static bool printKeywords(void)
+{
+    int slot[KEYWORD_SLOTS];
+    for (int h = 0; h < KEYWORD_SLOTS; h++) {
+        slot[h] = -1;
+    }
+    for (int i = 0; i < MAXRESERVED; i++) {
+        const char* w = reservedWords[i].str;
+        size_t len = strlen(w);
+        unsigned h = KEYWORD_HASH(w, len);
+        if ((len < KEYWORD_MINLEN) || (len > KEYWORD_MAXLEN) ||
+            (slot[h] != -1)) {
+            fprintf(stderr, "mkscantab: KEYWORD_HASH is not perfect for %s\n",
+                    w);
+            return false;
+        }
+        slot[h] = i;
+    }
+    printf("\n/* reserved words, indexed by KEYWORD_HASH */\n");
+    printf("static const struct {\n    const char* str;\n");
+    printf("    size_t len;\n    TokenType tok;\n");
+    printf("} keywordTable[KEYWORD_SLOTS] = {\n");
+    for (int h = 0; h < KEYWORD_SLOTS; h++) {
+        if (slot[h] == -1) {
+            printf("    {\"\", 0, ID},\n");
+        }
+        else {
+            const char* w = reservedWords[slot[h]].str;
+            printf("    {\"%s\", %zu, %s},\n", w, strlen(w),
+                   reservedWords[slot[h]].tok);
+        }
+    }
+    printf("};\n");
+    return true;
+}
+
+int main(void)
+{
+    printf("/* Generated by tools/mkscantab.c -- do not edit */\n\n");
+    printf("/* character class of every input byte */\n");
+    printf("static const unsigned char charClass[256] = {");
+    for (int c = 0; c < 256; c++) {
+        printf("%s%2d,", (c % 16 == 0) ? "\n    " : " ", classify(c));
+    }
+    printf("\n};\n\n");
+    printf("/* scanner DFA: scanTable[state][class] */\n");
+    printf("static const unsigned short scanTable[NSTATES][NCLASSES] = {\n");
+    for (int s = 0; s < NSTATES; s++) {
+        printf("    {");
+        for (int cls = 0; cls < NCLASSES; cls++) {
+            printf("%s0x%04x,", (cls % 8 == 0) ? "\n        " : " ",
+                   transition((StateType)s, (CharClass)cls));
+        }
+        printf("\n    },\n");
+    }
+    printf("};\n");
+    return printKeywords() ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+/****************************************************/
+/* File: tinyxref.c                                 */
+/* Queries the cross-reference index tiny writes    */
+/* with --emit-xref: where each variable named, or  */
+/* every variable, lives, is stored and is used,    */
+/* read from the mapped index without compiling     */
+/*                                                  */
+/* usage: tiny-xref [-t] <file.xrf> [name ...]      */
+/****************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+
+#include "../src/include/xref.h"
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* printLines prints count lines after a heading */
+static void printLines(const char* heading, const int* lines, uint32_t count)
+{
+    printf("    %-8s", heading);
+    for (uint32_t k = 0; k < count; k++) {
+        printf(" %4d", lines[k]);
+    }
+    printf("\n");
+}
+
+/* printSymbol prints where sym lives, is stored and
+   is used. Returns false if its postings are bad */
+static bool printSymbol(const XrefIndex* index, const XrefSymbol* sym)
+{
+    int* defs = malloc(((size_t)sym->defCount + 1) * sizeof(int));
+    int* refs = malloc(((size_t)sym->refCount + 1) * sizeof(int));
+    bool ok = (defs != NULL) && (refs != NULL) &&
+              xrefLines(index, sym, defs, refs);
+    if (ok) {
+        printf("%-14s location %d\n", xrefName(index, sym), sym->location);
+        printLines("stored", defs, sym->defCount);
+        printLines("used", refs, sym->refCount);
+    }
+    else {
+        fprintf(stderr, "the index is damaged at %s\n", xrefName(index, sym));
+    }
+    free(defs);
+    free(refs);
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    bool timed = false; /* print the time of each query */
+    int first = 1;
+    if ((argc > 1) && (strcmp(argv[1], "-t") == 0)) {
+        timed = true;
+        first = 2;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "usage: %s [-t] <file.xrf> [name ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    FILE* f = fopen(argv[first], "rb");
+    XrefIndex index;
+    double t0 = now();
+    if ((f == NULL) || !xrefOpen(&index, f)) {
+        fprintf(stderr, "%s is not an index file of this compiler\n",
+                argv[first]);
+        return EXIT_FAILURE;
+    }
+    fclose(f);
+    if (timed) {
+        printf("opened in %.1f us\n", (now() - t0) * 1e6);
+    }
+    int status = EXIT_SUCCESS;
+    if (first + 1 == argc) {
+        /* no names: every variable */
+        for (uint32_t k = 0; k < index.header.symbolCount; k++) {
+            if (!printSymbol(&index, &index.symbols[k])) {
+                status = EXIT_FAILURE;
+            }
+        }
+    }
+    for (int i = first + 1; i < argc; i++) {
+        t0 = now();
+        const XrefSymbol* sym = xrefFind(&index, argv[i]);
+        double t1 = now();
+        if (sym == NULL) {
+            printf("%-14s not found\n", argv[i]);
+            status = EXIT_FAILURE;
+        }
+        else if (!printSymbol(&index, sym)) {
+            status = EXIT_FAILURE;
+        }
+        if (timed) {
+            printf("    found in %.1f us\n", (t1 - t0) * 1e6);
+        }
+    }
+    xrefClose(&index);
+    return status;
+}